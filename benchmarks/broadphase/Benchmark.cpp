@@ -0,0 +1,97 @@
+#include "Benchmark.hpp"
+
+#include <cstdio>
+
+#include "Nito/APIs/Physics.hpp"
+
+
+using std::printf;
+
+// glm/glm.hpp
+using glm::vec3;
+
+// Nito/APIs/Physics.hpp
+using Nito::Physics_Stats;
+using Nito::get_physics_stats;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Headless runs aren't throttled, so circles move by a fixed step each frame rather than by the frame's delta time,
+// keeping the workload the same in every mode.
+static const vec3 AREA_MIN_POINT(0.0f, 0.0f, 0.0f);
+static const vec3 AREA_MAX_POINT(64.0f, 64.0f, 0.0f);
+static const float FRAME_STEP = 1.0f / 60.0f;
+
+
+// Totals are kept wide enough for brute force runs, which make millions of narrow phase tests each frame.
+static bool started = false;
+static int frames_since_start = 0;
+static int measured_frame_count = 0;
+static double total_broadphase_time = 0.0;
+static double total_narrow_phase_time = 0.0;
+static long long total_narrow_phase_tests = 0;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void drift(vec3 & position, vec3 & velocity)
+{
+    position += velocity * FRAME_STEP;
+
+    if ((position.x < AREA_MIN_POINT.x && velocity.x < 0.0f) || (position.x > AREA_MAX_POINT.x && velocity.x > 0.0f))
+    {
+        velocity.x = -velocity.x;
+    }
+
+    if ((position.y < AREA_MIN_POINT.y && velocity.y < 0.0f) || (position.y > AREA_MAX_POINT.y && velocity.y > 0.0f))
+    {
+        velocity.y = -velocity.y;
+    }
+}
+
+
+void start_physics_stats()
+{
+    started = true;
+}
+
+
+void record_physics_stats()
+{
+    // The stats read here are the last frame's. Skip those from before the benchmark scene loaded, and from the frame
+    // it loaded in, which builds the broadphase from scratch.
+    if (!started || ++frames_since_start <= 2)
+    {
+        return;
+    }
+
+    const Physics_Stats & physics_stats = get_physics_stats();
+    total_broadphase_time += physics_stats.broadphase_time;
+    total_narrow_phase_time += physics_stats.narrow_phase_time;
+    total_narrow_phase_tests += physics_stats.narrow_phase_tests;
+    measured_frame_count++;
+}
+
+
+void report_physics_stats()
+{
+    if (measured_frame_count == 0)
+    {
+        return;
+    }
+
+    printf(
+        "physics: %d frames, average broadphase: %f ms, average narrow phase: %f ms, "
+        "average narrow phase tests: %lld\n",
+        measured_frame_count,
+        total_broadphase_time / measured_frame_count,
+        total_narrow_phase_time / measured_frame_count,
+        total_narrow_phase_tests / measured_frame_count);
+}
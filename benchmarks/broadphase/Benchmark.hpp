@@ -0,0 +1,30 @@
+#pragma once
+
+
+#include <glm/glm.hpp>
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Drift
+{
+    glm::vec3 velocity;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Moves a circle by one frame's step, bouncing it off the edges of the area the benchmark scene was generated in.
+void drift(glm::vec3 & position, glm::vec3 & velocity);
+
+// Must be called when the benchmark scene is loaded, and record_physics_stats() once per frame before the physics
+// update, so the frames spent setting the scene up aren't measured.
+void start_physics_stats();
+void record_physics_stats();
+void report_physics_stats();
@@ -0,0 +1,198 @@
+// Runs the broadphase benchmark's scenes through the Physics API alone, without creating a window or loading the rest
+// of the engine. Run from this directory with the scene to benchmark, e.g.
+//
+//     ./physics_broadphase_benchmark circles_sweep_and_prune
+//
+// Frames run in the same order as the engine's: one frame in the empty default scene, then the benchmark scene is
+// loaded, and each frame moves the circles, records the last frame's physics stats and updates physics.
+
+
+#include <map>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <glm/glm.hpp>
+#include "Cpp_Utils/JSON.hpp"
+#include "Cpp_Utils/File.hpp"
+#include "Cpp_Utils/Map.hpp"
+
+#include "Nito/APIs/Physics.hpp"
+
+#include "Benchmark.hpp"
+
+
+using std::map;
+using std::string;
+using std::vector;
+using std::runtime_error;
+
+// glm/glm.hpp
+using glm::vec3;
+
+// Cpp_Utils/JSON.hpp
+using Cpp_Utils::JSON;
+
+// Cpp_Utils/File.hpp
+using Cpp_Utils::read_json_file;
+
+// Cpp_Utils/Map.hpp
+using Cpp_Utils::contains_key;
+
+// Nito/APIs/ECS.hpp
+using Nito::Entity;
+
+// Nito/APIs/Physics.hpp
+using Nito::Broadphase_Modes;
+using Nito::Collision_Handler;
+using Nito::load_circle_collider_data;
+using Nito::get_collision_layer;
+using Nito::get_default_collision_mask;
+using Nito::set_broadphase_mode;
+using Nito::physics_api_update;
+using Nito::clean_physics;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stands in for the components the engine would allocate for a circle collider entity.
+struct Circle
+{
+    Collision_Handler collision_handler;
+    bool sends_collision;
+    bool receives_collision;
+    bool enabled;
+    unsigned int layer;
+    unsigned int mask;
+    bool continuous;
+    float radius;
+    vec3 position;
+    vec3 scale;
+    Drift drift;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const map<string, Broadphase_Modes> BROADPHASE_MODES
+{
+    { "spatial_hash"    , Broadphase_Modes::SPATIAL_HASH    },
+    { "sweep_and_prune" , Broadphase_Modes::SWEEP_AND_PRUNE },
+    { "brute_force"     , Broadphase_Modes::BRUTE_FORCE     },
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Utilities
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void load_circles(const string & scene_path, vector<Circle> & circles)
+{
+    const vector<JSON> scene_data = read_json_file(scene_path).get<vector<JSON>>();
+    const unsigned int default_layer = get_collision_layer("default");
+    circles.resize(scene_data.size());
+
+    for (auto i = 0u; i < scene_data.size(); i++)
+    {
+        const JSON & components = scene_data[i]["components"];
+        const JSON & position_data = components["transform"]["position"];
+        const JSON & collider_data = components["collider"];
+        const JSON & velocity_data = components["drift"]["velocity"];
+        Circle & circle = circles[i];
+
+        circle.collision_handler = {};
+        circle.sends_collision =
+            contains_key(collider_data, "send_collision") ? collider_data["send_collision"].get<bool>() : false;
+        circle.receives_collision =
+            contains_key(collider_data, "receives_collision") ? collider_data["receives_collision"].get<bool>() : false;
+        circle.enabled = true;
+        circle.layer = default_layer;
+        circle.mask = get_default_collision_mask(default_layer);
+        circle.continuous = false;
+        circle.radius = components["circle_collider"]["radius"];
+        circle.position = vec3(position_data["x"].get<float>(), position_data["y"].get<float>(), 0.0f);
+        circle.scale = vec3(1.0f);
+        circle.drift = { vec3(velocity_data["x"].get<float>(), velocity_data["y"].get<float>(), 0.0f) };
+    }
+
+    for (auto i = 0u; i < circles.size(); i++)
+    {
+        Circle & circle = circles[i];
+
+        load_circle_collider_data(
+            (Entity)i,
+            &circle.collision_handler,
+            &circle.sends_collision,
+            &circle.receives_collision,
+            &circle.enabled,
+            &circle.layer,
+            &circle.mask,
+            &circle.continuous,
+            &circle.radius,
+            &circle.position,
+            &circle.scale);
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Main
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char ** argv)
+{
+    if (argc < 2)
+    {
+        throw runtime_error("ERROR: the name of the scene to benchmark must be passed as the first argument!");
+    }
+
+    const string scene_name = argv[1];
+    const JSON scenes = read_json_file("resources/data/scenes.json");
+
+    if (!contains_key(scenes, scene_name) || !scenes[scene_name].is_object())
+    {
+        throw runtime_error(
+            "ERROR: no scene named \"" + scene_name + "\" with a broadphase is in resources/data/scenes.json!");
+    }
+
+    const JSON & scene_data = scenes[scene_name];
+    const string broadphase = scene_data["broadphase"];
+
+    if (!contains_key(BROADPHASE_MODES, broadphase))
+    {
+        throw runtime_error("ERROR: scene \"" + scene_name + "\" uses unknown broadphase \"" + broadphase + "\"!");
+    }
+
+    const int frame_count = read_json_file("resources/configs/window.json")["frame_count"];
+    vector<Circle> circles;
+
+    for (int frame = 0; frame < frame_count; frame++)
+    {
+        // The engine loads the benchmark scene at the start of its second frame.
+        if (frame == 1)
+        {
+            set_broadphase_mode(BROADPHASE_MODES.at(broadphase));
+            load_circles(scene_data["path"], circles);
+            start_physics_stats();
+        }
+
+        for (Circle & circle : circles)
+        {
+            drift(circle.position, circle.drift.velocity);
+        }
+
+        record_physics_stats();
+        physics_api_update();
+    }
+
+    report_physics_stats();
+    clean_physics();
+    return 0;
+}
@@ -0,0 +1,171 @@
+// Broadphase benchmark: moves a scene of many similar-sized circles around a bounded area so each broadphase mode can
+// be compared on the same workload. Run headless from this directory with the scene to benchmark, e.g.
+//
+//     ./broadphase_benchmark circles_sweep_and_prune
+//
+// and the average broadphase and narrow phase times are reported once the configured frame count has run. The
+// physics_broadphase_benchmark target runs the same scenes through the Physics API alone, without a window.
+
+
+#include <map>
+#include <string>
+#include <stdexcept>
+#include <glm/glm.hpp>
+#include "Cpp_Utils/Map.hpp"
+#include "Cpp_Utils/Collection.hpp"
+#include "Cpp_Utils/JSON.hpp"
+
+#include "Nito/Engine.hpp"
+#include "Nito/Components.hpp"
+#include "Nito/APIs/ECS.hpp"
+#include "Nito/APIs/Scene.hpp"
+
+#include "Benchmark.hpp"
+
+
+using std::map;
+using std::string;
+using std::runtime_error;
+
+// glm/glm.hpp
+using glm::vec3;
+
+// Cpp_Utils/Map.hpp
+using Cpp_Utils::remove;
+
+// Cpp_Utils/Collection.hpp
+using Cpp_Utils::for_each;
+
+// Cpp_Utils/JSON.hpp
+using Cpp_Utils::JSON;
+
+// Nito/Engine.hpp
+using Nito::add_update_handler;
+using Nito::run_engine;
+using Nito::get_component_deallocator;
+
+// Nito/Components.hpp
+using Nito::Transform;
+
+// Nito/APIs/ECS.hpp
+using Nito::Entity;
+using Nito::Component;
+using Nito::get_component;
+using Nito::set_component_handlers;
+using Nito::set_system_entity_handlers;
+
+// Nito/APIs/Scene.hpp
+using Nito::scene_exists;
+using Nito::set_scene_to_load;
+using Nito::set_scene_load_handler;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Drift_State
+{
+    Transform * transform;
+    Drift * drift;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static map<Entity, Drift_State> entity_states;
+static string benchmark_scene_name;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Utilities
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static void drift_subscribe(Entity entity)
+{
+    entity_states[entity] =
+    {
+        (Transform *)get_component(entity, "transform"),
+        (Drift *)get_component(entity, "drift"),
+    };
+}
+
+
+static void drift_unsubscribe(Entity entity)
+{
+    remove(entity_states, entity);
+}
+
+
+static void drift_update()
+{
+    for_each(entity_states, [](Entity /*entity*/, Drift_State & entity_state) -> void
+    {
+        drift(entity_state.transform->position, entity_state.drift->velocity);
+    });
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Main
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char ** argv)
+{
+    if (argc < 2)
+    {
+        throw runtime_error("ERROR: the name of the scene to benchmark must be passed as the first argument!");
+    }
+
+    benchmark_scene_name = argv[1];
+
+    set_component_handlers(
+        "drift",
+        [](const JSON & data) -> Component
+        {
+            const JSON & velocity_data = data["velocity"];
+            return new Drift { vec3(velocity_data["x"].get<float>(), velocity_data["y"].get<float>(), 0.0f) };
+        },
+        get_component_deallocator<Drift>());
+
+    set_system_entity_handlers("drift", drift_subscribe, drift_unsubscribe);
+    add_update_handler(drift_update);
+    add_update_handler(record_physics_stats);
+
+
+    // The engine always starts in the (empty) default scene, so switch to the benchmarked scene on the first update.
+    add_update_handler([]() -> void
+    {
+        if (benchmark_scene_name.empty())
+        {
+            return;
+        }
+
+        if (!scene_exists(benchmark_scene_name))
+        {
+            throw runtime_error(
+                "ERROR: no scene named \"" + benchmark_scene_name + "\" is in resources/data/scenes.json!");
+        }
+
+        set_scene_to_load(benchmark_scene_name);
+    });
+
+    set_scene_load_handler("broadphase_benchmark", [](const string & scene_name) -> void
+    {
+        if (scene_name == benchmark_scene_name)
+        {
+            start_physics_stats();
+            benchmark_scene_name.clear();
+        }
+    });
+
+    const int result = run_engine();
+    report_physics_stats();
+    return result;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include "Cpp_Utils/JSON.hpp"
+
+
+namespace Nito
+{
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Asset
+{
+    enum class Types
+    {
+        FILE,
+        TEXTURE,
+    }
+    type;
+
+    // Points directly into the mapped archive, so it is only valid until the archive is closed.
+    const char * data;
+    std::size_t size;
+
+    // Texture assets are stored pre-decoded in this format, ready to be uploaded.
+    std::string texture_format;
+    int width;
+    int height;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Paths under a named asset root are archived relative to it, so an archive can be packed and opened with its roots
+// in different places. Roots must be set before packing, and before looking up assets under them.
+void set_asset_root(const std::string & name, const std::string & path);
+
+void pack_asset_archive(
+    const std::string & archive_path,
+    const std::vector<std::string> & file_paths,
+    const std::vector<Cpp_Utils::JSON> & texture_groups);
+
+void open_asset_archive(const std::string & path);
+void close_asset_archive();
+const Asset * get_archived_asset(const std::string & path);
+
+// Read from the open archive when it contains the path, falling back to the file system otherwise.
+bool asset_exists(const std::string & path);
+std::string read_asset_file(const std::string & path);
+Cpp_Utils::JSON read_asset_json_file(const std::string & path);
+
+
+} // namespace Nito
@@ -0,0 +1,26 @@
+#pragma once
+
+
+#include <vector>
+#include <glm/glm.hpp>
+
+
+namespace Nito
+{
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// All positions are in world units. Draws are collected until the next debug_draw_api_update(), which submits all lines
+// of the same color as a single draw.
+void draw_debug_line(const glm::vec3 & begin, const glm::vec3 & end, const glm::vec4 & color);
+void draw_debug_circle(const glm::vec3 & center, float radius, const glm::vec4 & color);
+void draw_debug_polygon(const std::vector<glm::vec3> & points, const glm::vec4 & color);
+void debug_draw_api_update();
+
+
+} // namespace Nito
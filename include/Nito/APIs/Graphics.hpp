@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <functional>
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
@@ -33,6 +34,12 @@ struct OpenGL_Config
         const std::string destination_factor;
     }
     blending;
+
+    // Directory linked shader programs are cached in (empty disables the cache).
+    const std::string shader_cache_path;
+
+    // Megabytes evictable textures may use before least-recently-used ones are unloaded (0 disables eviction).
+    const unsigned int texture_memory_budget;
 };
 
 
@@ -43,6 +50,16 @@ struct Shader_Pipeline
 };
 
 
+// A mip level of compressed texture data, stored at offset in the data it was loaded from.
+struct Compressed_Texture_Level
+{
+    int width;
+    int height;
+    size_t offset;
+    size_t size;
+};
+
+
 struct Uniform
 {
     enum class Types
@@ -80,6 +97,32 @@ struct Render_Data
 };
 
 
+struct Render_Bounds
+{
+    glm::vec3 min;
+    glm::vec3 max;
+};
+
+
+// Counters and timings for a render layer, collected each time it is rendered. Times are in milliseconds. gpu_time is
+// read back a few frames late and is negative while timer queries are disabled or no result has been read back yet.
+// indices counts the indices drawn, so shared vertices are counted once per triangle they are part of.
+struct Render_Layer_Stats
+{
+    int draw_calls;
+    int state_changes;
+    int indices;
+    int texture_binds;
+    int uniform_uploads;
+    float cpu_time;
+    float gpu_time;
+};
+
+
+// Loads the texture with the given identifier when it is used without being resident.
+using Texture_Loader = std::function<void(const std::string & identifier)>;
+
+
 struct Render_Canvas
 {
     const float width;
@@ -96,17 +139,50 @@ struct Render_Canvas
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void init_glew();
+void create_offscreen_framebuffer(int width, int height);
 void configure_opengl(const OpenGL_Config & opengl_config);
 void load_shader_pipelines(const std::vector<Shader_Pipeline> & shader_pipelines);
-void load_texture_data(const Texture & texture, const void * data, const std::string & identifier);
+// Evictable textures count against the texture memory budget, and are reloaded through the texture loader when used
+// after being evicted.
+void load_texture_data(
+    const Texture & texture,
+    const void * data,
+    const std::string & identifier,
+    bool evictable = false);
+
+void load_compressed_texture_data(
+    const Texture & texture,
+    const std::vector<char> & data,
+    const std::vector<Compressed_Texture_Level> & levels,
+    const std::string & identifier,
+    bool evictable = false);
+
+// Uploads through a pixel buffer without blocking. A transparent placeholder is bound for the texture until the upload
+// completes, usually a frame or two later.
+void load_texture_data_async(
+    const Texture & texture,
+    const void * data,
+    const std::string & identifier,
+    bool evictable = false);
 
 void load_vertex_data(
     const std::string & id,
     const std::vector<GLfloat> & vertex_data,
     const std::vector<GLuint> & index_data);
 
+void unload_vertex_data(const std::string & id);
+
+void load_stream_vertex_data(
+    const std::string & id,
+    const std::vector<GLfloat> & vertex_data,
+    const std::vector<GLuint> & index_data);
+
 void load_render_layer(const std::string & name, const std::string & render_space);
 void load_render_data(const Render_Data & render_data);
+void set_render_view_bounds(const Render_Bounds & bounds);
+const Render_Bounds * get_render_view_bounds();
+bool is_world_render_layer(const std::string & name);
+bool in_render_view(const std::string & layer_name, const Render_Bounds & render_bounds);
 
 int create_light_source(
     float intensity,
@@ -121,6 +197,9 @@ void cleanup_rendering();
 void destroy_graphics();
 float get_pixels_per_unit();
 const std::string & get_default_vertex_container_id();
+void set_texture_loader(const Texture_Loader & loader);
+void set_render_timer_queries_enabled(bool enabled);
+const std::map<std::string, Render_Layer_Stats> & get_render_layer_stats();
 
 
 } // namespace Nito
@@ -1,6 +1,8 @@
 #pragma once
 
 
+#include <string>
+#include <vector>
 #include <glm/glm.hpp>
 
 #include "Nito/APIs/ECS.hpp"
@@ -18,6 +20,94 @@ namespace Nito
 using Collision_Handler = std::function<void(Entity)>;
 
 
+// Broadphase used to find candidate pairs of dynamic colliders. Static colliders are always found through their BVH.
+//     SPATIAL_HASH:    uniform grid rebuilt every pass, suited to most scenes.
+//     SWEEP_AND_PRUNE: sorted endpoint lists kept between frames, suited to many similar-sized moving bodies.
+//     BRUTE_FORCE:     every pair is a candidate, for comparison.
+enum class Broadphase_Modes
+{
+    SPATIAL_HASH,
+    SWEEP_AND_PRUNE,
+    BRUTE_FORCE,
+};
+
+
+// Collision layers are named bits colliders are assigned to. Each layer has a mask of the layers its colliders collide
+// with by default, and a pair of colliders only collides when each one's layer is in the other's mask. The "default"
+// layer is always loaded, and collides with every layer unless loaded with its own mask.
+struct Collision_Layer
+{
+    std::string name;
+    std::vector<std::string> mask;
+};
+
+
+// Timings (in milliseconds) and counters for the last physics update, across all passes.
+struct Physics_Stats
+{
+    float broadphase_time;
+    float narrow_phase_time;
+    int narrow_phase_tests;
+};
+
+
+// Spatial queries find enabled colliders (including static and sleeping ones) that a collider on every layer, with the
+// query's mask, would collide with. They are answered from the broadphase, which is rebuilt for the first query after
+// each physics update or each time colliders are loaded or removed, so colliders moved after that are found where they
+// were then. Raycasts start at origin and travel along direction (which doesn't need to be normalized) for up to
+// max_distance, hitting the first collider in the way; rays starting inside circles hit them at a distance of 0.
+struct Raycast_Query
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+    float max_distance;
+    unsigned int mask;
+};
+
+
+struct Raycast_Hit
+{
+    bool hit;
+    Entity entity;
+    glm::vec3 point;
+    glm::vec3 normal;
+    float distance;
+};
+
+
+struct Overlap_Circle_Query
+{
+    glm::vec3 position;
+    float radius;
+    unsigned int mask;
+};
+
+
+struct Overlap_AABB_Query
+{
+    glm::vec3 min_point;
+    glm::vec3 max_point;
+    unsigned int mask;
+};
+
+
+// Finds the collider closest to position within max_distance, measured to its edge (0 for circles containing it).
+struct Nearest_Query
+{
+    glm::vec3 position;
+    float max_distance;
+    unsigned int mask;
+};
+
+
+struct Nearest_Result
+{
+    bool found;
+    Entity entity;
+    float distance;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Interface
@@ -29,6 +119,9 @@ void load_circle_collider_data(
     const bool * sends_collision,
     const bool * receives_collision,
     const bool * enabled,
+    const unsigned int * layer,
+    const unsigned int * mask,
+    const bool * continuous,
     const float * radius,
     glm::vec3 * position,
     const glm::vec3 * scale);
@@ -39,6 +132,9 @@ void load_line_collider_data(
     const bool * sends_collision,
     const bool * receives_collision,
     const bool * enabled,
+    const unsigned int * layer,
+    const unsigned int * mask,
+    bool is_static,
     const glm::vec3 * line_begin,
     const glm::vec3 * line_end);
 
@@ -48,6 +144,9 @@ void load_polygon_collider_data(
     const bool * sends_collision,
     const bool * receives_collision,
     const bool * enabled,
+    const unsigned int * layer,
+    const unsigned int * mask,
+    bool is_static,
     const std::vector<glm::vec3> * line_begins,
     const std::vector<glm::vec3> * line_ends,
     glm::vec3 * position);
@@ -55,7 +154,48 @@ void load_polygon_collider_data(
 void remove_circle_collider_data(Entity entity);
 void remove_line_collider_data(Entity entity);
 void remove_polygon_collider_data(Entity entity);
+
+// Must be called when the world-space lines of a static collider change, so the static geometry is re-baked.
+void invalidate_static_collider_data();
+
+// Keeps a continuous circle collider from being swept from where it was at the last update, so it can be teleported
+// without colliding with everything in between. Does nothing for other colliders.
+void reset_collider_motion(Entity entity);
+
+void load_collision_layers(const std::vector<Collision_Layer> & collision_layers);
+unsigned int get_collision_layer(const std::string & name);
+unsigned int get_default_collision_mask(unsigned int layer);
+void set_broadphase_mode(Broadphase_Modes mode);
+
+// Sets how many threads run narrow phase tests (0 uses one per hardware thread). Results don't depend on the count.
+void set_physics_worker_count(int count);
+
+// Sets whether resting circles fall asleep (the default). Circles that are asleep are woken by the next update after
+// sleeping is disabled.
+void set_sleeping_enabled(bool enabled);
+
+// Sets how far continuous circles can move in one update and still be swept; circles moving further are treated as
+// teleported (0, the default, means there is no limit).
+void set_max_continuous_displacement(float distance);
+
+const Physics_Stats & get_physics_stats();
+
+// Overlap queries return entities in entity order, and ties between equally close colliders are broken the same way in
+// every broadphase mode. Batched queries are split between the physics worker threads, and fill results in the same
+// order as their queries.
+Raycast_Hit raycast(const Raycast_Query & query);
+void raycast(const std::vector<Raycast_Query> & queries, std::vector<Raycast_Hit> & hits);
+std::vector<Entity> overlap_circle(const Overlap_Circle_Query & query);
+void overlap_circle(const std::vector<Overlap_Circle_Query> & queries, std::vector<std::vector<Entity>> & results);
+std::vector<Entity> overlap_aabb(const Overlap_AABB_Query & query);
+void overlap_aabb(const std::vector<Overlap_AABB_Query> & queries, std::vector<std::vector<Entity>> & results);
+Nearest_Result nearest(const Nearest_Query & query);
+void nearest(const std::vector<Nearest_Query> & queries, std::vector<Nearest_Result> & results);
+
 void physics_api_update();
 
+// Stops the narrow phase worker threads, which must be done before the program exits.
+void clean_physics();
+
 
 } // namespace Nito
@@ -29,6 +29,7 @@ struct Texture
     std::string format;
     Options options;
     Dimensions dimensions;
+    bool mipmaps;
 };
 
 
@@ -39,16 +40,42 @@ struct Glyph
 };
 
 
+struct Font
+{
+    unsigned int height;
+
+    // Signed-distance-field fonts store each glyph's distance to its outline rather than its coverage, so they can be
+    // rendered crisply at any scale with the text_sdf shader pipeline.
+    bool sdf;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Interface
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void init_freetype();
-void load_textures(const Cpp_Utils::JSON & texture_group);
+// Registered textures are loaded on their first reference, while load_textures() loads them immediately.
+void register_textures(const std::vector<Cpp_Utils::JSON> & texture_groups);
+void load_textures(const std::vector<Cpp_Utils::JSON> & texture_groups, bool async = false);
+void load_texture(const std::string & path, bool async = false);
+
+// Starts loading a registered texture in the background. Its image is decoded on a worker thread then uploaded
+// asynchronously by resources_api_update(), and Graphics API binds a placeholder in its place until then.
+void preload_texture(const std::string & path);
+bool is_texture_registered(const std::string & path);
+bool is_texture_loaded(const std::string & path);
+bool is_texture_loading(const std::string & path);
+
 void load_font(const Cpp_Utils::JSON & config);
 const Texture & get_loaded_texture(const std::string & path);
 const Glyph & get_loaded_glyph(const std::string & identifier);
+const Font & get_loaded_font(const std::string & path);
+void resources_api_update();
+
+// Stops the texture decode worker threads, which must be done before the program exits.
+void clean_resources();
 
 
 } // namespace Nito
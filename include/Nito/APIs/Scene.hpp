@@ -4,6 +4,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <cstddef>
 #include "Cpp_Utils/JSON.hpp"
 
 #include "Nito/APIs/ECS.hpp"
@@ -21,6 +22,18 @@ namespace Nito
 using Scene_Load_Handler = std::function<void(const std::string &)>;
 
 
+// Compiled scenes store components of types with compiled component handlers in a fixed binary layout instead of CBOR,
+// so they are constructed directly when the scene is loaded rather than decoded back to JSON for their allocator.
+// Writers append a component's layout to compiled_data, or return false to store it as CBOR instead (for data that
+// can't be resolved until the scene is loaded). Readers construct the component from that layout, reading it from
+// offset, and must read all of it.
+struct Compiled_Component_Handlers
+{
+    std::function<bool(const Cpp_Utils::JSON & data, std::vector<char> & compiled_data)> writer;
+    std::function<Component(const char * compiled_data, std::size_t size, std::size_t & offset)> reader;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Interface
@@ -28,13 +41,51 @@ using Scene_Load_Handler = std::function<void(const std::string &)>;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void set_scene(const std::string & name, const std::string & path);
 void set_blueprints(const Cpp_Utils::JSON & blueprints_data);
+
+// Compiles a JSON scene into a binary scene that set_scene() accepts in its place. Requirements set through
+// set_system_requirements() and set_component_requirements() are resolved and validated at compile time, so they must
+// be set before compiling, along with compiled component handlers (load_engine_scene_data() sets the engine's), or
+// compiling throws.
+void compile_scene(const std::string & scene_path, const std::string & compiled_scene_path);
+
 bool scene_exists(const std::string & name);
-void set_scene_to_load(const std::string & name);
+
+// Async scenes are read, parsed and validated on a worker thread while the current scene keeps running, then swapped in
+// by check_load_scene() on the first frame after they are ready.
+void set_scene_to_load(const std::string & name, bool async = false);
 void check_load_scene();
+bool is_scene_loading();
+
 void set_system_requirements(const std::string & system_name, const std::vector<std::string> & components);
 void set_component_requirements(const std::string & component_name, const std::vector<std::string> & systems);
 Entity load_blueprint(const std::string & name);
 void set_scene_load_handler(const std::string & id, const Scene_Load_Handler & handler);
 
+// Must be set before compiling or loading scenes with components of the given type.
+void set_compiled_component_handlers(const std::string & type, const Compiled_Component_Handlers & handlers);
+
+// Values are stored as their bytes, and strings as their size (u32) followed by their characters. Reads past the end of
+// the data throw.
+void write_compiled_data(std::vector<char> & compiled_data, const void * value, std::size_t value_size);
+void write_compiled_string(std::vector<char> & compiled_data, const std::string & value);
+
+void read_compiled_data(
+    const char * compiled_data,
+    std::size_t size,
+    std::size_t & offset,
+    void * value,
+    std::size_t value_size);
+
+std::string read_compiled_string(const char * compiled_data, std::size_t size, std::size_t & offset);
+
+template<typename T>
+void write_compiled_value(std::vector<char> & compiled_data, const T & value);
+
+template<typename T>
+T read_compiled_value(const char * compiled_data, std::size_t size, std::size_t & offset);
+
 
 } // namespace Nito
+
+
+#include "Nito/APIs/Scene.ipp"
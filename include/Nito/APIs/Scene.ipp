@@ -0,0 +1,26 @@
+namespace Nito
+{
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+void write_compiled_value(std::vector<char> & compiled_data, const T & value)
+{
+    write_compiled_data(compiled_data, &value, sizeof(value));
+}
+
+
+template<typename T>
+T read_compiled_value(const char * compiled_data, std::size_t size, std::size_t & offset)
+{
+    T value;
+    read_compiled_data(compiled_data, size, offset, &value, sizeof(value));
+    return value;
+}
+
+
+} // namespace Nito
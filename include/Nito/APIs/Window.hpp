@@ -26,6 +26,10 @@ struct Window_Config
     const std::string title;
     const std::string refresh_rate;
     const std::map<std::string, int> hints;
+
+    // Headless windows render offscreen without a display, and stop after frame_count frames (0 runs until closed).
+    const bool headless;
+    const int frame_count;
 };
 
 
@@ -41,7 +45,7 @@ using Window_Loop_Callback = std::function<void()>;
 // Interface
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void init_glfw();
+void init_glfw(bool headless = false);
 void create_window(const Window_Config & window_config);
 void close_window();
 float get_time();
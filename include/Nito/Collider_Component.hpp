@@ -5,7 +5,6 @@
 #include <glm/glm.hpp>
 
 #include "Nito/APIs/ECS.hpp"
-#include "Nito/APIs/Graphics.hpp"
 #include "Nito/APIs/Physics.hpp"
 
 
@@ -17,16 +16,26 @@ struct Collider
 {
     // Common rendering data for colliders
     static const glm::vec4 COLOR;
-    static const Render_Data::Uniforms UNIFORMS;
     static const std::string LAYER_NAME;
-    static const std::string SHADER_PIPELINE_NAME;
-    static const glm::vec3 ORIGIN;
 
 
     bool render;
     bool enabled;
     bool sends_collision;
     bool receives_collision;
+
+    // Colliders only collide when each one's layer is in the other's mask (see Collision_Layer).
+    unsigned int layer;
+    unsigned int mask;
+
+    // Static line and polygon colliders are baked into the Physics API's static geometry, and are only re-baked when
+    // their transform changes.
+    bool is_static;
+
+    // Continuous circle colliders are swept from where they were at the last physics update, so they can't pass through
+    // other colliders when moving fast.
+    bool continuous;
+
     Collision_Handler collision_handler;
 };
 
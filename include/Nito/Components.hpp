@@ -52,6 +52,11 @@ struct Sprite
     bool render;
     std::string texture_path;
     std::string shader_pipeline_name;
+
+    // Static sprites are expected to never change, so the renderer bakes them into shared vertex buffers when they are
+    // added or removed; changes to a static sprite's transform, dimensions, texture or render flag after it has been
+    // baked are not rendered.
+    bool is_static;
 };
 
 
@@ -79,6 +84,9 @@ struct Text
     std::string font;
     glm::vec3 color;
     std::string value;
+
+    // Pixel height to render text at; 0 renders text at the height its font was loaded at.
+    float size;
 };
 
 
@@ -53,6 +53,12 @@ struct System_Entity_Handlers
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void add_update_handler(const Update_Handler & update_handler);
+
+// Registers the engine's compiled component handlers, and loads the system and component requirements of the engine
+// and of the project in the working directory. This is everything compile_scene() needs, and doesn't create a window,
+// so offline tools can call it before compiling scenes. run_engine() calls it itself.
+void load_engine_scene_data();
+
 int run_engine();
 float get_time_scale();
 void set_time_scale(float value);
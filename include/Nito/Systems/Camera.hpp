@@ -15,6 +15,7 @@ namespace Nito
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void camera_subscribe(Entity entity);
 void camera_unsubscribe(Entity entity);
+void camera_view_update();
 void camera_update();
 
 
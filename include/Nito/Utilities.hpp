@@ -4,6 +4,7 @@
 #include <glm/glm.hpp>
 
 #include "Nito/Components.hpp"
+#include "Nito/APIs/Graphics.hpp"
 
 
 namespace Nito
@@ -31,7 +32,16 @@ glm::mat4 calculate_view_matrix(
     const glm::vec3 & view_scale,
     float view_rotation);
 
+Render_Bounds calculate_render_bounds(
+    float model_width,
+    float model_height,
+    const glm::vec3 & model_origin,
+    const glm::vec3 & model_position,
+    const glm::vec3 & model_scale,
+    float model_rotation);
+
 glm::vec3 get_child_world_position(const Transform * parent_transform, const glm::vec3 & child_local_position);
+bool transforms_equal(const Transform & transform_a, const Transform & transform_b);
 void draw_line_collider(const glm::vec3 & line_begin, const glm::vec3 & line_end, const glm::vec3 & scale);
 
 
@@ -0,0 +1,13 @@
+uniform sampler2D texture_0;
+uniform vec3 text_color;
+in vec2 vertex_uv;
+out vec4 color;
+
+
+void main()
+{
+    // Distances are stored so that 0.5 lies on the glyph's outline; smooth the edge over roughly one screen pixel.
+    float distance = texture(texture_0, vertex_uv).r;
+    float edge_width = fwidth(distance);
+    color = vec4(text_color, smoothstep(0.5 - edge_width, 0.5 + edge_width, distance));
+}
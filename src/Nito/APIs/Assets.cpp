@@ -0,0 +1,525 @@
+#include "Nito/APIs/Assets.hpp"
+
+#include <map>
+#include <stdexcept>
+#include <fstream>
+#include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <SOIL.h>
+#include "Cpp_Utils/Map.hpp"
+#include "Cpp_Utils/File.hpp"
+
+
+#if _WIN32
+#include <Windows.h>
+#elif __gnu_linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+
+using std::map;
+using std::string;
+using std::vector;
+using std::runtime_error;
+using std::ifstream;
+using std::ofstream;
+using std::ios;
+using std::istreambuf_iterator;
+using std::size_t;
+using std::uint32_t;
+using std::uint64_t;
+using std::memcpy;
+using std::memcmp;
+
+// Cpp_Utils/JSON.hpp
+using Cpp_Utils::JSON;
+
+// Cpp_Utils/Map.hpp
+using Cpp_Utils::contains_key;
+
+// Cpp_Utils/File.hpp
+using Cpp_Utils::read_file;
+using Cpp_Utils::read_json_file;
+using Cpp_Utils::file_exists;
+using Cpp_Utils::platform_path;
+
+
+namespace Nito
+{
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Archive_Entry
+{
+    string path;
+    Asset asset;
+    uint64_t offset;
+};
+
+
+struct Asset_Root
+{
+    string name;
+    string path;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// Archive layout:
+//     header: magic (8 bytes), version (u32), entry count (u32), TOC offset (u64), TOC size (u64)
+//     blobs:  each aligned to BLOB_ALIGNMENT bytes
+//     TOC:    per entry: path size (u32), path, type (u32), offset (u64), size (u64), width (u32), height (u32),
+//             texture format size (u32), texture format
+static const char ARCHIVE_MAGIC[8] { 'N', 'I', 'T', 'O', 'P', 'A', 'C', 'K' };
+static const uint32_t ARCHIVE_VERSION = 1;
+static const uint64_t ARCHIVE_HEADER_SIZE = 32;
+static const uint64_t BLOB_ALIGNMENT = 16;
+
+
+static const char * archive_data = nullptr;
+static size_t archive_size = 0;
+static map<string, Asset> archived_assets;
+static vector<Asset_Root> asset_roots;
+
+
+#if _WIN32
+static HANDLE archive_file = INVALID_HANDLE_VALUE;
+static HANDLE archive_file_mapping = nullptr;
+#endif
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Utilities
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+template<typename T>
+static void write_value(ofstream & archive_file, T value)
+{
+    archive_file.write((const char *)&value, sizeof(value));
+}
+
+
+static void write_string(ofstream & archive_file, const string & value)
+{
+    write_value<uint32_t>(archive_file, value.size());
+    archive_file.write(value.data(), value.size());
+}
+
+
+// Archive paths use forward slashes and no leading "./", so the same file is found however its path was written.
+static string normalize_asset_path(const string & path)
+{
+    string normalized_path = path;
+
+    for (char & character : normalized_path)
+    {
+        if (character == '\\')
+        {
+            character = '/';
+        }
+    }
+
+    while (normalized_path.compare(0, 2, "./") == 0)
+    {
+        normalized_path.erase(0, 2);
+    }
+
+    return normalized_path;
+}
+
+
+// Archive entries are keyed by their path relative to the asset root they're under, prefixed with the root's name, so
+// archives don't depend on where the roots were on the machine they were packed on.
+static string get_asset_key(const string & path)
+{
+    const string normalized_path = normalize_asset_path(path);
+
+    for (const Asset_Root & asset_root : asset_roots)
+    {
+        if (!asset_root.path.empty() && normalized_path.compare(0, asset_root.path.size(), asset_root.path) == 0)
+        {
+            return asset_root.name + ":" + normalized_path.substr(asset_root.path.size());
+        }
+    }
+
+    return normalized_path;
+}
+
+
+// TOC reads close the archive before throwing, so a truncated archive isn't left open and partially read.
+template<typename T>
+static T read_value(size_t & offset)
+{
+    T value;
+
+    if (offset + sizeof(value) > archive_size)
+    {
+        close_asset_archive();
+        throw runtime_error("ERROR: unexpected end of asset archive!");
+    }
+
+    memcpy(&value, archive_data + offset, sizeof(value));
+    offset += sizeof(value);
+    return value;
+}
+
+
+static string read_string(size_t & offset)
+{
+    const uint32_t size = read_value<uint32_t>(offset);
+
+    if (size > archive_size - offset)
+    {
+        close_asset_archive();
+        throw runtime_error("ERROR: unexpected end of asset archive!");
+    }
+
+    const string value(archive_data + offset, size);
+    offset += size;
+    return value;
+}
+
+
+static vector<char> read_binary_file(const string & path)
+{
+    ifstream file(platform_path(path), ios::binary);
+
+    if (!file)
+    {
+        throw runtime_error("ERROR: could not open \"" + path + "\" to pack into asset archive!");
+    }
+
+    return vector<char>(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+}
+
+
+static void map_archive_file(const string & path)
+{
+#if _WIN32
+    archive_file = CreateFileA(
+        platform_path(path).c_str(),
+        GENERIC_READ,
+        FILE_SHARE_READ,
+        nullptr,
+        OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL,
+        nullptr);
+
+    LARGE_INTEGER file_size;
+
+    if (archive_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(archive_file, &file_size))
+    {
+        throw runtime_error("ERROR: could not open asset archive \"" + path + "\"!");
+    }
+
+    archive_size = file_size.QuadPart;
+    archive_file_mapping = CreateFileMappingA(archive_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+    if (archive_file_mapping == nullptr ||
+        (archive_data = (const char *)MapViewOfFile(archive_file_mapping, FILE_MAP_READ, 0, 0, 0)) == nullptr)
+    {
+        throw runtime_error("ERROR: could not map asset archive \"" + path + "\"!");
+    }
+#elif __gnu_linux__
+    const int archive_file = open(path.c_str(), O_RDONLY);
+    struct stat archive_file_stat;
+
+    if (archive_file == -1 || fstat(archive_file, &archive_file_stat) == -1)
+    {
+        throw runtime_error("ERROR: could not open asset archive \"" + path + "\"!");
+    }
+
+
+    // The mapping stays valid after the file is closed.
+    archive_size = archive_file_stat.st_size;
+    void * mapping = mmap(nullptr, archive_size, PROT_READ, MAP_PRIVATE, archive_file, 0);
+    close(archive_file);
+
+    if (mapping == MAP_FAILED)
+    {
+        throw runtime_error("ERROR: could not map asset archive \"" + path + "\"!");
+    }
+
+    archive_data = (const char *)mapping;
+#endif
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void pack_asset_archive(
+    const string & archive_path,
+    const vector<string> & file_paths,
+    const vector<JSON> & texture_groups)
+{
+    static const map<string, int> TEXTURE_FORMATS
+    {
+        { "rgba" , SOIL_LOAD_RGBA },
+        { "rgb"  , SOIL_LOAD_RGB  },
+    };
+
+    static const char PADDING[BLOB_ALIGNMENT] {};
+
+    ofstream archive_file(archive_path, ios::binary | ios::trunc);
+    vector<Archive_Entry> entries;
+    uint64_t offset = ARCHIVE_HEADER_SIZE;
+
+    if (!archive_file)
+    {
+        throw runtime_error("ERROR: could not create asset archive \"" + archive_path + "\"!");
+    }
+
+    const auto write_blob = [&](const string & path, const Asset & asset, const char * data) -> void
+    {
+        const uint64_t padding = (BLOB_ALIGNMENT - (offset % BLOB_ALIGNMENT)) % BLOB_ALIGNMENT;
+        archive_file.seekp(offset);
+        archive_file.write(PADDING, padding);
+        offset += padding;
+        archive_file.write(data, asset.size);
+        entries.push_back({ get_asset_key(path), asset, offset });
+        offset += asset.size;
+    };
+
+
+    // Pack files as they are.
+    for (const string & path : file_paths)
+    {
+        const vector<char> data = read_binary_file(path);
+        write_blob(path, { Asset::Types::FILE, nullptr, data.size(), "", 0, 0 }, data.data());
+    }
+
+
+    // Pack images decoded into the format of their texture group, so they can be uploaded without decoding at load
+    // time. Groups in other formats (like pre-compressed textures) are packed as they are.
+    for (const JSON & texture_group : texture_groups)
+    {
+        const string format = texture_group["format"];
+
+        for (const string & path : texture_group["paths"].get<vector<string>>())
+        {
+            if (!contains_key(TEXTURE_FORMATS, format))
+            {
+                const vector<char> data = read_binary_file(path);
+                write_blob(path, { Asset::Types::FILE, nullptr, data.size(), "", 0, 0 }, data.data());
+                continue;
+            }
+
+            int width;
+            int height;
+
+            unsigned char * image_data = SOIL_load_image(
+                platform_path(path).c_str(),
+                &width,
+                &height,
+                nullptr,
+                TEXTURE_FORMATS.at(format));
+
+            if (image_data == nullptr)
+            {
+                throw runtime_error("ERROR: could not decode \"" + path + "\" to pack into asset archive!");
+            }
+
+            const size_t size = (size_t)width * height * (format == "rgba" ? 4 : 3);
+            write_blob(path, { Asset::Types::TEXTURE, nullptr, size, format, width, height }, (const char *)image_data);
+            SOIL_free_image_data(image_data);
+        }
+    }
+
+
+    // Write TOC after all blobs, then the header at the start of the archive.
+    const uint64_t toc_offset = offset;
+    archive_file.seekp(toc_offset);
+
+    for (const Archive_Entry & entry : entries)
+    {
+        write_string(archive_file, entry.path);
+        write_value<uint32_t>(archive_file, (uint32_t)entry.asset.type);
+        write_value<uint64_t>(archive_file, entry.offset);
+        write_value<uint64_t>(archive_file, entry.asset.size);
+        write_value<uint32_t>(archive_file, entry.asset.width);
+        write_value<uint32_t>(archive_file, entry.asset.height);
+        write_string(archive_file, entry.asset.texture_format);
+    }
+
+    const uint64_t toc_size = (uint64_t)archive_file.tellp() - toc_offset;
+    archive_file.seekp(0);
+    archive_file.write(ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC));
+    write_value<uint32_t>(archive_file, ARCHIVE_VERSION);
+    write_value<uint32_t>(archive_file, entries.size());
+    write_value<uint64_t>(archive_file, toc_offset);
+    write_value<uint64_t>(archive_file, toc_size);
+
+    if (!archive_file)
+    {
+        throw runtime_error("ERROR: failed to write asset archive \"" + archive_path + "\"!");
+    }
+}
+
+
+void open_asset_archive(const string & path)
+{
+    if (archive_data != nullptr)
+    {
+        throw runtime_error("ERROR: an asset archive is already open!");
+    }
+
+    map_archive_file(path);
+
+
+    // Validate header.
+    size_t offset = sizeof(ARCHIVE_MAGIC);
+
+    if (archive_size < ARCHIVE_HEADER_SIZE || memcmp(archive_data, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0)
+    {
+        close_asset_archive();
+        throw runtime_error("ERROR: \"" + path + "\" is not an asset archive!");
+    }
+
+    if (read_value<uint32_t>(offset) != ARCHIVE_VERSION)
+    {
+        close_asset_archive();
+        throw runtime_error("ERROR: asset archive \"" + path + "\" was packed with an unsupported version!");
+    }
+
+    const uint32_t entry_count = read_value<uint32_t>(offset);
+    offset = read_value<uint64_t>(offset);
+
+
+    // Read TOC, pointing each asset directly into the mapped archive.
+    for (uint32_t i = 0; i < entry_count; i++)
+    {
+        const string asset_path = read_string(offset);
+        const uint32_t type = read_value<uint32_t>(offset);
+        const uint64_t asset_offset = read_value<uint64_t>(offset);
+        const uint64_t asset_size = read_value<uint64_t>(offset);
+        const uint32_t width = read_value<uint32_t>(offset);
+        const uint32_t height = read_value<uint32_t>(offset);
+        const string texture_format = read_string(offset);
+
+        if (type > (uint32_t)Asset::Types::TEXTURE)
+        {
+            close_asset_archive();
+            throw runtime_error(
+                "ERROR: asset \"" + asset_path + "\" in asset archive \"" + path + "\" has an unknown type!");
+        }
+
+        if (asset_size > archive_size || asset_offset > archive_size - asset_size)
+        {
+            close_asset_archive();
+            throw runtime_error("ERROR: asset \"" + asset_path + "\" is outside of asset archive \"" + path + "\"!");
+        }
+
+
+        // Textures are uploaded straight from their data, so it must hold exactly their pixels.
+        if ((Asset::Types)type == Asset::Types::TEXTURE &&
+            ((texture_format != "rgba" && texture_format != "rgb") ||
+             asset_size != (uint64_t)width * height * (texture_format == "rgba" ? 4 : 3)))
+        {
+            close_asset_archive();
+            throw runtime_error(
+                "ERROR: texture asset \"" + asset_path + "\" in asset archive \"" + path + "\" has an invalid layout!");
+        }
+
+        archived_assets[asset_path] =
+        {
+            (Asset::Types)type,
+            archive_data + asset_offset,
+            asset_size,
+            texture_format,
+            (int)width,
+            (int)height,
+        };
+    }
+}
+
+
+void close_asset_archive()
+{
+    if (archive_data == nullptr)
+    {
+        return;
+    }
+
+#if _WIN32
+    UnmapViewOfFile(archive_data);
+    CloseHandle(archive_file_mapping);
+    CloseHandle(archive_file);
+    archive_file_mapping = nullptr;
+    archive_file = INVALID_HANDLE_VALUE;
+#elif __gnu_linux__
+    munmap((void *)archive_data, archive_size);
+#endif
+
+    archive_data = nullptr;
+    archive_size = 0;
+    archived_assets.clear();
+}
+
+
+void set_asset_root(const string & name, const string & path)
+{
+    string root_path = normalize_asset_path(path);
+
+    if (!root_path.empty() && root_path.back() != '/')
+    {
+        root_path += '/';
+    }
+
+    for (Asset_Root & asset_root : asset_roots)
+    {
+        if (asset_root.name == name)
+        {
+            asset_root.path = root_path;
+            return;
+        }
+    }
+
+    asset_roots.push_back({ name, root_path });
+}
+
+
+const Asset * get_archived_asset(const string & path)
+{
+    const auto archived_asset = archived_assets.find(get_asset_key(path));
+    return archived_asset != archived_assets.end() ? &archived_asset->second : nullptr;
+}
+
+
+bool asset_exists(const string & path)
+{
+    return get_archived_asset(path) != nullptr || file_exists(path);
+}
+
+
+string read_asset_file(const string & path)
+{
+    const Asset * asset = get_archived_asset(path);
+    return asset != nullptr ? string(asset->data, asset->size) : read_file(path);
+}
+
+
+JSON read_asset_json_file(const string & path)
+{
+    const Asset * asset = get_archived_asset(path);
+    return asset != nullptr ? JSON::parse(asset->data, asset->data + asset->size) : read_json_file(path);
+}
+
+
+} // namespace Nito
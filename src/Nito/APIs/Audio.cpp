@@ -18,6 +18,8 @@
 #include "Cpp_Utils/Collection.hpp"
 #include "Cpp_Utils/File.hpp"
 
+#include "Nito/APIs/Assets.hpp"
+
 
 using std::runtime_error;
 using std::string;
@@ -124,7 +126,12 @@ void init_openal()
 void load_audio_file(const string & path)
 {
 #if __gnu_linux__
-    const ALuint buffer = alutCreateBufferFromFile(path.c_str());
+    const Asset * asset = get_archived_asset(path);
+
+    const ALuint buffer =
+        asset != nullptr
+        ? alutCreateBufferFromFileImage(asset->data, asset->size)
+        : alutCreateBufferFromFile(path.c_str());
 
     if (buffer == AL_NONE)
     {
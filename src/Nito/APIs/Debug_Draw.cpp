@@ -0,0 +1,206 @@
+#include "Nito/APIs/Debug_Draw.hpp"
+
+#include <map>
+#include <string>
+#include <cmath>
+#include <glm/gtc/matrix_transform.hpp>
+#include "Cpp_Utils/Map.hpp"
+#include "Cpp_Utils/String.hpp"
+
+#include "Nito/APIs/Graphics.hpp"
+
+
+using std::map;
+using std::string;
+using std::vector;
+
+// glm/glm.hpp
+using glm::mat4;
+using glm::vec3;
+using glm::vec4;
+using glm::clamp;
+
+// glm/gtc/matrix_transform.hpp
+using glm::translate;
+
+// Cpp_Utils/Map.hpp
+using Cpp_Utils::contains_key;
+
+// Cpp_Utils/String.hpp
+using Cpp_Utils::to_string;
+
+
+namespace Nito
+{
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Debug_Draw_Batch
+{
+    vec4 color;
+    string vertex_container_id;
+    Render_Data::Uniforms uniforms;
+    vector<GLfloat> vertex_data;
+    vector<GLuint> index_data;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const string LAYER_NAME("world");
+static const string SHADER_PIPELINE_NAME("color");
+static const float DEPTH = -1.0f;
+static const int CIRCLE_SEGMENT_COUNT = 24;
+
+
+// Batches are keyed by their packed color so all lines of the same color are submitted as one draw. Batches are never
+// removed, so their addresses are stable for the render data that references them.
+static map<unsigned int, Debug_Draw_Batch> batches;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Utilities
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static unsigned int pack_color(const vec4 & color)
+{
+    const auto pack_channel = [](float channel) -> unsigned int
+    {
+        return (unsigned int)roundf(clamp(channel, 0.0f, 1.0f) * 255.0f);
+    };
+
+    return
+        (pack_channel(color.x) << 24) |
+        (pack_channel(color.y) << 16) |
+        (pack_channel(color.z) << 8) |
+        pack_channel(color.w);
+}
+
+
+static Debug_Draw_Batch & get_batch(const vec4 & color)
+{
+    const unsigned int key = pack_color(color);
+
+    if (!contains_key(batches, key))
+    {
+        Debug_Draw_Batch & batch = batches[key];
+        batch.color = color;
+        batch.vertex_container_id = "debug_draw : " + to_string(batches.size() - 1);
+        batch.uniforms["color"] = Uniform { Uniform::Types::VEC4, &batch.color };
+        return batch;
+    }
+
+    return batches[key];
+}
+
+
+static void push_vertex(Debug_Draw_Batch & batch, const vec3 & position, float pixels_per_unit)
+{
+    batch.index_data.push_back(batch.vertex_data.size() / 5);
+
+    // Position (depth is applied by the batch's model matrix)
+    batch.vertex_data.push_back(position.x * pixels_per_unit);
+    batch.vertex_data.push_back(position.y * pixels_per_unit);
+    batch.vertex_data.push_back(0.0f);
+
+    // UV
+    batch.vertex_data.push_back(0.0f);
+    batch.vertex_data.push_back(0.0f);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void draw_debug_line(const vec3 & begin, const vec3 & end, const vec4 & color)
+{
+    const float pixels_per_unit = get_pixels_per_unit();
+    Debug_Draw_Batch & batch = get_batch(color);
+    push_vertex(batch, begin, pixels_per_unit);
+    push_vertex(batch, end, pixels_per_unit);
+}
+
+
+void draw_debug_circle(const vec3 & center, float radius, const vec4 & color)
+{
+    static const float PI = 3.14159f;
+    static const float SEGMENT_ANGLE = (2 * PI) / CIRCLE_SEGMENT_COUNT;
+
+    const float pixels_per_unit = get_pixels_per_unit();
+    Debug_Draw_Batch & batch = get_batch(color);
+    vec3 previous_point = center + vec3(radius, 0.0f, 0.0f);
+
+    for (int segment = 1; segment <= CIRCLE_SEGMENT_COUNT; segment++)
+    {
+        const float angle = segment * SEGMENT_ANGLE;
+        const vec3 point = center + vec3(radius * cosf(angle), radius * sinf(angle), 0.0f);
+        push_vertex(batch, previous_point, pixels_per_unit);
+        push_vertex(batch, point, pixels_per_unit);
+        previous_point = point;
+    }
+}
+
+
+void draw_debug_polygon(const vector<vec3> & points, const vec4 & color)
+{
+    const size_t point_count = points.size();
+
+    if (point_count < 2)
+    {
+        return;
+    }
+
+    const float pixels_per_unit = get_pixels_per_unit();
+    Debug_Draw_Batch & batch = get_batch(color);
+
+    for (size_t i = 0; i < point_count; i++)
+    {
+        push_vertex(batch, points[i], pixels_per_unit);
+        push_vertex(batch, points[(i + 1) % point_count], pixels_per_unit);
+    }
+}
+
+
+void debug_draw_api_update()
+{
+    const mat4 model_matrix = translate(mat4(), vec3(0.0f, 0.0f, DEPTH * get_pixels_per_unit()));
+
+    for (auto & key_batch : batches)
+    {
+        Debug_Draw_Batch & batch = key_batch.second;
+
+        if (batch.index_data.size() == 0)
+        {
+            continue;
+        }
+
+        load_stream_vertex_data(batch.vertex_container_id, batch.vertex_data, batch.index_data);
+
+        load_render_data(
+            {
+                Render_Modes::LINES,
+                &LAYER_NAME,
+                nullptr,
+                &SHADER_PIPELINE_NAME,
+                &batch.vertex_container_id,
+                &batch.uniforms,
+                model_matrix,
+            });
+
+        batch.vertex_data.clear();
+        batch.index_data.clear();
+    }
+}
+
+
+} // namespace Nito
@@ -1,9 +1,15 @@
 #include "Nito/APIs/Graphics.hpp"
 
 #include <unordered_map>
+#include <list>
 #include <stdexcept>
 #include <functional>
 #include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+#include <fstream>
+#include <cstdint>
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include "Cpp_Utils/Fn.hpp"
@@ -14,13 +20,30 @@
 #include "Nito/APIs/Resources.hpp"
 
 
+#if _WIN32
+#include <direct.h>
+#elif __gnu_linux__
+#include <sys/stat.h>
+#endif
+
+
 using std::map;
 using std::unordered_map;
+using std::list;
 using std::vector;
 using std::string;
 using std::runtime_error;
 using std::function;
 using std::size_t;
+using std::memcpy;
+using std::chrono::steady_clock;
+using std::chrono::duration;
+using std::milli;
+using std::ifstream;
+using std::ofstream;
+using std::ios;
+using std::streamoff;
+using std::uint64_t;
 
 // glm/glm.hpp
 using glm::vec3;
@@ -50,6 +73,7 @@ using Cpp_Utils::for_each;
 // Cpp_Utils/Vector.hpp
 using Cpp_Utils::sort;
 using Cpp_Utils::remove;
+using Cpp_Utils::contains;
 
 
 #define DEBUG
@@ -89,6 +113,28 @@ struct Vertex_Container
     GLuint vertex_buffer;
     GLuint index_buffer;
     GLsizei index_count;
+
+    // Streamed vertex containers share the stream buffer and only hold a range of it for the current frame.
+    bool streamed;
+    GLsizei stream_index_offset;
+    GLint stream_base_vertex;
+};
+
+
+struct Stream_Buffer
+{
+    static const int SEGMENT_COUNT = 3;
+
+    GLuint vertex_array;
+    GLuint vertex_buffer;
+    GLuint index_buffer;
+
+    // Capacities of each segment, in vertices and indexes.
+    GLsizei vertex_segment_capacity;
+    GLsizei index_segment_capacity;
+
+    int segment;
+    GLsync segment_fences[SEGMENT_COUNT];
 };
 
 
@@ -99,6 +145,24 @@ struct Texture_Format
 };
 
 
+struct Texture_Upload
+{
+    string identifier;
+    GLuint texture_object;
+    GLuint pixel_buffer;
+    GLsync fence;
+};
+
+
+// Resident textures are kept in the order they were last used, so the least-recently-used one is always first.
+struct Texture_Residency
+{
+    size_t size;
+    unsigned int last_used_frame;
+    list<string>::iterator usage_position;
+};
+
+
 struct Render_Layer
 {
     vector<Render_Data> render_datas;
@@ -113,6 +177,18 @@ struct Render_Layer
 };
 
 
+// Ring of timer queries for a render layer, so results can be read back once the GPU has finished with them instead of
+// stalling on the frame that was just submitted.
+struct Render_Layer_Timer
+{
+    static const int QUERY_COUNT = 4;
+
+    GLuint queries[QUERY_COUNT];
+    bool pending[QUERY_COUNT];
+    int query;
+};
+
+
 struct Light_Source_Data
 {
     float intensity;
@@ -148,6 +224,27 @@ static map<int, Light_Source_Data> light_sources;
 static int light_source_id_index = 0;
 static vector<int> used_light_source_ids;
 static vector<int> unused_light_source_ids;
+static Stream_Buffer stream_buffer;
+static vector<GLfloat> stream_vertex_data;
+static vector<GLuint> stream_index_data;
+static vector<string> stream_vertex_container_ids;
+static Render_Bounds render_view_bounds;
+static bool render_view_bounds_set = false;
+static GLuint offscreen_framebuffer = 0;
+static GLuint offscreen_renderbuffers[2] {};
+static map<string, Render_Layer_Stats> render_layer_stats;
+static map<string, Render_Layer_Timer> render_layer_timers;
+static bool render_timer_queries_enabled = false;
+static string shader_cache_path;
+static vector<Texture_Upload> texture_uploads;
+static vector<GLuint> pixel_buffers;
+static GLuint placeholder_texture_object = 0;
+static map<string, Texture_Residency> texture_residencies;
+static list<string> texture_usage_order;
+static size_t resident_texture_size = 0;
+static size_t texture_memory_budget;
+static unsigned int frame = 0;
+static Texture_Loader texture_loader;
 
 
 Vertex_Attribute::Types Vertex_Attribute::types
@@ -156,6 +253,22 @@ Vertex_Attribute::Types Vertex_Attribute::types
 };
 
 
+static const map<string, const GLint> INTERNAL_TEXTURE_FORMATS
+{
+    { "rgba" , GL_RGBA },
+    { "rgb"  , GL_RGB  },
+    { "r"    , GL_RED  },
+};
+
+
+static const map<string, const int> BYTES_PER_PIXEL
+{
+    { "rgba" , 4 },
+    { "rgb"  , 3 },
+    { "r"    , 1 },
+};
+
+
 static const map<string, const GLenum> CAPABILITIES
 {
     { "blend"        , GL_BLEND        },
@@ -189,6 +302,57 @@ static Vertex_Attribute create_vertex_attribute(const string & type_name, GLint
 }
 
 
+static const vector<Vertex_Attribute> & get_vertex_attributes()
+{
+    // Vertex attribute specification
+    static const vector<Vertex_Attribute> VERTEX_ATTRIBUTES
+    {
+        create_vertex_attribute("float", 3, GL_FALSE), // Position
+        create_vertex_attribute("float", 2, GL_FALSE), // UV
+    };
+
+    return VERTEX_ATTRIBUTES;
+}
+
+
+static GLsizei get_vertex_stride()
+{
+    static const GLsizei VERTEX_STRIDE =
+        accumulate(
+            (GLsizei)0,
+            get_vertex_attributes(),
+            [](GLsizei total, const Vertex_Attribute & vertex_attribute) -> GLsizei
+            {
+                return total + vertex_attribute.size;
+            });
+
+    return VERTEX_STRIDE;
+}
+
+
+static void define_vertex_attribute_pointers()
+{
+    const vector<Vertex_Attribute> & vertex_attributes = get_vertex_attributes();
+    size_t current_attribute_offset = 0;
+
+    for (GLuint attribute_index = 0u; attribute_index < vertex_attributes.size(); attribute_index++)
+    {
+        const Vertex_Attribute & vertex_attribute = vertex_attributes[attribute_index];
+        glEnableVertexAttribArray(attribute_index);
+
+        glVertexAttribPointer(
+            attribute_index,                     // Index of attribute
+            vertex_attribute.element_count,      // Number of attribute elements
+            vertex_attribute.type.gl_type,       // Type of attribute elements
+            vertex_attribute.is_normalized,      // Should attribute elements be normalized?
+            get_vertex_stride(),                 // Stride between attributes
+            (GLvoid *)current_attribute_offset); // Pointer offset to first element of attribute
+
+        current_attribute_offset += vertex_attribute.size;
+    }
+}
+
+
 static void validate_parameter_is(
     GLuint shader_entity,
     GLenum parameter,
@@ -237,6 +401,146 @@ static void compile_shader_object(GLuint shader_object, const vector<string> & s
 }
 
 
+static bool program_binaries_supported()
+{
+    GLint binary_format_count = 0;
+
+    if (GLEW_ARB_get_program_binary)
+    {
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_format_count);
+    }
+
+    return binary_format_count > 0;
+}
+
+
+static string get_program_binary_path(const Shader_Pipeline & shader_pipeline)
+{
+    static const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+    static const uint64_t FNV_PRIME = 1099511628211ull;
+
+    static const bool BINARIES_SUPPORTED = program_binaries_supported();
+
+    if (shader_cache_path.empty() || !BINARIES_SUPPORTED)
+    {
+        return "";
+    }
+
+
+    // Binaries are only valid for the driver that produced them, so the driver strings are hashed along with the
+    // pipeline's sources (which include the shared version.glsl and vertex_attributes.glsl sources).
+    uint64_t hash = FNV_OFFSET_BASIS;
+
+    const auto hash_string = [&](const string & value) -> void
+    {
+        for (const char character : value)
+        {
+            hash = (hash ^ (unsigned char)character) * FNV_PRIME;
+        }
+
+        // Separate strings so different splits of the same characters don't hash equally.
+        hash = (hash ^ 0xFF) * FNV_PRIME;
+    };
+
+    for (const GLenum driver_string : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+    {
+        hash_string((const char *)glGetString(driver_string));
+    }
+
+    for_each(shader_pipeline.shader_sources, [&](const string & shader_type, const vector<string> & sources) -> void
+    {
+        hash_string(shader_type);
+
+        for (const string & source : sources)
+        {
+            hash_string(source);
+        }
+    });
+
+    char hash_name[17];
+    snprintf(hash_name, sizeof(hash_name), "%016llx", (unsigned long long)hash);
+    return shader_cache_path + hash_name + ".bin";
+}
+
+
+static bool load_program_binary(GLuint shader_program, const string & binary_path)
+{
+    ifstream binary_file(binary_path, ios::binary | ios::ate);
+
+    if (binary_path.empty() || !binary_file)
+    {
+        return false;
+    }
+
+
+    // The file is the binary's format followed by the binary itself.
+    const streamoff binary_size = binary_file.tellg() - (streamoff)sizeof(GLenum);
+
+    if (binary_size <= 0)
+    {
+        return false;
+    }
+
+    GLenum binary_format;
+    vector<char> binary(binary_size);
+    binary_file.seekg(0);
+    binary_file.read((char *)&binary_format, sizeof(binary_format));
+    binary_file.read(&binary[0], binary_size);
+
+    if (!binary_file)
+    {
+        return false;
+    }
+
+
+    // Don't pass formats the driver no longer supports, as that would raise an OpenGL error.
+    GLint binary_format_count;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_format_count);
+    vector<GLint> binary_formats(binary_format_count);
+    glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, &binary_formats[0]);
+
+    if (!contains(binary_formats, (GLint)binary_format))
+    {
+        return false;
+    }
+
+
+    // A binary the driver rejects fails to link, in which case the program is compiled from source instead.
+    GLint link_status;
+    glProgramBinary(shader_program, binary_format, &binary[0], binary.size());
+    glGetProgramiv(shader_program, GL_LINK_STATUS, &link_status);
+    return link_status == GL_TRUE;
+}
+
+
+static void save_program_binary(GLuint shader_program, const string & binary_path)
+{
+    GLint binary_length;
+    GLenum binary_format;
+    glGetProgramiv(shader_program, GL_PROGRAM_BINARY_LENGTH, &binary_length);
+
+    if (binary_length <= 0)
+    {
+        return;
+    }
+
+    vector<char> binary(binary_length);
+    glGetProgramBinary(shader_program, binary_length, nullptr, &binary_format, &binary[0]);
+
+
+    // Failing to write the cache isn't an error; the program is compiled from source again next launch.
+#if _WIN32
+    _mkdir(shader_cache_path.c_str());
+#elif __gnu_linux__
+    mkdir(shader_cache_path.c_str(), 0755);
+#endif
+
+    ofstream binary_file(binary_path, ios::binary | ios::trunc);
+    binary_file.write((const char *)&binary_format, sizeof(binary_format));
+    binary_file.write(&binary[0], binary.size());
+}
+
+
 static void set_uniform(GLuint shader_program, const GLchar * uniform_name, const vec3 & uniform_value)
 {
     glUniform3f(
@@ -339,6 +643,475 @@ static void bind_texture(GLuint texture_object, GLuint texture_unit)
 }
 
 
+static bool begin_render_layer_timer(const string & layer_name, Render_Layer_Stats & layer_stats)
+{
+    if (!render_timer_queries_enabled)
+    {
+        layer_stats.gpu_time = -1.0f;
+        return false;
+    }
+
+    const bool new_timer = !contains_key(render_layer_timers, layer_name);
+    Render_Layer_Timer & timer = render_layer_timers[layer_name];
+
+    if (new_timer)
+    {
+        glGenQueries(Render_Layer_Timer::QUERY_COUNT, timer.queries);
+    }
+
+
+    // Read back finished queries from oldest to newest without blocking. Queries finish in submission order, so the
+    // first unfinished query ends the search.
+    for (int i = 0; i < Render_Layer_Timer::QUERY_COUNT; i++)
+    {
+        const int query = (timer.query + i) % Render_Layer_Timer::QUERY_COUNT;
+        GLint available;
+        GLuint64 elapsed_time;
+
+        if (!timer.pending[query])
+        {
+            continue;
+        }
+
+        glGetQueryObjectiv(timer.queries[query], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available)
+        {
+            break;
+        }
+
+        glGetQueryObjectui64v(timer.queries[query], GL_QUERY_RESULT, &elapsed_time);
+        layer_stats.gpu_time = elapsed_time / 1000000.0f;
+        timer.pending[query] = false;
+    }
+
+
+    // Skip timing this frame if the GPU is so far behind that every query is still in flight.
+    if (timer.pending[timer.query])
+    {
+        return false;
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, timer.queries[timer.query]);
+    timer.pending[timer.query] = true;
+    timer.query = (timer.query + 1) % Render_Layer_Timer::QUERY_COUNT;
+    return true;
+}
+
+
+static GLuint create_texture_object(const Texture::Options & options)
+{
+    static const map<string, const GLint> TEXTURE_OPTION_KEYS
+    {
+        { "wrap_s"     , GL_TEXTURE_WRAP_S     },
+        { "wrap_t"     , GL_TEXTURE_WRAP_T     },
+        { "min_filter" , GL_TEXTURE_MIN_FILTER },
+        { "mag_filter" , GL_TEXTURE_MAG_FILTER },
+    };
+
+    static const map<string, const GLint> TEXTURE_OPTION_VALUES
+    {
+        // Wrap values
+        { "repeat"          , GL_REPEAT          },
+        { "mirrored_repeat" , GL_MIRRORED_REPEAT },
+        { "clamp_to_edge"   , GL_CLAMP_TO_EDGE   },
+
+        // Filter values
+        { "linear"  , GL_LINEAR  },
+        { "nearest" , GL_NEAREST },
+
+        // Mipmapped filter values (min_filter only)
+        { "nearest_mipmap_nearest" , GL_NEAREST_MIPMAP_NEAREST },
+        { "linear_mipmap_nearest"  , GL_LINEAR_MIPMAP_NEAREST  },
+        { "nearest_mipmap_linear"  , GL_NEAREST_MIPMAP_LINEAR  },
+        { "linear_mipmap_linear"   , GL_LINEAR_MIPMAP_LINEAR   },
+    };
+
+
+    // Create new texture object and leave it bound so its data can be loaded.
+    GLuint texture_object;
+    glGenTextures(1, &texture_object);
+    glBindTexture(GL_TEXTURE_2D, texture_object);
+
+
+    // Configure options for the texture object.
+    for_each(options, [&](const string & option_key, const string & option_value) -> void
+    {
+        glTexParameteri(
+            GL_TEXTURE_2D,
+            TEXTURE_OPTION_KEYS.at(option_key),
+            TEXTURE_OPTION_VALUES.at(option_value));
+    });
+
+    return texture_object;
+}
+
+
+static GLuint create_texture_object(const Texture & texture, const void * data)
+{
+    // Create new texture object that will be used to load texture data.
+    const Dimensions & dimensions = texture.dimensions;
+    const GLuint internal_format = INTERNAL_TEXTURE_FORMATS.at(texture.format);
+    const GLuint texture_object = create_texture_object(texture.options);
+
+
+    // Load texture data (null data only allocates the texture's storage).
+    glTexImage2D(
+        GL_TEXTURE_2D,     // Target
+        0,                 // Level of detail (0 is base image LOD)
+        internal_format,   // Internal format
+        dimensions.width,  // Image width
+        dimensions.height, // Image height
+        0,                 // Border width (must be 0 apparently?)
+        internal_format,   // Texel data format (must match internal format)
+        GL_UNSIGNED_BYTE,  // Texel data type
+        data);             // Pointer to image data
+
+
+    // Generate mipmaps from the loaded data if requested.
+    if (texture.mipmaps && data != nullptr)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+
+    // Unbind texture object now that its data has been loaded.
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    return texture_object;
+}
+
+
+// Creates a transparent placeholder texture that is bound in place of textures that haven't finished loading.
+static GLuint get_placeholder_texture_object()
+{
+    if (placeholder_texture_object == 0)
+    {
+        static const GLubyte PLACEHOLDER_DATA[4] { 0, 0, 0, 0 };
+        static const Texture PLACEHOLDER_TEXTURE { "rgba", {}, { 1.0f, 1.0f, vec3() }, false };
+        placeholder_texture_object = create_texture_object(PLACEHOLDER_TEXTURE, PLACEHOLDER_DATA);
+    }
+
+    return placeholder_texture_object;
+}
+
+
+// Binds a texture object to an identifier, deleting the object it replaces (unless it's the shared placeholder).
+static void set_texture_object(const string & identifier, GLuint texture_object)
+{
+    const auto existing_texture_object = texture_objects.find(identifier);
+
+    if (existing_texture_object == texture_objects.end())
+    {
+        texture_objects[identifier] = texture_object;
+        return;
+    }
+
+    if (existing_texture_object->second != placeholder_texture_object &&
+        existing_texture_object->second != texture_object)
+    {
+        glDeleteTextures(1, &existing_texture_object->second);
+    }
+
+    existing_texture_object->second = texture_object;
+}
+
+
+// Drops an upload still in flight for a texture that is being loaded again, so it can't replace the newer texture when
+// it finishes. Its pixel buffer is returned to the pool, since reusing it re-allocates its storage.
+static void cancel_texture_upload(const string & identifier)
+{
+    for (auto texture_upload = texture_uploads.begin(); texture_upload != texture_uploads.end(); texture_upload++)
+    {
+        if (texture_upload->identifier == identifier)
+        {
+            glDeleteTextures(1, &texture_upload->texture_object);
+            pixel_buffers.push_back(texture_upload->pixel_buffer);
+            glDeleteSync(texture_upload->fence);
+            texture_uploads.erase(texture_upload);
+            return;
+        }
+    }
+}
+
+
+static void complete_texture_uploads()
+{
+    // Swap in textures whose uploads have finished, without waiting on the ones still in flight.
+    for (auto texture_upload = texture_uploads.begin(); texture_upload != texture_uploads.end();)
+    {
+        if (glClientWaitSync(texture_upload->fence, 0, 0) == GL_TIMEOUT_EXPIRED)
+        {
+            texture_upload++;
+            continue;
+        }
+
+        set_texture_object(texture_upload->identifier, texture_upload->texture_object);
+        pixel_buffers.push_back(texture_upload->pixel_buffer);
+        glDeleteSync(texture_upload->fence);
+        texture_upload = texture_uploads.erase(texture_upload);
+    }
+}
+
+
+static void mark_texture_used(Texture_Residency & texture_residency)
+{
+    texture_residency.last_used_frame = frame;
+    texture_usage_order.splice(texture_usage_order.end(), texture_usage_order, texture_residency.usage_position);
+}
+
+
+static void track_texture_residency(const string & identifier, size_t size)
+{
+    auto texture_residency = texture_residencies.find(identifier);
+
+    if (texture_residency == texture_residencies.end())
+    {
+        const auto usage_position = texture_usage_order.insert(texture_usage_order.end(), identifier);
+        texture_residency = texture_residencies.insert({ identifier, { 0, frame, usage_position } }).first;
+    }
+
+    resident_texture_size = (resident_texture_size - texture_residency->second.size) + size;
+    texture_residency->second.size = size;
+    mark_texture_used(texture_residency->second);
+}
+
+
+static size_t get_texture_size(const Texture & texture)
+{
+    const size_t base_size =
+        texture.dimensions.width * texture.dimensions.height * BYTES_PER_PIXEL.at(texture.format);
+
+    // A full mip chain adds a third of the base level's size.
+    return texture.mipmaps ? (base_size * 4) / 3 : base_size;
+}
+
+
+static void use_texture(const string & identifier)
+{
+    // Load textures on their first use after being evicted (or never loaded), binding the placeholder in their place if
+    // the loader doesn't finish loading them immediately.
+    if (!contains_key(texture_objects, identifier) && texture_loader)
+    {
+        texture_loader(identifier);
+
+        if (!contains_key(texture_objects, identifier))
+        {
+            texture_objects[identifier] = get_placeholder_texture_object();
+        }
+    }
+
+    const auto texture_residency = texture_residencies.find(identifier);
+
+    if (texture_residency != texture_residencies.end())
+    {
+        mark_texture_used(texture_residency->second);
+    }
+}
+
+
+static void evict_textures()
+{
+    // Evict least-recently-used textures until resident textures fit within the budget. Textures used this frame are
+    // never evicted, and as they are last in the usage order, eviction stops at the first one. Textures still being
+    // uploaded are skipped.
+    auto least_recently_used = texture_usage_order.begin();
+
+    while (texture_memory_budget > 0 &&
+           resident_texture_size > texture_memory_budget &&
+           least_recently_used != texture_usage_order.end())
+    {
+        const auto texture_residency = texture_residencies.find(*least_recently_used);
+        const auto texture_object = texture_objects.find(*least_recently_used);
+
+        if (texture_residency->second.last_used_frame == frame)
+        {
+            break;
+        }
+
+        if (texture_object->second == placeholder_texture_object)
+        {
+            least_recently_used++;
+            continue;
+        }
+
+        glDeleteTextures(1, &texture_object->second);
+        texture_objects.erase(texture_object);
+        resident_texture_size -= texture_residency->second.size;
+        texture_residencies.erase(texture_residency);
+        least_recently_used = texture_usage_order.erase(least_recently_used);
+    }
+}
+
+
+static void allocate_stream_buffer(GLsizei vertex_segment_capacity, GLsizei index_segment_capacity)
+{
+    if (stream_buffer.vertex_array == 0)
+    {
+        glGenVertexArrays(1, &stream_buffer.vertex_array);
+        glGenBuffers(1, &stream_buffer.vertex_buffer);
+        glGenBuffers(1, &stream_buffer.index_buffer);
+    }
+
+
+    // (Re)allocating the buffers' storage orphans any storage the GPU is still reading from, so pending segment fences
+    // no longer need to be waited on.
+    for (GLsync & segment_fence : stream_buffer.segment_fences)
+    {
+        if (segment_fence != nullptr)
+        {
+            glDeleteSync(segment_fence);
+            segment_fence = nullptr;
+        }
+    }
+
+    stream_buffer.vertex_segment_capacity = vertex_segment_capacity;
+    stream_buffer.index_segment_capacity = index_segment_capacity;
+    stream_buffer.segment = 0;
+
+    glBindVertexArray(stream_buffer.vertex_array);
+    glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.vertex_buffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, stream_buffer.index_buffer);
+
+    glBufferData(
+        GL_ARRAY_BUFFER,
+        vertex_segment_capacity * get_vertex_stride() * Stream_Buffer::SEGMENT_COUNT,
+        nullptr,
+        GL_STREAM_DRAW);
+
+    glBufferData(
+        GL_ELEMENT_ARRAY_BUFFER,
+        index_segment_capacity * sizeof(GLuint) * Stream_Buffer::SEGMENT_COUNT,
+        nullptr,
+        GL_STREAM_DRAW);
+
+    define_vertex_attribute_pointers();
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+
+static void write_stream_segment(GLenum target, GLintptr offset, GLsizeiptr size, const void * data)
+{
+    // The segment being written is not in use by the GPU (its fence has been waited on), so the write doesn't need to be
+    // synchronized with previous draws.
+    void * segment = glMapBufferRange(
+        target,
+        offset,
+        size,
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+    if (segment == nullptr)
+    {
+        throw runtime_error("OPENGL ERROR: failed to map stream buffer segment!");
+    }
+
+    memcpy(segment, data, size);
+    glUnmapBuffer(target);
+}
+
+
+static void upload_stream_data()
+{
+    static const GLsizei INITIAL_VERTEX_SEGMENT_CAPACITY = 4096;
+    static const GLsizei INITIAL_INDEX_SEGMENT_CAPACITY = 6144;
+
+    if (stream_index_data.size() == 0)
+    {
+        return;
+    }
+
+    const GLsizei vertex_stride = get_vertex_stride();
+    const GLsizei vertex_count = (stream_vertex_data.size() * sizeof(GLfloat)) / vertex_stride;
+    const GLsizei index_count = stream_index_data.size();
+
+
+    // Grow stream buffer if this frame's data doesn't fit in a segment.
+    if (stream_buffer.vertex_array == 0 ||
+        vertex_count > stream_buffer.vertex_segment_capacity ||
+        index_count > stream_buffer.index_segment_capacity)
+    {
+        GLsizei vertex_segment_capacity = stream_buffer.vertex_segment_capacity;
+        GLsizei index_segment_capacity = stream_buffer.index_segment_capacity;
+
+        if (vertex_segment_capacity == 0)
+        {
+            vertex_segment_capacity = INITIAL_VERTEX_SEGMENT_CAPACITY;
+            index_segment_capacity = INITIAL_INDEX_SEGMENT_CAPACITY;
+        }
+
+        while (vertex_count > vertex_segment_capacity)
+        {
+            vertex_segment_capacity *= 2;
+        }
+
+        while (index_count > index_segment_capacity)
+        {
+            index_segment_capacity *= 2;
+        }
+
+        allocate_stream_buffer(vertex_segment_capacity, index_segment_capacity);
+    }
+
+
+    // Wait until the GPU has finished reading the segment from Stream_Buffer::SEGMENT_COUNT frames ago before
+    // overwriting it; this only blocks if the GPU has fallen that far behind.
+    const int segment = stream_buffer.segment;
+    GLsync & segment_fence = stream_buffer.segment_fences[segment];
+
+    if (segment_fence != nullptr)
+    {
+        GLenum wait_result;
+
+        do
+        {
+            wait_result = glClientWaitSync(segment_fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);
+        }
+        while (wait_result == GL_TIMEOUT_EXPIRED);
+
+        if (wait_result == GL_WAIT_FAILED)
+        {
+            throw runtime_error("OPENGL ERROR: failed to wait for stream buffer segment!");
+        }
+
+        glDeleteSync(segment_fence);
+        segment_fence = nullptr;
+    }
+
+
+    // Write this frame's data into the segment, then offset streamed vertex containers' ranges to it. Index data is
+    // written through GL_COPY_WRITE_BUFFER so no vertex array's element array binding is changed.
+    const GLsizei segment_base_vertex = segment * stream_buffer.vertex_segment_capacity;
+    const GLsizei segment_index_offset = segment * stream_buffer.index_segment_capacity;
+    glBindBuffer(GL_ARRAY_BUFFER, stream_buffer.vertex_buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stream_buffer.index_buffer);
+
+    write_stream_segment(
+        GL_ARRAY_BUFFER,
+        segment_base_vertex * vertex_stride,
+        stream_vertex_data.size() * sizeof(GLfloat),
+        &stream_vertex_data[0]);
+
+    write_stream_segment(
+        GL_COPY_WRITE_BUFFER,
+        segment_index_offset * sizeof(GLuint),
+        index_count * sizeof(GLuint),
+        &stream_index_data[0]);
+
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    for (const string & id : stream_vertex_container_ids)
+    {
+        Vertex_Container & vertex_container = vertex_containers.at(id);
+        vertex_container.vertex_array = stream_buffer.vertex_array;
+        vertex_container.stream_index_offset += segment_index_offset;
+        vertex_container.stream_base_vertex += segment_base_vertex;
+    }
+}
+
+
 static void set_shader_pipeline_uniforms(GLuint shader_program, const Render_Data::Uniforms * uniforms)
 {
     for_each(*uniforms, [&](const string & uniform_name, const Uniform & uniform) -> void
@@ -381,14 +1154,62 @@ void init_glew()
     glewExperimental = GL_TRUE;
 
 
-    // Validate GLEW initialized properly.
-    if (glewInit() != GLEW_OK)
+    // Validate GLEW initialized properly. Contexts without a GLX display (like headless OSMesa contexts) still load all
+    // core OpenGL functions, so a missing GLX display isn't an error.
+    const GLenum glew_status = glewInit();
+
+    if (glew_status != GLEW_OK && glew_status != GLEW_ERROR_NO_GLX_DISPLAY)
     {
         throw runtime_error("GLEW ERROR: failed to initialize GLEW!");
     }
 }
 
 
+void create_offscreen_framebuffer(int width, int height)
+{
+    if (offscreen_framebuffer != 0)
+    {
+        throw runtime_error("ERROR: an offscreen framebuffer has already been created!");
+    }
+
+
+    // Create color and depth/stencil attachments.
+    glGenRenderbuffers(2, offscreen_renderbuffers);
+    glBindRenderbuffer(GL_RENDERBUFFER, offscreen_renderbuffers[0]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, offscreen_renderbuffers[1]);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+
+    // Create framebuffer and leave it bound so all rendering is done offscreen.
+    glGenFramebuffers(1, &offscreen_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, offscreen_framebuffer);
+
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER,
+        GL_COLOR_ATTACHMENT0,
+        GL_RENDERBUFFER,
+        offscreen_renderbuffers[0]);
+
+    glFramebufferRenderbuffer(
+        GL_FRAMEBUFFER,
+        GL_DEPTH_STENCIL_ATTACHMENT,
+        GL_RENDERBUFFER,
+        offscreen_renderbuffers[1]);
+
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+    {
+        throw runtime_error("ERROR: offscreen framebuffer is incomplete!");
+    }
+
+
+#ifdef DEBUG
+    validate_no_opengl_error("create_offscreen_framebuffer()");
+#endif
+}
+
+
 void configure_opengl(const OpenGL_Config & opengl_config)
 {
     static const map<string, const GLbitfield> CLEAR_FLAG_MASKS
@@ -491,6 +1312,14 @@ void configure_opengl(const OpenGL_Config & opengl_config)
     default_vertex_container_id = opengl_config.default_vertex_container_id;
 
 
+    // Set directory linked shader programs are cached in.
+    shader_cache_path = opengl_config.shader_cache_path;
+
+
+    // Set memory budget for evictable textures (0 disables eviction).
+    texture_memory_budget = (size_t)opengl_config.texture_memory_budget * 1024 * 1024;
+
+
     // Validate no OpenGL errors occurred.
     validate_no_opengl_error("configure_opengl()");
 }
@@ -511,6 +1340,18 @@ void load_shader_pipelines(const vector<Shader_Pipeline> & shader_pipelines)
     // Process shader pipelines.
     for (const Shader_Pipeline & shader_pipeline : shader_pipelines)
     {
+        // Use the cached binary for the pipeline if one was saved for the same sources and driver.
+        const string binary_path = get_program_binary_path(shader_pipeline);
+        shader_program = glCreateProgram();
+
+        if (load_program_binary(shader_program, binary_path))
+        {
+            shader_programs[shader_pipeline.name] = shader_program;
+            shader_program = 0;
+            continue;
+        }
+
+
         // Create and compile shader objects from sources.
         for_each(shader_pipeline.shader_sources, [&](const string & shader_type, const vector<string> & sources) -> void
         {
@@ -525,12 +1366,15 @@ void load_shader_pipelines(const vector<Shader_Pipeline> & shader_pipelines)
         });
 
 
-        // Create, attach shader objects to and link shader program.
-        shader_program = glCreateProgram();
-
+        // Attach shader objects to and link shader program.
         for (const GLuint shader_object : shader_objects)
         {
-            glAttachShader(shader_program, shader_object);
+            glAttachShader(shader_program, shader_object);
+        }
+
+        if (!binary_path.empty())
+        {
+            glProgramParameteri(shader_program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
         }
 
         glLinkProgram(shader_program);
@@ -546,6 +1390,11 @@ void load_shader_pipelines(const vector<Shader_Pipeline> & shader_pipelines)
 
         shader_programs[shader_pipeline.name] = shader_program;
 
+        if (!binary_path.empty())
+        {
+            save_program_binary(shader_program, binary_path);
+        }
+
 
         // Detach and delete shaders, as they are no longer needed by anything.
         for (const GLuint shader_object : shader_objects)
@@ -567,99 +1416,200 @@ void load_shader_pipelines(const vector<Shader_Pipeline> & shader_pipelines)
 }
 
 
-void load_texture_data(const Texture & texture, const void * data, const string & identifier)
+void load_texture_data(const Texture & texture, const void * data, const string & identifier, bool evictable)
 {
-    static const map<string, const GLint> TEXTURE_OPTION_KEYS
-    {
-        { "wrap_s"     , GL_TEXTURE_WRAP_S     },
-        { "wrap_t"     , GL_TEXTURE_WRAP_T     },
-        { "min_filter" , GL_TEXTURE_MIN_FILTER },
-        { "mag_filter" , GL_TEXTURE_MAG_FILTER },
-    };
+    // Create texture object and load texture data directly from client memory.
+    cancel_texture_upload(identifier);
+    set_texture_object(identifier, create_texture_object(texture, data));
 
-    static const map<string, const GLint> TEXTURE_OPTION_VALUES
+    if (evictable)
     {
-        // Wrap values
-        { "repeat"          , GL_REPEAT          },
-        { "mirrored_repeat" , GL_MIRRORED_REPEAT },
-        { "clamp_to_edge"   , GL_CLAMP_TO_EDGE   },
+        track_texture_residency(identifier, get_texture_size(texture));
+    }
+
+
+    // Validate no OpenGL errors occurred.
+    validate_no_opengl_error("load_texture_data()");
+}
 
-        // Filter values
-        { "linear"  , GL_LINEAR  },
-        { "nearest" , GL_NEAREST },
-    };
 
-    static const map<string, const GLint> INTERNAL_FORMATS
+void load_compressed_texture_data(
+    const Texture & texture,
+    const vector<char> & data,
+    const vector<Compressed_Texture_Level> & levels,
+    const string & identifier,
+    bool evictable)
+{
+    static const map<string, const GLenum> COMPRESSED_TEXTURE_FORMATS
     {
-        { "rgba" , GL_RGBA },
-        { "rgb"  , GL_RGB  },
-        { "r"    , GL_RED  },
+        { "bc1"     , GL_COMPRESSED_RGBA_S3TC_DXT1_EXT },
+        { "bc1_rgb" , GL_COMPRESSED_RGB_S3TC_DXT1_EXT  },
+        { "bc3"     , GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },
+        { "bc7"     , GL_COMPRESSED_RGBA_BPTC_UNORM    },
     };
 
+    if (!contains_key(COMPRESSED_TEXTURE_FORMATS, texture.format))
+    {
+        throw runtime_error("ERROR: \"" + texture.format + "\" is not a supported compressed texture format!");
+    }
 
-    // Create new texture object that will be used to load texture data.
-    const Dimensions & dimensions = texture.dimensions;
-    const GLuint internal_format = INTERNAL_FORMATS.at(texture.format);
-    GLuint texture_object;
-    glGenTextures(1, &texture_object);
-    glBindTexture(GL_TEXTURE_2D, texture_object);
 
+    // S3TC formats are only available through an extension, and BPTC formats through an extension before OpenGL 4.2, so
+    // check the driver supports the texture's format rather than uploading data it can't read.
+    const bool format_supported =
+        texture.format == "bc7"
+        ? GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc
+        : GLEW_EXT_texture_compression_s3tc;
 
-    // Configure options for the texture object.
-    for_each(texture.options, [&](const string & option_key, const string & option_value) -> void
+    if (!format_supported)
     {
-        glTexParameteri(
-            GL_TEXTURE_2D,
-            TEXTURE_OPTION_KEYS.at(option_key),
-            TEXTURE_OPTION_VALUES.at(option_value));
-    });
+        throw runtime_error(
+            "ERROR: can't load texture \"" + identifier + "\", the OpenGL driver doesn't support its \"" +
+            texture.format + "\" compressed format!");
+    }
 
 
-    // Load texture data.
-    glTexImage2D(
-        GL_TEXTURE_2D,     // Target
-        0,                 // Level of detail (0 is base image LOD)
-        internal_format,   // Internal format
-        dimensions.width,  // Image width
-        dimensions.height, // Image height
-        0,                 // Border width (must be 0 apparently?)
-        internal_format,   // Texel data format (must match internal format)
-        GL_UNSIGNED_BYTE,  // Texel data type
-        data);             // Pointer to image data
+    // Load each mip level stored in the data. Compressed data can't have its mipmaps generated, so only the levels
+    // provided are used.
+    cancel_texture_upload(identifier);
+    const GLenum internal_format = COMPRESSED_TEXTURE_FORMATS.at(texture.format);
+    const GLuint texture_object = create_texture_object(texture.options);
+    const int level_count = levels.size();
 
+    for (int level = 0; level < level_count; level++)
+    {
+        const Compressed_Texture_Level & compressed_texture_level = levels[level];
+
+        glCompressedTexImage2D(
+            GL_TEXTURE_2D,                           // Target
+            level,                                   // Level of detail
+            internal_format,                         // Internal format
+            compressed_texture_level.width,          // Level width
+            compressed_texture_level.height,         // Level height
+            0,                                       // Border width (must be 0)
+            compressed_texture_level.size,           // Size of compressed level data
+            &data[compressed_texture_level.offset]); // Pointer to compressed level data
+    }
 
-    // Unbind texture object now that its data has been loaded.
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, level_count - 1);
     glBindTexture(GL_TEXTURE_2D, 0);
 
 
     // Track texture object by its identifier.
-    texture_objects[identifier] = texture_object;
+    set_texture_object(identifier, texture_object);
+
+    if (evictable)
+    {
+        const size_t texture_size =
+            accumulate(
+                (size_t)0,
+                levels,
+                [](size_t total, const Compressed_Texture_Level & level) -> size_t
+                {
+                    return total + level.size;
+                });
+
+        track_texture_residency(identifier, texture_size);
+    }
 
 
     // Validate no OpenGL errors occurred.
-    validate_no_opengl_error("load_texture_data()");
+    validate_no_opengl_error("load_compressed_texture_data()");
 }
 
 
-void load_vertex_data(const string & id, const vector<GLfloat> & vertex_data, const vector<GLuint> & index_data)
+void load_texture_data_async(const Texture & texture, const void * data, const string & identifier, bool evictable)
 {
-    // Vertex attribute specification
-    static const vector<Vertex_Attribute> VERTEX_ATTRIBUTES
+    // Textures without data have nothing to upload, so their storage is allocated immediately.
+    if (data == nullptr)
     {
-        create_vertex_attribute("float", 3, GL_FALSE), // Position
-        create_vertex_attribute("float", 2, GL_FALSE), // UV
-    };
+        load_texture_data(texture, data, identifier, evictable);
+        return;
+    }
 
-    static const GLsizei VERTEX_STRIDE =
-        accumulate(
-            (GLsizei)0,
-            VERTEX_ATTRIBUTES,
-            [](GLsizei total, const Vertex_Attribute & vertex_attribute) -> GLsizei
-            {
-                return total + vertex_attribute.size;
-            });
+
+    // Copy texture data into a pixel buffer, which OpenGL copies into the texture object asynchronously. Only the
+    // latest upload for a texture is kept.
+    cancel_texture_upload(identifier);
+    const Dimensions & dimensions = texture.dimensions;
+    const GLsizeiptr data_size = dimensions.width * dimensions.height * BYTES_PER_PIXEL.at(texture.format);
+    const GLuint texture_object = create_texture_object(texture, nullptr);
+    GLuint pixel_buffer;
+
+    if (pixel_buffers.size() > 0)
+    {
+        pixel_buffer = pixel_buffers.back();
+        pixel_buffers.pop_back();
+    }
+    else
+    {
+        glGenBuffers(1, &pixel_buffer);
+    }
+
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, data_size, nullptr, GL_STREAM_DRAW);
+    void * pixel_buffer_data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, data_size, GL_MAP_WRITE_BIT);
+
+
+    // Upload directly from client memory if the pixel buffer couldn't be mapped.
+    if (pixel_buffer_data == nullptr)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        pixel_buffers.push_back(pixel_buffer);
+        glDeleteTextures(1, &texture_object);
+        load_texture_data(texture, data, identifier, evictable);
+        return;
+    }
+
+    memcpy(pixel_buffer_data, data, data_size);
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    glBindTexture(GL_TEXTURE_2D, texture_object);
+
+    glTexSubImage2D(
+        GL_TEXTURE_2D,                               // Target
+        0,                                           // Level of detail (0 is base image LOD)
+        0,                                           // X offset
+        0,                                           // Y offset
+        dimensions.width,                            // Image width
+        dimensions.height,                           // Image height
+        INTERNAL_TEXTURE_FORMATS.at(texture.format), // Texel data format (must match internal format)
+        GL_UNSIGNED_BYTE,                            // Texel data type
+        nullptr);                                    // Offset into bound pixel buffer
+
+    if (texture.mipmaps)
+    {
+        glGenerateMipmap(GL_TEXTURE_2D);
+    }
+
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+
+    // Bind the placeholder for the texture until the upload's fence is signaled.
+    set_texture_object(identifier, get_placeholder_texture_object());
+
+    if (evictable)
+    {
+        track_texture_residency(identifier, get_texture_size(texture));
+    }
+
+    texture_uploads.push_back(
+        {
+            identifier,
+            texture_object,
+            pixel_buffer,
+            glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0),
+        });
+
+
+    // Validate no OpenGL errors occurred.
+    validate_no_opengl_error("load_texture_data_async()");
+}
 
 
+void load_vertex_data(const string & id, const vector<GLfloat> & vertex_data, const vector<GLuint> & index_data)
+{
     Vertex_Container & vertex_container = vertex_containers[id];
     GLuint & vertex_array = vertex_container.vertex_array;
     GLuint & vertex_buffer = vertex_container.vertex_buffer;
@@ -692,23 +1642,7 @@ void load_vertex_data(const string & id, const vector<GLfloat> & vertex_data, co
 
 
     // Define pointers to vertex attributes.
-    size_t current_attribute_offset = 0;
-
-    for (GLuint attribute_index = 0u; attribute_index < VERTEX_ATTRIBUTES.size(); attribute_index++)
-    {
-        const Vertex_Attribute & vertex_attribute = VERTEX_ATTRIBUTES[attribute_index];
-        glEnableVertexAttribArray(attribute_index);
-
-        glVertexAttribPointer(
-            attribute_index,                     // Index of attribute
-            vertex_attribute.element_count,      // Number of attribute elements
-            vertex_attribute.type.gl_type,       // Type of attribute elements
-            vertex_attribute.is_normalized,      // Should attribute elements be normalized?
-            VERTEX_STRIDE,                       // Stride between attributes
-            (GLvoid *)current_attribute_offset); // Pointer offset to first element of attribute
-
-        current_attribute_offset += vertex_attribute.size;
-    }
+    define_vertex_attribute_pointers();
 
 
     // Unbind vertex array first, that way unbinding GL_ELEMENT_ARRAY_BUFFER doesn't remove the index data from the
@@ -724,6 +1658,63 @@ void load_vertex_data(const string & id, const vector<GLfloat> & vertex_data, co
 }
 
 
+void unload_vertex_data(const string & id)
+{
+    if (!contains_key(vertex_containers, id))
+    {
+        throw runtime_error("ERROR: no vertex data with id \"" + id + "\" was loaded by Graphics API!");
+    }
+
+    const Vertex_Container & vertex_container = vertex_containers.at(id);
+
+    if (vertex_container.streamed)
+    {
+        remove(stream_vertex_container_ids, id);
+    }
+    else
+    {
+        glDeleteVertexArrays(1, &vertex_container.vertex_array);
+        glDeleteBuffers(1, &vertex_container.vertex_buffer);
+        glDeleteBuffers(1, &vertex_container.index_buffer);
+    }
+
+    remove(vertex_containers, id);
+
+
+    // Validate no OpenGL errors occurred.
+    validate_no_opengl_error("unload_vertex_data()");
+}
+
+
+void load_stream_vertex_data(const string & id, const vector<GLfloat> & vertex_data, const vector<GLuint> & index_data)
+{
+    // Streamed vertex data only lasts for the current frame, so it is staged and uploaded to the stream buffer in one
+    // write when rendering begins.
+    const bool new_vertex_container = !contains_key(vertex_containers, id);
+    Vertex_Container & vertex_container = vertex_containers[id];
+
+    if (new_vertex_container)
+    {
+        vertex_container.streamed = true;
+    }
+    else if (!vertex_container.streamed)
+    {
+        throw runtime_error("ERROR: vertex data with id \"" + id + "\" was not loaded as stream vertex data!");
+    }
+
+    if (!contains(stream_vertex_container_ids, id))
+    {
+        stream_vertex_container_ids.push_back(id);
+    }
+
+    vertex_container.index_count = index_data.size();
+    vertex_container.stream_index_offset = stream_index_data.size();
+    vertex_container.stream_base_vertex = (stream_vertex_data.size() * sizeof(GLfloat)) / get_vertex_stride();
+    stream_vertex_data.insert(stream_vertex_data.end(), vertex_data.begin(), vertex_data.end());
+    stream_index_data.insert(stream_index_data.end(), index_data.begin(), index_data.end());
+}
+
+
 void load_render_layer(const string & name, const string & render_space)
 {
     static const map<string, const Render_Layer::Space> RENDER_SPACES
@@ -739,12 +1730,59 @@ void load_render_layer(const string & name, const string & render_space)
 
 void load_render_data(const Render_Data & render_data)
 {
+    // Mark the data's texture as used this frame, loading it if it isn't resident.
+    if (render_data.texture_path != nullptr)
+    {
+        use_texture(*render_data.texture_path);
+    }
+
     Render_Layer & render_layer = render_layers[*render_data.layer_name];
     render_layer.render_datas.push_back(render_data);
     render_layer.order.push_back(render_layer.order.size());
 }
 
 
+void set_render_view_bounds(const Render_Bounds & bounds)
+{
+    render_view_bounds = bounds;
+    render_view_bounds_set = true;
+}
+
+
+const Render_Bounds * get_render_view_bounds()
+{
+    return render_view_bounds_set ? &render_view_bounds : nullptr;
+}
+
+
+bool is_world_render_layer(const string & name)
+{
+    const auto render_layer = render_layers.find(name);
+
+    if (render_layer == render_layers.end())
+    {
+        throw runtime_error("ERROR: no render layer named \"" + name + "\" has been loaded!");
+    }
+
+    return render_layer->second.space == Render_Layer::Space::WORLD;
+}
+
+
+bool in_render_view(const string & layer_name, const Render_Bounds & render_bounds)
+{
+    // Only world-space layers move with the camera, so viewport-space layers are never culled.
+    if (!render_view_bounds_set || !is_world_render_layer(layer_name))
+    {
+        return true;
+    }
+
+    return render_bounds.min.x <= render_view_bounds.max.x &&
+           render_bounds.max.x >= render_view_bounds.min.x &&
+           render_bounds.min.y <= render_view_bounds.max.y &&
+           render_bounds.max.y >= render_view_bounds.min.y;
+}
+
+
 int create_light_source(float intensity, float range, const vec3 & color, const vec3 * position, bool * enabled)
 {
     if (light_sources.size() >= 128)
@@ -835,6 +1873,11 @@ void render(const Render_Canvas & render_canvas)
     glClear(clear_flags);
 
 
+    // Upload vertex data streamed this frame, and swap in any textures that finished uploading.
+    upload_stream_data();
+    complete_texture_uploads();
+
+
     // Set uniforms for all shader programs.
     vector<GLfloat> light_source_intensities;
     vector<GLfloat> light_source_ranges;
@@ -868,9 +1911,18 @@ void render(const Render_Canvas & render_canvas)
 
 
     // Render all layers.
-    for_each(render_layers, [&](const string & /*layer_name*/, Render_Layer & render_layer) -> void
+    for_each(render_layers, [&](const string & layer_name, Render_Layer & render_layer) -> void
     {
         const vector<Render_Data> & render_datas = render_layer.render_datas;
+        const steady_clock::time_point layer_start_time = steady_clock::now();
+
+
+        // Reset layer stats, keeping the last GPU time read back until a newer one is available.
+        Render_Layer_Stats & layer_stats = render_layer_stats[layer_name];
+        const float previous_gpu_time = contains_key(render_layer_timers, layer_name) ? layer_stats.gpu_time : -1.0f;
+        layer_stats = {};
+        layer_stats.gpu_time = previous_gpu_time;
+        const bool timing_layer = begin_render_layer_timer(layer_name, layer_stats);
 
 
         // Sort render layer order.
@@ -893,6 +1945,9 @@ void render(const Render_Canvas & render_canvas)
             set_uniform(shader_program, "view", layer_view_matrix);
         });
 
+        layer_stats.state_changes += shader_programs.size();
+        layer_stats.uniform_uploads += shader_programs.size();
+
 
         // Render all data in layer.
         for (int index : render_layer.order)
@@ -908,14 +1963,23 @@ void render(const Render_Canvas & render_canvas)
                 : *vertex_container_id);
 
 
+            // Streamed vertex containers that weren't loaded this frame have nothing to draw.
+            if (vertex_container.index_count == 0)
+            {
+                continue;
+            }
+
+
             // Bind vertex array containing vertex data to be rendered.
             glBindVertexArray(vertex_container.vertex_array);
+            layer_stats.state_changes++;
 
 
             // Bind texture to texture unit 0.
             if (texture_path != nullptr)
             {
                 bind_texture(texture_objects.at(*texture_path), 0u);
+                layer_stats.texture_binds++;
             }
 
 
@@ -923,10 +1987,13 @@ void render(const Render_Canvas & render_canvas)
             const GLuint shader_program = shader_programs.at(*render_data.shader_pipeline_name);
             glUseProgram(shader_program);
             set_uniform(shader_program, "model", render_data.model_matrix);
+            layer_stats.state_changes++;
+            layer_stats.uniform_uploads++;
 
             if (texture_path != nullptr)
             {
                 set_uniform(shader_program, "texture_0", 0);
+                layer_stats.uniform_uploads++;
             }
 
 
@@ -934,16 +2001,30 @@ void render(const Render_Canvas & render_canvas)
             if (uniforms != nullptr)
             {
                 set_shader_pipeline_uniforms(shader_program, uniforms);
+                layer_stats.uniform_uploads += uniforms->size();
             }
 
 
-            // Draw data.
-            glDrawElements(
-                GL_RENDER_MODES.at(render_data.render_mode), // Render mode
-                vertex_container.index_count,                // Index count
-                GL_UNSIGNED_INT,                             // Index type
-                (GLvoid *)0);                                // Pointer to start of index array
+            // Draw data (streamed vertex containers draw from their range of the stream buffer).
+            glDrawElementsBaseVertex(
+                GL_RENDER_MODES.at(render_data.render_mode),                       // Render mode
+                vertex_container.index_count,                                      // Index count
+                GL_UNSIGNED_INT,                                                   // Index type
+                (GLvoid *)(vertex_container.stream_index_offset * sizeof(GLuint)), // Offset into index array
+                vertex_container.stream_base_vertex);                              // Value added to each index
+
+            layer_stats.draw_calls++;
+            layer_stats.indices += vertex_container.index_count;
         }
+
+
+        // Finish layer timings.
+        if (timing_layer)
+        {
+            glEndQuery(GL_TIME_ELAPSED);
+        }
+
+        layer_stats.cpu_time = duration<float, milli>(steady_clock::now() - layer_start_time).count();
     });
 
 
@@ -969,6 +2050,32 @@ void cleanup_rendering()
     });
 
 
+    // Fence the stream buffer segment used this frame so it isn't overwritten until the GPU is done with it, then move
+    // on to the next segment and clear this frame's streamed vertex data.
+    if (stream_index_data.size() > 0)
+    {
+        stream_buffer.segment_fences[stream_buffer.segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        stream_buffer.segment = (stream_buffer.segment + 1) % Stream_Buffer::SEGMENT_COUNT;
+    }
+
+    for (const string & id : stream_vertex_container_ids)
+    {
+        Vertex_Container & vertex_container = vertex_containers.at(id);
+        vertex_container.index_count = 0;
+        vertex_container.stream_index_offset = 0;
+        vertex_container.stream_base_vertex = 0;
+    }
+
+    stream_vertex_container_ids.clear();
+    stream_vertex_data.clear();
+    stream_index_data.clear();
+
+
+    // Evict textures over the memory budget now that this frame's textures have been used, then start the next frame.
+    evict_textures();
+    frame++;
+
+
 #ifdef DEBUG
     validate_no_opengl_error("cleanup_rendering()");
 #endif
@@ -980,6 +2087,11 @@ void destroy_graphics()
     // Delete vertex data.
     for_each(vertex_containers, [](const string & /*id*/, const Vertex_Container & vertex_container) -> void
     {
+        if (vertex_container.streamed)
+        {
+            return;
+        }
+
         glDeleteVertexArrays(1, &vertex_container.vertex_array);
         glDeleteBuffers(1, &vertex_container.vertex_buffer);
         glDeleteBuffers(1, &vertex_container.index_buffer);
@@ -988,11 +2100,83 @@ void destroy_graphics()
     vertex_containers.clear();
 
 
+    // Delete stream buffer.
+    for (const GLsync segment_fence : stream_buffer.segment_fences)
+    {
+        if (segment_fence != nullptr)
+        {
+            glDeleteSync(segment_fence);
+        }
+    }
+
+    glDeleteVertexArrays(1, &stream_buffer.vertex_array);
+    glDeleteBuffers(1, &stream_buffer.vertex_buffer);
+    glDeleteBuffers(1, &stream_buffer.index_buffer);
+    stream_buffer = {};
+
+
     // Delete shader pipelines.
     for_each(get_values(shader_programs), glDeleteProgram);
     shader_programs.clear();
 
 
+    // Delete textures (the placeholder is shared by pending uploads, so it's deleted separately).
+    for_each(texture_objects, [](const string & /*identifier*/, GLuint texture_object) -> void
+    {
+        if (texture_object != placeholder_texture_object)
+        {
+            glDeleteTextures(1, &texture_object);
+        }
+    });
+
+    texture_objects.clear();
+    texture_residencies.clear();
+    texture_usage_order.clear();
+    resident_texture_size = 0;
+
+
+    // Delete pending texture uploads and pixel buffers.
+    for (const Texture_Upload & texture_upload : texture_uploads)
+    {
+        glDeleteTextures(1, &texture_upload.texture_object);
+        glDeleteBuffers(1, &texture_upload.pixel_buffer);
+        glDeleteSync(texture_upload.fence);
+    }
+
+    texture_uploads.clear();
+
+    if (pixel_buffers.size() > 0)
+    {
+        glDeleteBuffers(pixel_buffers.size(), &pixel_buffers[0]);
+        pixel_buffers.clear();
+    }
+
+    if (placeholder_texture_object != 0)
+    {
+        glDeleteTextures(1, &placeholder_texture_object);
+        placeholder_texture_object = 0;
+    }
+
+
+    // Delete render layer timer queries.
+    for_each(render_layer_timers, [](const string & /*layer_name*/, Render_Layer_Timer & timer) -> void
+    {
+        glDeleteQueries(Render_Layer_Timer::QUERY_COUNT, timer.queries);
+    });
+
+    render_layer_timers.clear();
+
+
+    // Delete offscreen framebuffer.
+    if (offscreen_framebuffer != 0)
+    {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glDeleteFramebuffers(1, &offscreen_framebuffer);
+        glDeleteRenderbuffers(2, offscreen_renderbuffers);
+        offscreen_framebuffer = 0;
+    }
+
+
     // Validate no OpenGL errors occurred.
     validate_no_opengl_error("destroy_graphics()");
 }
@@ -1010,4 +2194,22 @@ const string & get_default_vertex_container_id()
 }
 
 
+void set_texture_loader(const Texture_Loader & loader)
+{
+    texture_loader = loader;
+}
+
+
+void set_render_timer_queries_enabled(bool enabled)
+{
+    render_timer_queries_enabled = enabled;
+}
+
+
+const map<string, Render_Layer_Stats> & get_render_layer_stats()
+{
+    return render_layer_stats;
+}
+
+
 } // namespace Nito
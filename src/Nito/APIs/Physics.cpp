@@ -1,19 +1,48 @@
 #include "Nito/APIs/Physics.hpp"
 
 #include <map>
+#include <unordered_map>
 #include <vector>
+#include <algorithm>
 #include <functional>
 #include <stdexcept>
 #include <cmath>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#if __SSE2__ || _M_X64
+#include <emmintrin.h>
+#endif
 #include "Cpp_Utils/Map.hpp"
 #include "Cpp_Utils/String.hpp"
 #include "Cpp_Utils/Collection.hpp"
 
 
 using std::map;
+using std::unordered_map;
+using std::string;
 using std::vector;
+using std::sort;
+using std::nth_element;
+using std::fill;
+using std::unique;
+using std::lower_bound;
+using std::upper_bound;
+using std::max;
+using std::min;
 using std::function;
 using std::runtime_error;
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::atomic;
+using std::condition_variable;
+using std::milli;
+using std::chrono::steady_clock;
+using std::chrono::duration;
 
 // glm/glm.hpp
 using glm::distance;
@@ -46,9 +75,27 @@ struct Circle_Collider_Data
     const bool * sends_collision;
     const bool * receives_collision;
     const bool * enabled;
+    const unsigned int * layer;
+    const unsigned int * mask;
+    const bool * continuous;
     const float * radius;
     const vec3 * scale;
     vec3 * position;
+
+    // State the collider had at the end of the last update, how many updates in a row it has stayed unchanged for, and
+    // the island it belongs to this update.
+    int still_frame_count;
+    bool asleep;
+    Circle_Collider_Data * island;
+    bool island_awake;
+    vec2 last_position;
+    float last_radius;
+    unsigned int last_layer;
+    unsigned int last_mask;
+    unsigned char last_flags;
+
+    // Whether the collider's movement since the last update was reset, so it isn't swept this update.
+    bool motion_reset;
 };
 
 
@@ -58,6 +105,9 @@ struct Line_Collider_Data
     const bool * sends_collision;
     const bool * receives_collision;
     const bool * enabled;
+    const unsigned int * layer;
+    const unsigned int * mask;
+    bool is_static;
     const vec3 * begin;
     const vec3 * end;
 };
@@ -69,22 +119,204 @@ struct Polygon_Collider_Data
     const bool * sends_collision;
     const bool * receives_collision;
     const bool * enabled;
+    const unsigned int * layer;
+    const unsigned int * mask;
+    bool is_static;
     const vector<vec3> * begins;
     const vector<vec3> * ends;
     vec3 * position;
 };
 
 
-struct Collision_Events
+struct Broadphase_Proxy
+{
+    enum class Types
+    {
+        CIRCLE,
+        LINE,
+        POLYGON_LINE,
+    }
+    type;
+
+    int index;
+};
+
+
+// Proxies spanning too many hash cells to insert into each of them, with the AABB queries test them against.
+struct Oversized_Proxy
+{
+    Broadphase_Proxy proxy;
+    vec2 min_point;
+    vec2 max_point;
+};
+
+
+struct Circle_Proxy
+{
+    Entity entity;
+    Circle_Collider_Data * data;
+};
+
+
+struct Line_Proxy
+{
+    Entity entity;
+    const Line_Collider_Data * data;
+    unsigned int layer;
+    unsigned int mask;
+};
+
+
+struct Polygon_Proxy
+{
+    Entity entity;
+    const Polygon_Collider_Data * data;
+    unsigned int layer;
+    unsigned int mask;
+};
+
+
+struct Polygon_Line_Proxy
+{
+    int polygon;
+    int line;
+};
+
+
+// Sweep-and-prune boxes persist between passes, keyed by their collider (and line, for polygons), so their endpoints
+// stay nearly sorted from frame to frame.
+struct Sweep_Box
+{
+    unsigned long long key;
+    Broadphase_Proxy proxy;
+    vec2 min_point;
+    vec2 max_point;
+    unsigned int layer;
+    unsigned int mask;
+    unsigned int pass;
+};
+
+
+struct Sweep_Endpoint
+{
+    float value;
+    int box;
+    bool is_min;
+};
+
+
+// A line from a static line or polygon collider, baked into the static line BVH.
+struct Static_Line
+{
+    Entity entity;
+    bool is_polygon_line;
+    const Collision_Handler * collision_handler;
+    const bool * sends_collision;
+    const bool * enabled;
+    const unsigned int * layer;
+    const unsigned int * mask;
+    const vec3 * begin;
+    const vec3 * end;
+    vec2 min_point;
+    vec2 max_point;
+
+    // Later static line colliders (not polygon lines) this line intersects, found when baked.
+    vector<int> intersecting_lines;
+};
+
+
+// Records found by circles keep their circles' data, and the static line they collided with (if any), so sleeping
+// islands can be found from them without looking colliders up. Static lines are only valid until the static geometry is
+// re-baked, which wakes every circle, so they are only used while their circle is asleep.
+struct Collision_Record
 {
+    Entity entity;
     const Collision_Handler * source_collision_handler;
-    map<Entity, const Collision_Handler *> collision_handlers;
+    Entity collision_entity;
+    const Collision_Handler * collision_handler;
+    Circle_Collider_Data * circle_data;
+    Circle_Collider_Data * circle_b_data;
+    const Static_Line * static_line;
+};
+
+
+struct Collision_Correction
+{
+    int circle;
+    vec3 correction;
+};
+
+
+// When (as a fraction of its movement since the last update) a continuous circle first touched a collider.
+struct Circle_Time_Of_Impact
+{
+    int circle;
+    float time;
+};
+
+
+// Scratch buffers for one thread's candidate queries. Candidates found in the broadphase are stamped with the current
+// query so each is only collected once per query, even when it shares several cells with the querying collider. Stamps
+// only ever increase, so they are kept between passes rather than cleared.
+struct Narrow_Phase_Context
+{
+    unsigned int query_layer;
+    unsigned int query_mask;
+    unsigned int query_stamp;
+    vector<unsigned int> circle_stamps;
+    vector<unsigned int> line_stamps;
+    vector<unsigned int> polygon_line_stamps;
+    vector<int> circle_candidates;
+    vector<int> line_candidates;
+    vector<int> polygon_line_candidates;
+    vector<int> circle_hits;
+    vector<int> static_line_candidates;
+    vector<int> bvh_query_stack;
+};
+
+
+// Collisions and corrections found by one chunk of narrow phase tests, in the order they were found.
+struct Narrow_Phase_Chunk
+{
+    vector<Collision_Record> collision_records;
+    vector<Collision_Correction> collision_corrections;
+    vector<Circle_Time_Of_Impact> circle_times_of_impact;
+    vector<int> woken_circles;
+    int narrow_phase_tests;
 };
 
 
-using Circle_Collider_Data_Iterator = map<Entity, Circle_Collider_Data>::const_iterator;
-using Line_Collider_Data_Iterator = map<Entity, Line_Collider_Data>::const_iterator;
-using Polygon_Collider_Data_Iterator = map<Entity, Polygon_Collider_Data>::const_iterator;
+using Narrow_Phase_Chunk_Checker = function<void(Narrow_Phase_Context &, int)>;
+
+
+// A sleeping circle (indexed like circle_proxies for the current pass), baked into the sleeping circle BVH.
+struct Sleeping_Circle
+{
+    int circle;
+    const Circle_Collider_Data * data;
+    vec2 min_point;
+    vec2 max_point;
+};
+
+
+// A pair of a sleeping circle and an awake collider whose AABBs overlap, found from the awake collider.
+struct Sleeping_Contact
+{
+    int circle;
+    Broadphase_Proxy proxy;
+};
+
+
+// Leaf nodes reference a range of their BVH's item indexes, while branch nodes reference their two children.
+struct BVH_Node
+{
+    vec2 min_point;
+    vec2 max_point;
+    int left;
+    int right;
+    int begin;
+    int end;
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -93,16 +325,202 @@ using Polygon_Collider_Data_Iterator = map<Entity, Polygon_Collider_Data>::const
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 static const int PASS_COUNT = 2;
+static Broadphase_Modes broadphase_mode = Broadphase_Modes::SPATIAL_HASH;
+static Physics_Stats physics_stats;
 static map<Entity, Circle_Collider_Data> circle_collider_datas;
 static map<Entity, Line_Collider_Data> line_collider_datas;
 static map<Entity, Polygon_Collider_Data> polygon_collider_datas;
 
 
+// Collision layers are bits in the order they were loaded (the default layer is always the first), each with the mask
+// of layers its colliders collide with by default.
+static const int MAX_COLLISION_LAYER_COUNT = 32;
+static vector<string> collision_layer_names { "default" };
+static vector<unsigned int> collision_layer_masks { ~0u };
+
+
+// Broadphase spatial hash, rebuilt every pass. Cells are only cleared (not erased) between passes so their storage is
+// reused, and the whole hash is dropped when it fills up with cells colliders have since moved out of. Proxies spanning
+// more than MAX_PROXY_CELL_COUNT cells (huge colliders, or continuous circles that moved far) are kept out of the cells
+// and tested directly by every query, and queries spanning more cells than are occupied only visit the occupied ones.
+static const float DEFAULT_CELL_SIZE = 1.0f;
+static const float MIN_CELL_SIZE = 0.01f;
+static const int MAX_PROXY_CELL_COUNT = 64;
+static float cell_size = DEFAULT_CELL_SIZE;
+static unordered_map<long long, vector<Broadphase_Proxy>> broadphase_cells;
+static vector<long long> occupied_cell_keys;
+static vector<Oversized_Proxy> oversized_proxies;
+static vector<Circle_Proxy> circle_proxies;
+static vector<Line_Proxy> line_proxies;
+static vector<Polygon_Proxy> polygon_proxies;
+static vector<Polygon_Line_Proxy> polygon_line_proxies;
+
+
+// Circle collider state gathered into arrays (indexed like circle_proxies) at the start of each pass, so narrow phase
+// tests read contiguous memory instead of following pointers back into component data.
+static const unsigned char CIRCLE_SENDS_COLLISION = 1;
+static const unsigned char CIRCLE_RECEIVES_COLLISION = 2;
+static const unsigned char CIRCLE_ASLEEP = 4;
+static const unsigned char CIRCLE_MOVED = 8;
+static const unsigned char CIRCLE_CONTINUOUS = 16;
+static vector<float> circle_position_xs;
+static vector<float> circle_position_ys;
+static vector<float> circle_previous_position_xs;
+static vector<float> circle_previous_position_ys;
+static vector<float> circle_radii;
+static vector<unsigned char> circle_flags;
+static vector<unsigned int> circle_layers;
+static vector<unsigned int> circle_masks;
+
+
+// Corrections are summed per circle (indexed like circle_proxies) and averaged when resolved, and collisions from every
+// pass are collected into one buffer for the frame. These (like all other per-pass buffers) are cleared rather than
+// reallocated, so once they have grown to fit a scene, physics updates don't allocate.
+static vector<vec3> circle_correction_sums;
+static vector<int> circle_correction_counts;
+static vector<Collision_Record> collision_records;
+
+
+// Continuous circles that have moved since the last update are swept from their previous position (their position at
+// the end of the last update) to their current one. A continuous circle that collides partway through its movement is
+// moved back to where it first touched the collider instead of being corrected, so it can't pass through colliders by
+// moving further than their size in one update. Only its earliest time of impact (across all passes' chunks) is used.
+static int continuous_circle_count = 0;
+static vector<float> circle_times_of_impact;
+
+
+// Continuous circles that moved further than this since the last update (or had their motion reset) are treated as
+// teleported, and collide at their current position without being swept. 0 means there is no limit.
+static float max_continuous_displacement = 0.0f;
+
+
+// Circles that collided in the last update are grouped into islands, which fall asleep once every circle in them has
+// stayed unchanged (not moved, resized or re-layered) for SLEEP_FRAME_COUNT updates in a row, as long as none of them
+// touches a dynamic line or polygon collider. Pairs of sleeping circles, and sleeping circles and static colliders,
+// aren't checked; their collisions from the last update are kept instead, since nothing in those pairs has moved since.
+// Circles are woken (along with their island in the next update) by changing, including by writes to their transform,
+// or by colliding with a circle that has moved this update.
+static const int SLEEP_FRAME_COUNT = 30;
+static bool sleeping_enabled = true;
+
+
+// Every circle, gathered once per update when islands are found so the rest of the update doesn't walk the map again,
+// and whether any circle has been removed since the last update (so records referencing it must be refreshed).
+static vector<Circle_Collider_Data *> island_circle_datas;
+static bool circle_collider_data_removed = false;
+
+
+// Sweep-and-prune state. Endpoints are kept sorted along both axes, and each pass sweeps whichever axis colliders are
+// most spread out along. Overlapping boxes are stored as an adjacency list (overlaps of box i are
+// sweep_overlaps[sweep_overlap_offsets[i]] up to sweep_overlaps[sweep_overlap_offsets[i + 1]]).
+static unsigned int sweep_pass = 0;
+static vector<Sweep_Box> sweep_boxes;
+static unordered_map<unsigned long long, int> sweep_box_indexes;
+static vector<Sweep_Endpoint> sweep_endpoints_x;
+static vector<Sweep_Endpoint> sweep_endpoints_y;
+static vector<int> sweep_active_boxes;
+static vector<int> sweep_box_remaps;
+static vector<int> sweep_pairs;
+static vector<int> sweep_overlap_offsets;
+static vector<int> sweep_overlaps;
+static vector<int> sweep_overlap_cursors;
+static vector<int> circle_sweep_boxes;
+static vector<int> line_sweep_boxes;
+static vector<int> polygon_line_sweep_boxes;
+
+
+// The largest box size along each axis, used to limit which endpoints spatial queries scan. These are kept in double
+// precision so subtracting them from a query's bounds can't round past the min endpoint of a box the query overlaps.
+static double sweep_max_box_width = 0.0;
+static double sweep_max_box_height = 0.0;
+
+
+// Static line and polygon colliders are baked into a BVH instead of the spatial hash, and are only re-baked when one of
+// them changes. Static lines are stored in entity order so candidates can be sorted back into that order.
+static const int BVH_NODE_SIZE = 4;
+static bool static_collider_data_dirty = true;
+static vector<Static_Line> static_lines;
+static vector<int> static_line_indexes;
+static vector<BVH_Node> static_line_nodes;
+static map<Entity, int> static_line_collider_indexes;
+
+
+// Sleeping circles don't move, so they are kept out of the broadphase in a BVH of their own, which is only re-baked
+// when which circles are asleep changes. They don't query the broadphase either; instead, awake circles and dynamic
+// lines find the sleeping circles they overlap once per pass, and the pairs are stored per circle as an adjacency list
+// (contacts of circle i are sleeping_contacts[sleeping_contact_offsets[i]] up to
+// sleeping_contacts[sleeping_contact_offsets[i + 1]]).
+static vector<Sleeping_Circle> sleeping_circles;
+static vector<Sleeping_Circle> pass_sleeping_circles;
+static vector<int> sleeping_circle_indexes;
+static vector<BVH_Node> sleeping_circle_nodes;
+static vector<Sleeping_Contact> sleeping_contact_pairs;
+static vector<int> sleeping_contact_offsets;
+static vector<int> sleeping_contact_cursors;
+static vector<Broadphase_Proxy> sleeping_contacts;
+static vector<int> sleeping_contact_query_stack;
+
+
+// The narrow phase is split into fixed-size chunks of colliders (circles, then lines) that worker threads take in turn.
+// Chunks don't depend on how many workers there are and are merged in order, so results are identical to checking every
+// chunk on one thread. Passes with only a few chunks aren't worth waking workers for.
+static const int NARROW_PHASE_CHUNK_SIZE = 64;
+static const int MIN_PARALLEL_NARROW_PHASE_CHUNKS = 4;
+static int physics_worker_count = 0;
+static vector<Narrow_Phase_Context> narrow_phase_contexts;
+static vector<Narrow_Phase_Chunk> narrow_phase_chunks;
+static int narrow_phase_chunk_count = 0;
+static atomic<int> next_narrow_phase_chunk(0);
+static const Narrow_Phase_Chunk_Checker * narrow_phase_chunk_checker = nullptr;
+
+
+// Workers persist between passes, waiting for the generation to change to start checking chunks. The calling thread
+// checks chunks too, using the first context (worker i uses context i).
+static vector<thread> narrow_phase_workers;
+static mutex narrow_phase_mutex;
+static condition_variable narrow_phase_start_condition;
+static condition_variable narrow_phase_finish_condition;
+static unsigned int narrow_phase_generation = 0;
+static int finished_worker_count = 0;
+static bool stopping_narrow_phase_workers = false;
+
+
+// Spatial queries rebuild the broadphase the first time they are made after it has been used for collision checks or
+// colliders have been loaded or removed, along with the bounds of every collider in it, which queries are clipped to so
+// they don't search empty space. Batched queries are split into chunks for the narrow phase workers.
+static const int SPATIAL_QUERY_CHUNK_SIZE = 16;
+static bool spatial_query_broadphase_dirty = true;
+static bool spatial_query_bounds_empty = true;
+static vec2 spatial_query_min_point;
+static vec2 spatial_query_max_point;
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Utilities
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int get_collision_layer_index(const string & name)
+{
+    for (int i = 0; i < (int)collision_layer_names.size(); i++)
+    {
+        if (collision_layer_names[i] == name)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+
+// Pairs are rejected with this before any geometry is checked, in both the broadphase and narrow phase.
+static bool layers_collide(unsigned int layer_a, unsigned int mask_a, unsigned int layer_b, unsigned int mask_b)
+{
+    return (layer_a & mask_b) && (layer_b & mask_a);
+}
+
+
 static vec3 get_intersection(
     const vec3 & line_a_begin,
     const vec3 & line_a_end,
@@ -131,18 +549,174 @@ static vec3 get_intersection(
 }
 
 
+// Finds when a point moving from start (by movement) first comes within radius of center, as a fraction of its
+// movement. Points that start within radius of center only collide (at the start of their movement) if moving toward
+// it.
+static bool get_point_circle_time_of_impact(
+    const vec2 & start,
+    const vec2 & movement,
+    const vec2 & center,
+    float radius,
+    float & time_of_impact)
+{
+    const vec2 center_offset = start - center;
+    const float A = dot(movement, movement);
+    const float B = 2 * dot(movement, center_offset);
+    const float C = dot(center_offset, center_offset) - (radius * radius);
+    const float discriminant = (B * B) - (4 * A * C);
+
+    if (A == 0.0f)
+    {
+        return false;
+    }
+
+    if (C <= 0.0f)
+    {
+        time_of_impact = 0.0f;
+        return B < 0.0f;
+    }
+
+    if (discriminant < 0.0f)
+    {
+        return false;
+    }
+
+    time_of_impact = (-B - sqrtf(discriminant)) / (2 * A);
+
+    return time_of_impact >= 0.0f && time_of_impact <= 1.0f;
+}
+
+
+// Continuous circles that already touch a line where their movement starts are left to discrete collision checks (so
+// they can still slide along it), unless their center passes through the line.
+static bool get_line_circle_time_of_impact(
+    const vec3 * line_begin,
+    const vec3 * line_end,
+    int circle_index,
+    float & time_of_impact)
+{
+    const vec2 begin(line_begin->x, line_begin->y);
+    const vec2 end(line_end->x, line_end->y);
+    const vec2 start(circle_previous_position_xs[circle_index], circle_previous_position_ys[circle_index]);
+    const vec2 movement = vec2(circle_position_xs[circle_index], circle_position_ys[circle_index]) - start;
+    const float radius = fabsf(circle_radii[circle_index]);
+    const vec2 line_direction = end - begin;
+    const float line_length_squared = dot(line_direction, line_direction);
+
+    if (line_length_squared == 0.0f)
+    {
+        return get_point_circle_time_of_impact(start, movement, begin, radius, time_of_impact);
+    }
+
+
+    const vec2 line_normal = vec2(-line_direction.y, line_direction.x) / sqrtf(line_length_squared);
+    const float start_side = dot(start - begin, line_normal);
+    const float side_sign = start_side < 0.0f ? -1.0f : 1.0f;
+    const float start_distance = start_side * side_sign;
+    const float approach_speed = -dot(movement, line_normal) * side_sign;
+    const float start_projection = min(max(dot(start - begin, line_direction) / line_length_squared, 0.0f), 1.0f);
+    const vec2 start_offset = start - (begin + (line_direction * start_projection));
+
+
+    // Check if the circle starts touching the line.
+    if (dot(start_offset, start_offset) <= radius * radius)
+    {
+        if (approach_speed <= 0.0f || start_distance > approach_speed)
+        {
+            return false;
+        }
+
+        const vec2 crossing_position = start + (movement * (start_distance / approach_speed));
+        const float crossing_projection = dot(crossing_position - begin, line_direction) / line_length_squared;
+        time_of_impact = 0.0f;
+
+        return crossing_projection >= 0.0f && crossing_projection <= 1.0f;
+    }
+
+
+    // Otherwise the circle first touches the line either on its side facing the circle's start, or at one of its ends.
+    float earliest_time = 2.0f;
+    float point_time;
+
+    if (start_distance > radius && approach_speed > 0.0f)
+    {
+        const float side_time = (start_distance - radius) / approach_speed;
+        const vec2 side_position = start + (movement * side_time);
+        const float side_projection = dot(side_position - begin, line_direction) / line_length_squared;
+
+        if (side_time <= 1.0f && side_projection >= 0.0f && side_projection <= 1.0f)
+        {
+            earliest_time = side_time;
+        }
+    }
+
+    if (get_point_circle_time_of_impact(start, movement, begin, radius, point_time))
+    {
+        earliest_time = min(earliest_time, point_time);
+    }
+
+    if (get_point_circle_time_of_impact(start, movement, end, radius, point_time))
+    {
+        earliest_time = min(earliest_time, point_time);
+    }
+
+    time_of_impact = earliest_time;
+
+    return earliest_time <= 1.0f;
+}
+
+
+// Circles are swept relative to each other, so this works whether one or both of them moved.
+static bool get_circle_time_of_impact(int circle_a_index, int circle_b_index, float & time_of_impact)
+{
+    const vec2 circle_a_start(
+        circle_previous_position_xs[circle_a_index],
+        circle_previous_position_ys[circle_a_index]);
+
+    const vec2 circle_b_start(
+        circle_previous_position_xs[circle_b_index],
+        circle_previous_position_ys[circle_b_index]);
+
+    const vec2 circle_a_end(circle_position_xs[circle_a_index], circle_position_ys[circle_a_index]);
+    const vec2 circle_b_end(circle_position_xs[circle_b_index], circle_position_ys[circle_b_index]);
+
+    return get_point_circle_time_of_impact(
+        circle_a_start - circle_b_start,
+        (circle_a_end - circle_a_start) - (circle_b_end - circle_b_start),
+        vec2(),
+        fabsf(circle_radii[circle_a_index]) + fabsf(circle_radii[circle_b_index]),
+        time_of_impact);
+}
+
+
 static bool check_line_circle_collision(
     const vec3 * line_begin,
     const vec3 * line_end,
-    vec3 * circle_data_position,
+    int circle_index,
     const vec3 & circle_position_2d,
     float circle_position_x,
     float circle_position_y,
     float circle_radius,
     bool line_sends_collision,
     bool circle_receives_collision,
-    map<vec3 *, vector<vec3>> & collision_corrections)
+    vector<Collision_Correction> & collision_corrections,
+    vector<Circle_Time_Of_Impact> & circle_times_of_impact)
 {
+    // Continuous circles that touch the line partway through their movement are moved back to where they first touched
+    // it, rather than corrected.
+    float time_of_impact;
+
+    if ((circle_flags[circle_index] & CIRCLE_CONTINUOUS) &&
+        get_line_circle_time_of_impact(line_begin, line_end, circle_index, time_of_impact))
+    {
+        if (line_sends_collision && circle_receives_collision)
+        {
+            circle_times_of_impact.push_back({ circle_index, time_of_impact });
+        }
+
+        return true;
+    }
+
     const float line_begin_x = line_begin->x;
     const float line_begin_y = line_begin->y;
     const vec3 line_begin_2d(line_begin_x, line_begin_y, 0.0f);
@@ -218,17 +792,23 @@ static bool check_line_circle_collision(
                 if (line_begin_circle_distance < circle_radius &&
                     distance(line_end_2d, circle_line_normal_intersection) > line_length)
                 {
-                    collision_corrections[circle_data_position].push_back(
-                        normalize(circle_position_2d - line_begin_2d) *
-                        (circle_radius - line_begin_circle_distance));
+                    collision_corrections.push_back(
+                        {
+                            circle_index,
+                            normalize(circle_position_2d - line_begin_2d) *
+                            (circle_radius - line_begin_circle_distance),
+                        });
                 }
                 // Line end is inside circle and off line.
                 else if (line_end_circle_distance < circle_radius &&
                          distance(line_begin_2d, circle_line_normal_intersection) > line_length)
                 {
-                    collision_corrections[circle_data_position].push_back(
-                        normalize(circle_position_2d - line_end_2d) *
-                        (circle_radius - line_end_circle_distance));
+                    collision_corrections.push_back(
+                        {
+                            circle_index,
+                            normalize(circle_position_2d - line_end_2d) *
+                            (circle_radius - line_end_circle_distance),
+                        });
                 }
                 // Line passes through circle.
                 else
@@ -250,7 +830,7 @@ static bool check_line_circle_collision(
 
 
                     const float correction_distance = circle_radius - circle_line_normal_distance;
-                    collision_corrections[circle_data_position].push_back(correction_distance * line_normal);
+                    collision_corrections.push_back({ circle_index, correction_distance * line_normal });
                 }
             }
 
@@ -262,253 +842,3035 @@ static bool check_line_circle_collision(
 }
 
 
-static void check_collisions(map<Entity, Collision_Events> & collision_events)
+static int get_cell_coordinate(float position)
 {
-    Circle_Collider_Data_Iterator circles_iterator = circle_collider_datas.begin();
-    Line_Collider_Data_Iterator lines_iterator = line_collider_datas.begin();
-    map<vec3 *, vector<vec3>> collision_corrections;
+    return (int)floorf(position / cell_size);
+}
 
 
-    // Check for circle collider collisions.
-    while (circles_iterator != circle_collider_datas.end())
-    {
-        const Entity circle_entity = circles_iterator->first;
-        const Circle_Collider_Data & circle_data = circles_iterator->second;
-        circles_iterator++;
+static long long get_cell_key(int x, int y)
+{
+    return ((long long)x << 32) | (unsigned int)y;
+}
 
-        // Don't check for collision if collider is disabled.
-        if (!*circle_data.enabled)
-        {
-            continue;
-        }
 
-        vec3 * circle_data_position = circle_data.position;
-        const float circle_position_x = circle_data_position->x;
-        const float circle_position_y = circle_data_position->y;
-        const vec3 circle_position_2d(circle_position_x, circle_position_y, 0.0f);
-        const float circle_radius = *circle_data.radius * circle_data.scale->x;
-        const bool circle_sends_collision = *circle_data.sends_collision;
-        const bool circle_receives_collision = *circle_data.receives_collision;
-        Collision_Events & circle_entity_collision_events = collision_events[circle_entity];
-        circle_entity_collision_events.source_collision_handler = circle_data.collision_handler;
-        map<Entity, const Collision_Handler *> & collision_handlers = circle_entity_collision_events.collision_handlers;
+// Cell counts are calculated in floating point, as AABBs spanning too many cells to visit can span more than an int
+// can count.
+static double get_aabb_cell_count(const vec2 & min_point, const vec2 & max_point)
+{
+    return
+        ((double)floorf(max_point.x / cell_size) - floorf(min_point.x / cell_size) + 1.0) *
+        ((double)floorf(max_point.y / cell_size) - floorf(min_point.y / cell_size) + 1.0);
+}
 
 
-        // Check for collisions with other circle colliders.
-        for_each(circle_collider_datas, circles_iterator, [&](
-            Entity circle_b_entity,
-            const Circle_Collider_Data & circle_b_data) -> void
-        {
-            // Don't check for collision if collider is disabled.
-            if (!*circle_b_data.enabled)
-            {
-                return;
-            }
+// Lines visit at most every cell in each column they pass through, plus one more per row they cross.
+static double get_line_cell_count(const vec3 & begin, const vec3 & end)
+{
+    return
+        fabs((double)floorf(end.x / cell_size) - floorf(begin.x / cell_size)) +
+        fabs((double)floorf(end.y / cell_size) - floorf(begin.y / cell_size)) +
+        2.0;
+}
 
-            vec3 * circle_b_data_position = circle_b_data.position;
-            const vec3 circle_b_position_2d(circle_b_data_position->x, circle_b_data_position->y, 0.0f);
-            const float actual_distance = distance(circle_position_2d, circle_b_position_2d);
 
-            const float collision_distance =
-                circle_radius + (*circle_b_data.radius * circle_b_data.scale->x);
+template<typename Cell_Handler>
+static void for_each_aabb_cell(const vec2 & min_point, const vec2 & max_point, const Cell_Handler & cell_handler)
+{
+    const int min_x = get_cell_coordinate(min_point.x);
+    const int min_y = get_cell_coordinate(min_point.y);
+    const int max_x = get_cell_coordinate(max_point.x);
+    const int max_y = get_cell_coordinate(max_point.y);
 
-            if (actual_distance <= collision_distance)
-            {
-                collision_handlers[circle_b_entity] = circle_b_data.collision_handler;
+    for (int x = min_x; x <= max_x; x++)
+    {
+        for (int y = min_y; y <= max_y; y++)
+        {
+            cell_handler(x, y);
+        }
+    }
+}
 
 
-                // Calculate collision corrections if necessary.
-                const bool receiving = circle_sends_collision && *circle_b_data.receives_collision;
-                const bool sending = *circle_b_data.sends_collision && circle_receives_collision;
+// Visits every cell the line passes through (rather than every cell its AABB covers), so long level geometry only
+// occupies cells along its length. Column bounds are inclusive, so lines passing exactly through cell edges are visited
+// in both neighbouring cells.
+template<typename Cell_Handler>
+static void for_each_line_cell(const vec3 & begin, const vec3 & end, const Cell_Handler & cell_handler)
+{
+    const float min_line_x = min(begin.x, end.x);
+    const float max_line_x = max(begin.x, end.x);
+    const float direction_x = end.x - begin.x;
+    const float direction_y = end.y - begin.y;
+    const int min_x = get_cell_coordinate(min_line_x);
+    const int max_x = get_cell_coordinate(max_line_x);
 
-                const vec3 correction =
-                    normalize(circle_b_position_2d - circle_position_2d) *
-                    (collision_distance - actual_distance);
+    for (int x = min_x; x <= max_x; x++)
+    {
+        float column_begin_y = begin.y;
+        float column_end_y = end.y;
 
-                if (receiving && sending)
-                {
-                    const vec3 shared_correction = correction / 2.0f;
-                    collision_corrections[circle_b_data_position].push_back(shared_correction);
-                    collision_corrections[circle_data_position].push_back(-shared_correction);
-                }
-                else if (receiving)
-                {
-                    collision_corrections[circle_b_data_position].push_back(correction);
-                }
-                else if (sending)
-                {
-                    collision_corrections[circle_data_position].push_back(-correction);
-                }
-            }
-        });
+        if (direction_x != 0.0f)
+        {
+            const float column_begin_x = max(min_line_x, x * cell_size);
+            const float column_end_x = min(max_line_x, (x + 1) * cell_size);
+            column_begin_y = begin.y + (direction_y * ((column_begin_x - begin.x) / direction_x));
+            column_end_y = begin.y + (direction_y * ((column_end_x - begin.x) / direction_x));
+        }
 
+        const int min_y = get_cell_coordinate(min(column_begin_y, column_end_y));
+        const int max_y = get_cell_coordinate(max(column_begin_y, column_end_y));
 
-        // Check for collisions with line colliders.
-        for_each(line_collider_datas, [&](Entity line_entity, Line_Collider_Data & line_data) -> void
+        for (int y = min_y; y <= max_y; y++)
         {
-            // Don't check for collision if collider is disabled.
-            if (!*line_data.enabled)
-            {
-                return;
-            }
+            cell_handler(x, y);
+        }
+    }
+}
 
-            if (check_line_circle_collision(
-                    line_data.begin,
-                    line_data.end,
-                    circle_data_position,
-                    circle_position_2d,
-                    circle_position_x,
-                    circle_position_y,
-                    circle_radius,
-                    *line_data.sends_collision,
-                    circle_receives_collision,
-                    collision_corrections))
-            {
-                collision_handlers[line_entity] = line_data.collision_handler;
-            }
-        });
 
+static void insert_proxy(int x, int y, const Broadphase_Proxy & proxy)
+{
+    vector<Broadphase_Proxy> & cell = broadphase_cells[get_cell_key(x, y)];
 
-        // Check for collisions with polygon colliders.
-        for_each(polygon_collider_datas, [&](Entity polygon_entity, Polygon_Collider_Data & polygon_data) -> void
-        {
-            // Don't check for collision if collider is disabled.
-            if (!*polygon_data.enabled)
-            {
-                return;
-            }
+    if (cell.empty())
+    {
+        occupied_cell_keys.push_back(get_cell_key(x, y));
+    }
 
-            const vector<vec3> * begins = polygon_data.begins;
-            const vector<vec3> * ends = polygon_data.ends;
-            const int line_count = begins->size();
-            bool collision_detected = false;
-
-            for (int i = 0; i < line_count; i++)
-            {
-                if (check_line_circle_collision(
-                        &(*begins)[i],
-                        &(*ends)[i],
-                        circle_data_position,
-                        circle_position_2d,
-                        circle_position_x,
-                        circle_position_y,
-                        circle_radius,
-                        *polygon_data.sends_collision,
-                        circle_receives_collision,
-                        collision_corrections))
-                {
-                    collision_detected = true;
-                }
-            }
+    cell.push_back(proxy);
+}
 
-            if (collision_detected)
-            {
-                collision_handlers[polygon_entity] = polygon_data.collision_handler;
-            }
-        });
-    };
 
+static float get_circle_radius(const Circle_Collider_Data & circle_data)
+{
+    return *circle_data.radius * circle_data.scale->x;
+}
 
-    // Check for line collider collisions that have not already been checked.
-    while (lines_iterator != line_collider_datas.end())
-    {
-        const Entity line_entity = lines_iterator->first;
-        const Line_Collider_Data & line_data = lines_iterator->second;
-        lines_iterator++;
 
-        // Don't check for collision if collider is disabled.
-        if (!*line_data.enabled)
-        {
-            continue;
-        }
+static unsigned char get_circle_collision_flags(const Circle_Collider_Data & circle_data)
+{
+    return
+        (*circle_data.sends_collision ? CIRCLE_SENDS_COLLISION : 0) |
+        (*circle_data.receives_collision ? CIRCLE_RECEIVES_COLLISION : 0);
+}
 
-        const vec3 * line_begin = line_data.begin;
-        const vec3 * line_end = line_data.end;
-        const float line_begin_x = line_begin->x;
-        const float line_begin_y = line_begin->y;
-        const float line_end_x = line_end->x;
-        const float line_end_y = line_end->y;
-        const vec3 r(line_end_x - line_begin_x, line_end_y - line_begin_y, 0.0f);
-        Collision_Events & line_entity_collision_events = collision_events[line_entity];
-        line_entity_collision_events.source_collision_handler = line_data.collision_handler;
-        map<Entity, const Collision_Handler *> & collision_handlers = line_entity_collision_events.collision_handlers;
 
+static bool circle_collider_changed(const Circle_Collider_Data & circle_data)
+{
+    return
+        circle_data.position->x != circle_data.last_position.x ||
+        circle_data.position->y != circle_data.last_position.y ||
+        get_circle_radius(circle_data) != circle_data.last_radius ||
+        *circle_data.layer != circle_data.last_layer ||
+        *circle_data.mask != circle_data.last_mask ||
+        get_circle_collision_flags(circle_data) != circle_data.last_flags;
+}
+
+
+static void store_circle_collider_state(Circle_Collider_Data & circle_data)
+{
+    circle_data.last_position = vec2(circle_data.position->x, circle_data.position->y);
+    circle_data.last_radius = get_circle_radius(circle_data);
+    circle_data.last_layer = *circle_data.layer;
+    circle_data.last_mask = *circle_data.mask;
+    circle_data.last_flags = get_circle_collision_flags(circle_data);
+    circle_data.motion_reset = false;
+}
+
+
+static bool is_circle_swept(const Circle_Collider_Data & circle_data)
+{
+    if (!*circle_data.continuous ||
+        circle_data.motion_reset ||
+        (circle_data.position->x == circle_data.last_position.x &&
+         circle_data.position->y == circle_data.last_position.y))
+    {
+        return false;
+    }
+
+    if (max_continuous_displacement == 0.0f)
+    {
+        return true;
+    }
+
+    const vec2 displacement = vec2(circle_data.position->x, circle_data.position->y) - circle_data.last_position;
+    return dot(displacement, displacement) <= max_continuous_displacement * max_continuous_displacement;
+}
+
+
+// Circles moved by corrections during an update are awake for the rest of it.
+static bool is_circle_asleep(const Circle_Collider_Data & circle_data)
+{
+    return
+        circle_data.asleep &&
+        circle_data.position->x == circle_data.last_position.x &&
+        circle_data.position->y == circle_data.last_position.y;
+}
+
+
+static Circle_Collider_Data * find_island(Circle_Collider_Data * circle_data)
+{
+    while (circle_data->island != circle_data)
+    {
+        circle_data->island = circle_data->island->island;
+        circle_data = circle_data->island;
+    }
+
+    return circle_data;
+}
+
+
+// Records keep pointers to their circles' data, so once circles have been removed, they are looked up again. Records
+// from removed circles are dropped, while records with removed circles keep waking their circle's island, as they would
+// for any other collider that isn't static.
+static void refresh_collision_record_circles()
+{
+    int kept_collision_record_count = 0;
+
+    for (Collision_Record & collision_record : collision_records)
+    {
+        if (collision_record.circle_data == nullptr)
+        {
+            collision_records[kept_collision_record_count++] = collision_record;
+            continue;
+        }
+
+        const auto circle_data = circle_collider_datas.find(collision_record.entity);
+
+        if (circle_data == circle_collider_datas.end())
+        {
+            continue;
+        }
+
+        collision_record.circle_data = &circle_data->second;
+
+        if (collision_record.circle_b_data != nullptr)
+        {
+            const auto circle_b_data = circle_collider_datas.find(collision_record.collision_entity);
+
+            collision_record.circle_b_data =
+                circle_b_data != circle_collider_datas.end()
+                ? &circle_b_data->second
+                : nullptr;
+        }
+
+        collision_records[kept_collision_record_count++] = collision_record;
+    }
+
+    collision_records.resize(kept_collision_record_count);
+    circle_collider_data_removed = false;
+}
+
+
+// Islands are found from the last update's collisions, so must be updated before they are cleared. Circles changed
+// since the last update are woken.
+static void update_sleeping_islands()
+{
+    if (circle_collider_data_removed)
+    {
+        refresh_collision_record_circles();
+    }
+
+    island_circle_datas.clear();
+
+    for_each(circle_collider_datas, [](Entity /*entity*/, Circle_Collider_Data & circle_data) -> void
+    {
+        if (circle_collider_changed(circle_data))
+        {
+            circle_data.still_frame_count = 0;
+        }
+
+        circle_data.island = &circle_data;
+        circle_data.island_awake =
+            !sleeping_enabled ||
+            !*circle_data.enabled ||
+            circle_data.still_frame_count < SLEEP_FRAME_COUNT;
+        island_circle_datas.push_back(&circle_data);
+    });
+
+    for (const Collision_Record & collision_record : collision_records)
+    {
+        Circle_Collider_Data * circle_data = collision_record.circle_data;
+
+        if (circle_data == nullptr)
+        {
+            continue;
+        }
+
+        if (collision_record.circle_b_data != nullptr)
+        {
+            Circle_Collider_Data * island = find_island(circle_data);
+            Circle_Collider_Data * island_b = find_island(collision_record.circle_b_data);
+
+            if (island != island_b)
+            {
+                island->island = island_b;
+            }
+        }
+        else if (collision_record.static_line == nullptr)
+        {
+            circle_data->island_awake = true;
+        }
+    }
+
+
+    // An island is awake if any circle in it is.
+    for (Circle_Collider_Data * circle_data : island_circle_datas)
+    {
+        if (circle_data->island_awake)
+        {
+            find_island(circle_data)->island_awake = true;
+        }
+    }
+
+    for (Circle_Collider_Data * circle_data : island_circle_datas)
+    {
+        circle_data->asleep = !find_island(circle_data)->island_awake;
+    }
+}
+
+
+// The AABB of a continuous circle covers its whole movement since the last update.
+static void get_circle_aabb(int circle_index, vec2 & min_point, vec2 & max_point)
+{
+    const vec2 position(circle_position_xs[circle_index], circle_position_ys[circle_index]);
+    const float radius = fabsf(circle_radii[circle_index]);
+    min_point = position - vec2(radius);
+    max_point = position + vec2(radius);
+
+    if (circle_flags[circle_index] & CIRCLE_CONTINUOUS)
+    {
+        const vec2 previous_position(
+            circle_previous_position_xs[circle_index],
+            circle_previous_position_ys[circle_index]);
+
+        min_point.x = min(min_point.x, previous_position.x - radius);
+        min_point.y = min(min_point.y, previous_position.y - radius);
+        max_point.x = max(max_point.x, previous_position.x + radius);
+        max_point.y = max(max_point.y, previous_position.y + radius);
+    }
+}
+
+
+static void get_line_aabb(const vec3 & begin, const vec3 & end, vec2 & min_point, vec2 & max_point)
+{
+    min_point = vec2(min(begin.x, end.x), min(begin.y, end.y));
+    max_point = vec2(max(begin.x, end.x), max(begin.y, end.y));
+}
+
+
+static bool aabbs_overlap(
+    const vec2 & min_point_a,
+    const vec2 & max_point_a,
+    const vec2 & min_point_b,
+    const vec2 & max_point_b)
+{
+    return
+        min_point_a.x <= max_point_b.x && max_point_a.x >= min_point_b.x &&
+        min_point_a.y <= max_point_b.y && max_point_a.y >= min_point_b.y;
+}
+
+
+// Builds the node for indexes[begin, end) of a BVH over items with AABBs, splitting items at the median of the node's
+// longest axis.
+template<typename Item>
+static int build_bvh_node(
+    vector<BVH_Node> & nodes,
+    vector<int> & indexes,
+    const vector<Item> & items,
+    int begin,
+    int end)
+{
+    const int node_index = nodes.size();
+    nodes.push_back({ items[indexes[begin]].min_point, vec2(), -1, -1, begin, end });
+    BVH_Node & node = nodes.back();
+    node.max_point = items[indexes[begin]].max_point;
+
+    for (int i = begin + 1; i < end; i++)
+    {
+        const Item & item = items[indexes[i]];
+        node.min_point.x = min(node.min_point.x, item.min_point.x);
+        node.min_point.y = min(node.min_point.y, item.min_point.y);
+        node.max_point.x = max(node.max_point.x, item.max_point.x);
+        node.max_point.y = max(node.max_point.y, item.max_point.y);
+    }
+
+    if (end - begin <= BVH_NODE_SIZE)
+    {
+        return node_index;
+    }
+
+    const int axis = (node.max_point.x - node.min_point.x) >= (node.max_point.y - node.min_point.y) ? 0 : 1;
+    const int middle = begin + ((end - begin) / 2);
+
+    nth_element(
+        indexes.begin() + begin,
+        indexes.begin() + middle,
+        indexes.begin() + end,
+        [&](int item_a, int item_b) -> bool
+        {
+            return
+                items[item_a].min_point[axis] + items[item_a].max_point[axis] <
+                items[item_b].min_point[axis] + items[item_b].max_point[axis];
+        });
+
+
+    // Children are built after the node is filled in, since building them may reallocate nodes.
+    const int left = build_bvh_node(nodes, indexes, items, begin, middle);
+    const int right = build_bvh_node(nodes, indexes, items, middle, end);
+    nodes[node_index].left = left;
+    nodes[node_index].right = right;
+    return node_index;
+}
+
+
+// Calls item_handler with the index of each item whose AABB overlaps the given AABB.
+template<typename Item, typename Item_Handler>
+static void query_bvh(
+    const vector<BVH_Node> & nodes,
+    const vector<int> & indexes,
+    const vector<Item> & items,
+    vector<int> & query_stack,
+    const vec2 & min_point,
+    const vec2 & max_point,
+    const Item_Handler & item_handler)
+{
+    if (nodes.empty())
+    {
+        return;
+    }
+
+    query_stack.clear();
+    query_stack.push_back(0);
+
+    while (!query_stack.empty())
+    {
+        const BVH_Node & node = nodes[query_stack.back()];
+        query_stack.pop_back();
+
+        if (!aabbs_overlap(min_point, max_point, node.min_point, node.max_point))
+        {
+            continue;
+        }
+
+        if (node.left != -1)
+        {
+            query_stack.push_back(node.left);
+            query_stack.push_back(node.right);
+            continue;
+        }
+
+        for (int i = node.begin; i < node.end; i++)
+        {
+            const int item_index = indexes[i];
+            const Item & item = items[item_index];
+
+            if (aabbs_overlap(min_point, max_point, item.min_point, item.max_point))
+            {
+                item_handler(item_index);
+            }
+        }
+    }
+}
+
+
+static void get_proxy_layer(const Broadphase_Proxy & proxy, unsigned int & layer, unsigned int & mask)
+{
+    const int index = proxy.index;
+
+    switch (proxy.type)
+    {
+        case Broadphase_Proxy::Types::CIRCLE:
+            layer = circle_layers[index];
+            mask = circle_masks[index];
+            break;
+
+        case Broadphase_Proxy::Types::LINE:
+            layer = line_proxies[index].layer;
+            mask = line_proxies[index].mask;
+            break;
+
+        case Broadphase_Proxy::Types::POLYGON_LINE:
+            layer = polygon_proxies[polygon_line_proxies[index].polygon].layer;
+            mask = polygon_proxies[polygon_line_proxies[index].polygon].mask;
+            break;
+    }
+}
+
+
+static void collect_proxies()
+{
+    circle_proxies.clear();
+    line_proxies.clear();
+    polygon_proxies.clear();
+    polygon_line_proxies.clear();
+    circle_position_xs.clear();
+    circle_position_ys.clear();
+    circle_previous_position_xs.clear();
+    circle_previous_position_ys.clear();
+    circle_radii.clear();
+    circle_flags.clear();
+    circle_layers.clear();
+    circle_masks.clear();
+    pass_sleeping_circles.clear();
+    continuous_circle_count = 0;
+
+
+    // Collect enabled colliders in entity order, so narrow phase tests run in the same order as an exhaustive search.
+    for_each(circle_collider_datas, [&](Entity entity, Circle_Collider_Data & circle_data) -> void
+    {
+        if (!*circle_data.enabled)
+        {
+            return;
+        }
+
+        circle_proxies.push_back({ entity, &circle_data });
+        circle_position_xs.push_back(circle_data.position->x);
+        circle_position_ys.push_back(circle_data.position->y);
+        circle_previous_position_xs.push_back(circle_data.last_position.x);
+        circle_previous_position_ys.push_back(circle_data.last_position.y);
+        circle_radii.push_back(get_circle_radius(circle_data));
+
+        const bool continuous = is_circle_swept(circle_data);
+        const bool asleep = is_circle_asleep(circle_data);
+
+        if (continuous)
+        {
+            continuous_circle_count++;
+        }
+
+        if (asleep)
+        {
+            pass_sleeping_circles.push_back({ (int)circle_proxies.size() - 1, &circle_data, vec2(), vec2() });
+        }
+
+        circle_flags.push_back(
+            get_circle_collision_flags(circle_data) |
+            (asleep ? CIRCLE_ASLEEP : 0) |
+            (circle_collider_changed(circle_data) ? CIRCLE_MOVED : 0) |
+            (continuous ? CIRCLE_CONTINUOUS : 0));
+
+        circle_layers.push_back(*circle_data.layer);
+        circle_masks.push_back(*circle_data.mask);
+    });
+
+    for_each(line_collider_datas, [&](Entity entity, const Line_Collider_Data & line_data) -> void
+    {
+        if (*line_data.enabled)
+        {
+            line_proxies.push_back({ entity, &line_data, *line_data.layer, *line_data.mask });
+        }
+    });
+
+    for_each(polygon_collider_datas, [&](Entity entity, const Polygon_Collider_Data & polygon_data) -> void
+    {
+        if (!*polygon_data.enabled || polygon_data.is_static)
+        {
+            return;
+        }
+
+        const int line_count = polygon_data.begins->size();
+
+        for (int i = 0; i < line_count; i++)
+        {
+            polygon_line_proxies.push_back({ (int)polygon_proxies.size(), i });
+        }
+
+        polygon_proxies.push_back({ entity, &polygon_data, *polygon_data.layer, *polygon_data.mask });
+    });
+}
+
+
+static void build_spatial_hash()
+{
+    // Clear cells from the last pass, dropping the hash entirely if most of its cells are no longer used.
+    if (broadphase_cells.size() > occupied_cell_keys.size() * 4)
+    {
+        broadphase_cells.clear();
+    }
+    else
+    {
+        for (const long long cell_key : occupied_cell_keys)
+        {
+            broadphase_cells[cell_key].clear();
+        }
+    }
+
+    occupied_cell_keys.clear();
+    oversized_proxies.clear();
+
+
+    // Size cells to fit the average circle, so most circles only overlap a few cells. Without circles, size them to the
+    // average dynamic line instead.
+    float total_size = 0.0f;
+    int sized_count = circle_proxies.size();
+
+    for (const float circle_radius : circle_radii)
+    {
+        total_size += fabsf(circle_radius) * 2.0f;
+    }
+
+    if (circle_proxies.empty())
+    {
+        for (const Line_Proxy & line_proxy : line_proxies)
+        {
+            if (!line_proxy.data->is_static)
+            {
+                total_size += distance(*line_proxy.data->begin, *line_proxy.data->end);
+                sized_count++;
+            }
+        }
+    }
+
+    cell_size = sized_count > 0 ? max(total_size / sized_count, MIN_CELL_SIZE) : DEFAULT_CELL_SIZE;
+
+
+    // Insert colliders into every cell they overlap, or into the oversized list if they overlap too many.
+    const auto insert_line_proxy = [](const vec3 & begin, const vec3 & end, const Broadphase_Proxy & proxy) -> void
+    {
+        if (get_line_cell_count(begin, end) > MAX_PROXY_CELL_COUNT)
+        {
+            vec2 min_point;
+            vec2 max_point;
+            get_line_aabb(begin, end, min_point, max_point);
+            oversized_proxies.push_back({ proxy, min_point, max_point });
+            return;
+        }
+
+        for_each_line_cell(begin, end, [&](int x, int y) -> void
+        {
+            insert_proxy(x, y, proxy);
+        });
+    };
+
+    for (int i = 0; i < (int)circle_proxies.size(); i++)
+    {
+        const Broadphase_Proxy proxy { Broadphase_Proxy::Types::CIRCLE, i };
+        vec2 min_point;
+        vec2 max_point;
+
+        // Sleeping circles are found through the sleeping circle BVH instead.
+        if (circle_flags[i] & CIRCLE_ASLEEP)
+        {
+            continue;
+        }
+
+        get_circle_aabb(i, min_point, max_point);
+
+        if (get_aabb_cell_count(min_point, max_point) > MAX_PROXY_CELL_COUNT)
+        {
+            oversized_proxies.push_back({ proxy, min_point, max_point });
+            continue;
+        }
+
+        for_each_aabb_cell(min_point, max_point, [&](int x, int y) -> void
+        {
+            insert_proxy(x, y, proxy);
+        });
+    }
+
+    for (int i = 0; i < (int)line_proxies.size(); i++)
+    {
+        const Line_Collider_Data & line_data = *line_proxies[i].data;
+
+        // Static lines are found through the static line BVH instead.
+        if (!line_data.is_static)
+        {
+            insert_line_proxy(*line_data.begin, *line_data.end, { Broadphase_Proxy::Types::LINE, i });
+        }
+    }
+
+    for (int i = 0; i < (int)polygon_line_proxies.size(); i++)
+    {
+        const Polygon_Line_Proxy & polygon_line_proxy = polygon_line_proxies[i];
+        const Polygon_Collider_Data & polygon_data = *polygon_proxies[polygon_line_proxy.polygon].data;
+
+        insert_line_proxy(
+            (*polygon_data.begins)[polygon_line_proxy.line],
+            (*polygon_data.ends)[polygon_line_proxy.line],
+            { Broadphase_Proxy::Types::POLYGON_LINE, i });
+    }
+}
+
+
+static bool sweep_endpoint_less(const Sweep_Endpoint & endpoint_a, const Sweep_Endpoint & endpoint_b)
+{
+    // Min endpoints come first when values are equal, so touching boxes overlap.
+    return
+        endpoint_a.value < endpoint_b.value ||
+        (endpoint_a.value == endpoint_b.value && endpoint_a.is_min && !endpoint_b.is_min);
+}
+
+
+// Endpoints barely move between frames, so insertion sort is close to linear. Many new endpoints at once (like when a
+// scene is loaded) are sorted from scratch instead.
+static void sort_sweep_endpoints(vector<Sweep_Endpoint> & endpoints, int added_count, bool use_x)
+{
+    for (Sweep_Endpoint & endpoint : endpoints)
+    {
+        const Sweep_Box & sweep_box = sweep_boxes[endpoint.box];
+        const vec2 & point = endpoint.is_min ? sweep_box.min_point : sweep_box.max_point;
+        endpoint.value = use_x ? point.x : point.y;
+    }
+
+    if (added_count * 8 > (int)endpoints.size())
+    {
+        sort(endpoints.begin(), endpoints.end(), sweep_endpoint_less);
+        return;
+    }
+
+    for (int i = 1; i < (int)endpoints.size(); i++)
+    {
+        const Sweep_Endpoint endpoint = endpoints[i];
+        int j = i - 1;
+
+        for (; j >= 0 && sweep_endpoint_less(endpoint, endpoints[j]); j--)
+        {
+            endpoints[j + 1] = endpoints[j];
+        }
+
+        endpoints[j + 1] = endpoint;
+    }
+}
+
+
+static void build_sweep_and_prune()
+{
+    int added_count = 0;
+    int updated_count = 0;
+    sweep_pass++;
+
+    const auto update_sweep_box = [&](
+        unsigned long long key,
+        const Broadphase_Proxy & proxy,
+        const vec2 & min_point,
+        const vec2 & max_point) -> int
+    {
+        const auto sweep_box_index = sweep_box_indexes.find(key);
+        unsigned int layer;
+        unsigned int mask;
+        get_proxy_layer(proxy, layer, mask);
+        updated_count++;
+
+        if (sweep_box_index != sweep_box_indexes.end())
+        {
+            Sweep_Box & sweep_box = sweep_boxes[sweep_box_index->second];
+            sweep_box.proxy = proxy;
+            sweep_box.min_point = min_point;
+            sweep_box.max_point = max_point;
+            sweep_box.layer = layer;
+            sweep_box.mask = mask;
+            sweep_box.pass = sweep_pass;
+            return sweep_box_index->second;
+        }
+
+        const int box = sweep_boxes.size();
+        sweep_boxes.push_back({ key, proxy, min_point, max_point, layer, mask, sweep_pass });
+        sweep_box_indexes[key] = box;
+        sweep_endpoints_x.push_back({ 0.0f, box, true });
+        sweep_endpoints_x.push_back({ 0.0f, box, false });
+        sweep_endpoints_y.push_back({ 0.0f, box, true });
+        sweep_endpoints_y.push_back({ 0.0f, box, false });
+        added_count += 2;
+        return box;
+    };
+
+    const auto get_sweep_box_key = [](Broadphase_Proxy::Types type, Entity entity, int line) -> unsigned long long
+    {
+        return
+            ((unsigned long long)type << 56) |
+            ((unsigned long long)(unsigned int)entity << 24) |
+            (unsigned long long)(line & 0xFFFFFF);
+    };
+
+
+    // Update boxes for this pass's colliders, adding boxes for new colliders.
+    circle_sweep_boxes.assign(circle_proxies.size(), -1);
+    line_sweep_boxes.assign(line_proxies.size(), -1);
+    polygon_line_sweep_boxes.assign(polygon_line_proxies.size(), -1);
+
+    for (int i = 0; i < (int)circle_proxies.size(); i++)
+    {
+        vec2 min_point;
+        vec2 max_point;
+
+        // Sleeping circles are found through the sleeping circle BVH instead.
+        if (circle_flags[i] & CIRCLE_ASLEEP)
+        {
+            continue;
+        }
+
+        get_circle_aabb(i, min_point, max_point);
+
+        circle_sweep_boxes[i] = update_sweep_box(
+            get_sweep_box_key(Broadphase_Proxy::Types::CIRCLE, circle_proxies[i].entity, 0),
+            { Broadphase_Proxy::Types::CIRCLE, i },
+            min_point,
+            max_point);
+    }
+
+    for (int i = 0; i < (int)line_proxies.size(); i++)
+    {
+        const Line_Collider_Data & line_data = *line_proxies[i].data;
+        vec2 min_point;
+        vec2 max_point;
+
+        // Static lines are found through the static line BVH instead.
+        if (line_data.is_static)
+        {
+            continue;
+        }
+
+        get_line_aabb(*line_data.begin, *line_data.end, min_point, max_point);
+
+        line_sweep_boxes[i] = update_sweep_box(
+            get_sweep_box_key(Broadphase_Proxy::Types::LINE, line_proxies[i].entity, 0),
+            { Broadphase_Proxy::Types::LINE, i },
+            min_point,
+            max_point);
+    }
+
+    for (int i = 0; i < (int)polygon_line_proxies.size(); i++)
+    {
+        const Polygon_Line_Proxy & polygon_line_proxy = polygon_line_proxies[i];
+        const Polygon_Proxy & polygon_proxy = polygon_proxies[polygon_line_proxy.polygon];
+        const Polygon_Collider_Data & polygon_data = *polygon_proxy.data;
+        vec2 min_point;
+        vec2 max_point;
+
+        get_line_aabb(
+            (*polygon_data.begins)[polygon_line_proxy.line],
+            (*polygon_data.ends)[polygon_line_proxy.line],
+            min_point,
+            max_point);
+
+        polygon_line_sweep_boxes[i] = update_sweep_box(
+            get_sweep_box_key(Broadphase_Proxy::Types::POLYGON_LINE, polygon_proxy.entity, polygon_line_proxy.line),
+            { Broadphase_Proxy::Types::POLYGON_LINE, i },
+            min_point,
+            max_point);
+    }
+
+
+    // Remove boxes for colliders that were removed or disabled since the last pass, keeping endpoints in order.
+    if ((int)sweep_boxes.size() > updated_count)
+    {
+        int kept_count = 0;
+        sweep_box_remaps.assign(sweep_boxes.size(), -1);
+
+        for (int i = 0; i < (int)sweep_boxes.size(); i++)
+        {
+            if (sweep_boxes[i].pass != sweep_pass)
+            {
+                sweep_box_indexes.erase(sweep_boxes[i].key);
+                continue;
+            }
+
+            sweep_box_remaps[i] = kept_count;
+            sweep_box_indexes[sweep_boxes[i].key] = kept_count;
+            sweep_boxes[kept_count++] = sweep_boxes[i];
+        }
+
+        sweep_boxes.resize(kept_count);
+
+        const auto remap_endpoints = [&](vector<Sweep_Endpoint> & endpoints) -> void
+        {
+            int kept_endpoint_count = 0;
+
+            for (int i = 0; i < (int)endpoints.size(); i++)
+            {
+                const int box = sweep_box_remaps[endpoints[i].box];
+
+                if (box != -1)
+                {
+                    endpoints[kept_endpoint_count] = endpoints[i];
+                    endpoints[kept_endpoint_count++].box = box;
+                }
+            }
+
+            endpoints.resize(kept_endpoint_count);
+        };
+
+        const auto remap_boxes = [&](vector<int> & boxes) -> void
+        {
+            for (int & box : boxes)
+            {
+                if (box != -1)
+                {
+                    box = sweep_box_remaps[box];
+                }
+            }
+        };
+
+        remap_endpoints(sweep_endpoints_x);
+        remap_endpoints(sweep_endpoints_y);
+        remap_boxes(circle_sweep_boxes);
+        remap_boxes(line_sweep_boxes);
+        remap_boxes(polygon_line_sweep_boxes);
+    }
+
+    sort_sweep_endpoints(sweep_endpoints_x, added_count, true);
+    sort_sweep_endpoints(sweep_endpoints_y, added_count, false);
+
+
+    // Sweep along the axis box centers are most spread out along, which keeps the active list shortest.
+    vec2 center_sum;
+    vec2 center_square_sum;
+
+    for (const Sweep_Box & sweep_box : sweep_boxes)
+    {
+        const vec2 center = (sweep_box.min_point + sweep_box.max_point) * 0.5f;
+        center_sum = center_sum + center;
+        center_square_sum = center_square_sum + (center * center);
+    }
+
+    sweep_max_box_width = 0.0;
+    sweep_max_box_height = 0.0;
+
+    for (const Sweep_Box & sweep_box : sweep_boxes)
+    {
+        sweep_max_box_width = max(sweep_max_box_width, (double)sweep_box.max_point.x - sweep_box.min_point.x);
+        sweep_max_box_height = max(sweep_max_box_height, (double)sweep_box.max_point.y - sweep_box.min_point.y);
+    }
+
+    const float box_count = max((float)sweep_boxes.size(), 1.0f);
+    const vec2 center_mean = center_sum / box_count;
+    const vec2 center_variance = (center_square_sum / box_count) - (center_mean * center_mean);
+    const bool sweep_x = center_variance.x >= center_variance.y;
+    sweep_active_boxes.clear();
+    sweep_pairs.clear();
+
+    for (const Sweep_Endpoint & endpoint : sweep_x ? sweep_endpoints_x : sweep_endpoints_y)
+    {
+        if (!endpoint.is_min)
+        {
+            for (int i = 0; i < (int)sweep_active_boxes.size(); i++)
+            {
+                if (sweep_active_boxes[i] == endpoint.box)
+                {
+                    sweep_active_boxes[i] = sweep_active_boxes.back();
+                    sweep_active_boxes.pop_back();
+                    break;
+                }
+            }
+
+            continue;
+        }
+
+        const Sweep_Box & sweep_box = sweep_boxes[endpoint.box];
+
+        for (const int active_box : sweep_active_boxes)
+        {
+            const Sweep_Box & active_sweep_box = sweep_boxes[active_box];
+
+            const bool overlap =
+                sweep_x
+                ? sweep_box.min_point.y <= active_sweep_box.max_point.y &&
+                  sweep_box.max_point.y >= active_sweep_box.min_point.y
+                : sweep_box.min_point.x <= active_sweep_box.max_point.x &&
+                  sweep_box.max_point.x >= active_sweep_box.min_point.x;
+
+            if (overlap &&
+                layers_collide(sweep_box.layer, sweep_box.mask, active_sweep_box.layer, active_sweep_box.mask))
+            {
+                sweep_pairs.push_back(endpoint.box);
+                sweep_pairs.push_back(active_box);
+            }
+        }
+
+        sweep_active_boxes.push_back(endpoint.box);
+    }
+
+
+    // Build adjacency lists from overlapping pairs.
+    sweep_overlap_offsets.assign(sweep_boxes.size() + 1, 0);
+    sweep_overlaps.resize(sweep_pairs.size());
+
+    for (const int box : sweep_pairs)
+    {
+        sweep_overlap_offsets[box + 1]++;
+    }
+
+    for (int i = 0; i < (int)sweep_boxes.size(); i++)
+    {
+        sweep_overlap_offsets[i + 1] += sweep_overlap_offsets[i];
+    }
+
+    sweep_overlap_cursors.assign(sweep_overlap_offsets.begin(), sweep_overlap_offsets.end() - 1);
+
+    for (int i = 0; i < (int)sweep_pairs.size(); i += 2)
+    {
+        const int box_a = sweep_pairs[i];
+        const int box_b = sweep_pairs[i + 1];
+        sweep_overlaps[sweep_overlap_cursors[box_a]++] = box_b;
+        sweep_overlaps[sweep_overlap_cursors[box_b]++] = box_a;
+    }
+}
+
+
+// Sleeping circles are re-baked when any of them has been added, removed or changed since they were last baked, and
+// otherwise only have their indexes updated for this pass.
+static void update_sleeping_circles()
+{
+    const int sleeping_circle_count = pass_sleeping_circles.size();
+    bool sleeping_circles_changed = sleeping_circle_count != (int)sleeping_circles.size();
+
+    for (int i = 0; i < sleeping_circle_count; i++)
+    {
+        Sleeping_Circle & pass_sleeping_circle = pass_sleeping_circles[i];
+        get_circle_aabb(pass_sleeping_circle.circle, pass_sleeping_circle.min_point, pass_sleeping_circle.max_point);
+
+        if (!sleeping_circles_changed)
+        {
+            const Sleeping_Circle & sleeping_circle = sleeping_circles[i];
+
+            sleeping_circles_changed =
+                pass_sleeping_circle.data != sleeping_circle.data ||
+                pass_sleeping_circle.min_point != sleeping_circle.min_point ||
+                pass_sleeping_circle.max_point != sleeping_circle.max_point;
+        }
+    }
+
+    if (!sleeping_circles_changed)
+    {
+        for (int i = 0; i < sleeping_circle_count; i++)
+        {
+            sleeping_circles[i].circle = pass_sleeping_circles[i].circle;
+        }
+
+        return;
+    }
+
+    sleeping_circles.swap(pass_sleeping_circles);
+    sleeping_circle_indexes.resize(sleeping_circle_count);
+    sleeping_circle_nodes.clear();
+
+    for (int i = 0; i < sleeping_circle_count; i++)
+    {
+        sleeping_circle_indexes[i] = i;
+    }
+
+    if (sleeping_circle_count > 0)
+    {
+        build_bvh_node(sleeping_circle_nodes, sleeping_circle_indexes, sleeping_circles, 0, sleeping_circle_count);
+    }
+}
+
+
+// Finds the sleeping circles each awake circle and dynamic line overlaps, storing pairs of circles for both circles
+// (lines don't query for circles).
+static void find_sleeping_contacts()
+{
+    const int circle_count = circle_proxies.size();
+    sleeping_contact_pairs.clear();
+
+    const auto add_sleeping_contacts = [](
+        const Broadphase_Proxy & proxy,
+        const vec2 & min_point,
+        const vec2 & max_point) -> void
+    {
+        query_bvh(
+            sleeping_circle_nodes,
+            sleeping_circle_indexes,
+            sleeping_circles,
+            sleeping_contact_query_stack,
+            min_point,
+            max_point,
+            [&](int sleeping_circle_index) -> void
+            {
+                const int circle = sleeping_circles[sleeping_circle_index].circle;
+                sleeping_contact_pairs.push_back({ circle, proxy });
+
+                if (proxy.type == Broadphase_Proxy::Types::CIRCLE)
+                {
+                    sleeping_contact_pairs.push_back({ proxy.index, { Broadphase_Proxy::Types::CIRCLE, circle } });
+                }
+            });
+    };
+
+    if (!sleeping_circles.empty())
+    {
+        vec2 min_point;
+        vec2 max_point;
+
+        for (int i = 0; i < circle_count; i++)
+        {
+            if (!(circle_flags[i] & CIRCLE_ASLEEP))
+            {
+                get_circle_aabb(i, min_point, max_point);
+                add_sleeping_contacts({ Broadphase_Proxy::Types::CIRCLE, i }, min_point, max_point);
+            }
+        }
+
+        for (int i = 0; i < (int)line_proxies.size(); i++)
+        {
+            const Line_Collider_Data & line_data = *line_proxies[i].data;
+
+            if (!line_data.is_static)
+            {
+                get_line_aabb(*line_data.begin, *line_data.end, min_point, max_point);
+                add_sleeping_contacts({ Broadphase_Proxy::Types::LINE, i }, min_point, max_point);
+            }
+        }
+
+        for (int i = 0; i < (int)polygon_line_proxies.size(); i++)
+        {
+            const Polygon_Line_Proxy & polygon_line_proxy = polygon_line_proxies[i];
+            const Polygon_Collider_Data & polygon_data = *polygon_proxies[polygon_line_proxy.polygon].data;
+
+            get_line_aabb(
+                (*polygon_data.begins)[polygon_line_proxy.line],
+                (*polygon_data.ends)[polygon_line_proxy.line],
+                min_point,
+                max_point);
+
+            add_sleeping_contacts({ Broadphase_Proxy::Types::POLYGON_LINE, i }, min_point, max_point);
+        }
+    }
+
+
+    // Build adjacency lists from the pairs.
+    sleeping_contact_offsets.assign(circle_count + 1, 0);
+    sleeping_contacts.resize(sleeping_contact_pairs.size());
+
+    for (const Sleeping_Contact & sleeping_contact : sleeping_contact_pairs)
+    {
+        sleeping_contact_offsets[sleeping_contact.circle + 1]++;
+    }
+
+    for (int i = 0; i < circle_count; i++)
+    {
+        sleeping_contact_offsets[i + 1] += sleeping_contact_offsets[i];
+    }
+
+    sleeping_contact_cursors.assign(sleeping_contact_offsets.begin(), sleeping_contact_offsets.end() - 1);
+
+    for (const Sleeping_Contact & sleeping_contact : sleeping_contact_pairs)
+    {
+        sleeping_contacts[sleeping_contact_cursors[sleeping_contact.circle]++] = sleeping_contact.proxy;
+    }
+}
+
+
+static void build_broadphase()
+{
+    collect_proxies();
+    update_sleeping_circles();
+
+    if (broadphase_mode == Broadphase_Modes::SPATIAL_HASH)
+    {
+        build_spatial_hash();
+    }
+    else if (broadphase_mode == Broadphase_Modes::SWEEP_AND_PRUNE)
+    {
+        build_sweep_and_prune();
+    }
+}
+
+
+// Candidates on layers the querying collider doesn't collide with are stamped, but not collected.
+static void collect_candidate(Narrow_Phase_Context & context, const Broadphase_Proxy & proxy)
+{
+    const int index = proxy.index;
+    const unsigned int query_stamp = context.query_stamp;
+    const unsigned int query_layer = context.query_layer;
+    const unsigned int query_mask = context.query_mask;
+
+    switch (proxy.type)
+    {
+        case Broadphase_Proxy::Types::CIRCLE:
+            if (context.circle_stamps[index] != query_stamp)
+            {
+                context.circle_stamps[index] = query_stamp;
+
+                if (layers_collide(query_layer, query_mask, circle_layers[index], circle_masks[index]))
+                {
+                    context.circle_candidates.push_back(index);
+                }
+            }
+            break;
+
+        case Broadphase_Proxy::Types::LINE:
+            if (context.line_stamps[index] != query_stamp)
+            {
+                const Line_Proxy & line_proxy = line_proxies[index];
+                context.line_stamps[index] = query_stamp;
+
+                if (layers_collide(query_layer, query_mask, line_proxy.layer, line_proxy.mask))
+                {
+                    context.line_candidates.push_back(index);
+                }
+            }
+            break;
+
+        case Broadphase_Proxy::Types::POLYGON_LINE:
+            if (context.polygon_line_stamps[index] != query_stamp)
+            {
+                const Polygon_Proxy & polygon_proxy = polygon_proxies[polygon_line_proxies[index].polygon];
+                context.polygon_line_stamps[index] = query_stamp;
+
+                if (layers_collide(query_layer, query_mask, polygon_proxy.layer, polygon_proxy.mask))
+                {
+                    context.polygon_line_candidates.push_back(index);
+                }
+            }
+            break;
+    }
+}
+
+
+static void collect_cell_candidates(Narrow_Phase_Context & context, int x, int y)
+{
+    const auto cell = broadphase_cells.find(get_cell_key(x, y));
+
+    if (cell == broadphase_cells.end())
+    {
+        return;
+    }
+
+    for (const Broadphase_Proxy & proxy : cell->second)
+    {
+        collect_candidate(context, proxy);
+    }
+}
+
+
+static void collect_hash_aabb_candidates(Narrow_Phase_Context & context, const vec2 & min_point, const vec2 & max_point)
+{
+    if (get_aabb_cell_count(min_point, max_point) <= occupied_cell_keys.size())
+    {
+        for_each_aabb_cell(min_point, max_point, [&](int x, int y) -> void
+        {
+            collect_cell_candidates(context, x, y);
+        });
+    }
+    else
+    {
+        const float min_x = floorf(min_point.x / cell_size);
+        const float min_y = floorf(min_point.y / cell_size);
+        const float max_x = floorf(max_point.x / cell_size);
+        const float max_y = floorf(max_point.y / cell_size);
+
+        for (const long long cell_key : occupied_cell_keys)
+        {
+            const int x = (int)(cell_key >> 32);
+            const int y = (int)(unsigned int)cell_key;
+
+            if (x >= min_x && x <= max_x && y >= min_y && y <= max_y)
+            {
+                collect_cell_candidates(context, x, y);
+            }
+        }
+    }
+
+    for (const Oversized_Proxy & oversized_proxy : oversized_proxies)
+    {
+        if (aabbs_overlap(min_point, max_point, oversized_proxy.min_point, oversized_proxy.max_point))
+        {
+            collect_candidate(context, oversized_proxy.proxy);
+        }
+    }
+}
+
+
+// Lines spanning more cells than are occupied collect candidates from their AABB instead, as do oversized proxies.
+static void collect_hash_line_candidates(Narrow_Phase_Context & context, const vec3 & begin, const vec3 & end)
+{
+    vec2 min_point;
+    vec2 max_point;
+    get_line_aabb(begin, end, min_point, max_point);
+
+    if (get_line_cell_count(begin, end) > occupied_cell_keys.size())
+    {
+        collect_hash_aabb_candidates(context, min_point, max_point);
+        return;
+    }
+
+    for_each_line_cell(begin, end, [&](int x, int y) -> void
+    {
+        collect_cell_candidates(context, x, y);
+    });
+
+    for (const Oversized_Proxy & oversized_proxy : oversized_proxies)
+    {
+        if (aabbs_overlap(min_point, max_point, oversized_proxy.min_point, oversized_proxy.max_point))
+        {
+            collect_candidate(context, oversized_proxy.proxy);
+        }
+    }
+}
+
+
+static void begin_candidate_query(Narrow_Phase_Context & context, unsigned int layer, unsigned int mask)
+{
+    context.query_layer = layer;
+    context.query_mask = mask;
+
+    // Stamps only need clearing when the query stamp wraps around.
+    if (++context.query_stamp == 0)
+    {
+        fill(context.circle_stamps.begin(), context.circle_stamps.end(), 0);
+        fill(context.line_stamps.begin(), context.line_stamps.end(), 0);
+        fill(context.polygon_line_stamps.begin(), context.polygon_line_stamps.end(), 0);
+        context.query_stamp = 1;
+    }
+
+    context.circle_candidates.clear();
+    context.line_candidates.clear();
+    context.polygon_line_candidates.clear();
+}
+
+
+// Sorting candidates keeps narrow phase tests in the same order regardless of how the broadphase found them.
+static void end_candidate_query(Narrow_Phase_Context & context)
+{
+    sort(context.circle_candidates.begin(), context.circle_candidates.end());
+    sort(context.line_candidates.begin(), context.line_candidates.end());
+    sort(context.polygon_line_candidates.begin(), context.polygon_line_candidates.end());
+}
+
+
+static void collect_sweep_candidates(Narrow_Phase_Context & context, int box)
+{
+    for (int i = sweep_overlap_offsets[box]; i < sweep_overlap_offsets[box + 1]; i++)
+    {
+        collect_candidate(context, sweep_boxes[sweep_overlaps[i]].proxy);
+    }
+}
+
+
+// Sleeping circles are found through the sleeping circle BVH instead.
+static void collect_all_candidates(Narrow_Phase_Context & context)
+{
+    for (int i = 0; i < (int)circle_proxies.size(); i++)
+    {
+        if (!(circle_flags[i] & CIRCLE_ASLEEP))
+        {
+            collect_candidate(context, { Broadphase_Proxy::Types::CIRCLE, i });
+        }
+    }
+
+    for (int i = 0; i < (int)line_proxies.size(); i++)
+    {
+        if (!line_proxies[i].data->is_static)
+        {
+            collect_candidate(context, { Broadphase_Proxy::Types::LINE, i });
+        }
+    }
+
+    for (int i = 0; i < (int)polygon_line_proxies.size(); i++)
+    {
+        collect_candidate(context, { Broadphase_Proxy::Types::POLYGON_LINE, i });
+    }
+}
+
+
+static void collect_sleeping_circle_candidates(
+    Narrow_Phase_Context & context,
+    const vec2 & min_point,
+    const vec2 & max_point)
+{
+    query_bvh(
+        sleeping_circle_nodes,
+        sleeping_circle_indexes,
+        sleeping_circles,
+        context.bvh_query_stack,
+        min_point,
+        max_point,
+        [&](int sleeping_circle_index) -> void
+        {
+            const int circle = sleeping_circles[sleeping_circle_index].circle;
+            collect_candidate(context, { Broadphase_Proxy::Types::CIRCLE, circle });
+        });
+}
+
+
+static void collect_sleeping_contact_candidates(Narrow_Phase_Context & context, int circle_index)
+{
+    for (int i = sleeping_contact_offsets[circle_index]; i < sleeping_contact_offsets[circle_index + 1]; i++)
+    {
+        collect_candidate(context, sleeping_contacts[i]);
+    }
+}
+
+
+static void collect_circle_candidates(
+    Narrow_Phase_Context & context,
+    int circle_index,
+    const vec2 & min_point,
+    const vec2 & max_point)
+{
+    switch (broadphase_mode)
+    {
+        case Broadphase_Modes::SPATIAL_HASH:
+            collect_hash_aabb_candidates(context, min_point, max_point);
+            break;
+
+        case Broadphase_Modes::SWEEP_AND_PRUNE:
+            collect_sweep_candidates(context, circle_sweep_boxes[circle_index]);
+            break;
+
+        case Broadphase_Modes::BRUTE_FORCE:
+            collect_all_candidates(context);
+            break;
+    }
+}
+
+
+static void collect_line_candidates(Narrow_Phase_Context & context, int line_index)
+{
+    const Line_Collider_Data & line_data = *line_proxies[line_index].data;
+
+    switch (broadphase_mode)
+    {
+        case Broadphase_Modes::SPATIAL_HASH:
+            collect_hash_line_candidates(context, *line_data.begin, *line_data.end);
+            break;
+
+        case Broadphase_Modes::SWEEP_AND_PRUNE:
+            collect_sweep_candidates(context, line_sweep_boxes[line_index]);
+            break;
+
+        case Broadphase_Modes::BRUTE_FORCE:
+            collect_all_candidates(context);
+            break;
+    }
+}
+
+
+// Finds the circle candidates after the given circle that overlap it, in candidate order. Where SSE2 is available,
+// candidates are tested four at a time, loading them directly when their indexes are contiguous (as they are when
+// every circle is a candidate). Distances are compared unsquared (sqrt is exactly rounded in both paths), so touching
+// circles collide exactly as they do when the distance is computed for corrections. Returns how many were tested.
+static int find_circle_hits(Narrow_Phase_Context & context, int circle_index)
+{
+    vector<int> & circle_candidates = context.circle_candidates;
+    vector<int> & circle_hits = context.circle_hits;
+    const auto first_candidate = upper_bound(circle_candidates.begin(), circle_candidates.end(), circle_index);
+    const int * candidates = circle_candidates.data() + (first_candidate - circle_candidates.begin());
+    const int candidate_count = circle_candidates.end() - first_candidate;
+    const float circle_position_x = circle_position_xs[circle_index];
+    const float circle_position_y = circle_position_ys[circle_index];
+    const float circle_radius = circle_radii[circle_index];
+    int i = 0;
+    circle_hits.clear();
+
+#if __SSE2__ || _M_X64
+    const __m128 circle_position_x4 = _mm_set1_ps(circle_position_x);
+    const __m128 circle_position_y4 = _mm_set1_ps(circle_position_y);
+    const __m128 circle_radius4 = _mm_set1_ps(circle_radius);
+
+    for (; i + 4 <= candidate_count; i += 4)
+    {
+        const int * group = candidates + i;
+        __m128 circle_b_position_x4;
+        __m128 circle_b_position_y4;
+        __m128 circle_b_radius4;
+
+        if (group[3] - group[0] == 3)
+        {
+            circle_b_position_x4 = _mm_loadu_ps(&circle_position_xs[group[0]]);
+            circle_b_position_y4 = _mm_loadu_ps(&circle_position_ys[group[0]]);
+            circle_b_radius4 = _mm_loadu_ps(&circle_radii[group[0]]);
+        }
+        else
+        {
+            circle_b_position_x4 = _mm_setr_ps(
+                circle_position_xs[group[0]],
+                circle_position_xs[group[1]],
+                circle_position_xs[group[2]],
+                circle_position_xs[group[3]]);
+
+            circle_b_position_y4 = _mm_setr_ps(
+                circle_position_ys[group[0]],
+                circle_position_ys[group[1]],
+                circle_position_ys[group[2]],
+                circle_position_ys[group[3]]);
+
+            circle_b_radius4 = _mm_setr_ps(
+                circle_radii[group[0]],
+                circle_radii[group[1]],
+                circle_radii[group[2]],
+                circle_radii[group[3]]);
+        }
+
+        const __m128 offset_x4 = _mm_sub_ps(circle_b_position_x4, circle_position_x4);
+        const __m128 offset_y4 = _mm_sub_ps(circle_b_position_y4, circle_position_y4);
+        const __m128 collision_distance4 = _mm_add_ps(circle_radius4, circle_b_radius4);
+
+        const __m128 actual_distance4 =
+            _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(offset_x4, offset_x4), _mm_mul_ps(offset_y4, offset_y4)));
+
+        const int hit_mask = _mm_movemask_ps(_mm_cmple_ps(actual_distance4, collision_distance4));
+
+        for (int lane = 0; lane < 4; lane++)
+        {
+            if (hit_mask & (1 << lane))
+            {
+                circle_hits.push_back(group[lane]);
+            }
+        }
+    }
+#endif
+
+    for (; i < candidate_count; i++)
+    {
+        const int circle_b_index = candidates[i];
+        const float offset_x = circle_position_xs[circle_b_index] - circle_position_x;
+        const float offset_y = circle_position_ys[circle_b_index] - circle_position_y;
+        const float collision_distance = circle_radius + circle_radii[circle_b_index];
+
+        if (sqrtf((offset_x * offset_x) + (offset_y * offset_y)) <= collision_distance)
+        {
+            circle_hits.push_back(circle_b_index);
+        }
+    }
+
+    return candidate_count;
+}
+
+
+static bool check_line_line_collision(
+    const vec3 * line_begin,
+    const vec3 * line_end,
+    const vec3 * line_b_begin,
+    const vec3 * line_b_end)
+{
+    const float line_begin_x = line_begin->x;
+    const float line_begin_y = line_begin->y;
+    const float line_end_x = line_end->x;
+    const float line_end_y = line_end->y;
+    const vec3 r(line_end_x - line_begin_x, line_end_y - line_begin_y, 0.0f);
+    const float line_b_begin_x = line_b_begin->x;
+    const float line_b_begin_y = line_b_begin->y;
+    const float line_begins_offset_x = line_b_begin_x - line_begin_x;
+    const float line_begins_offset_y = line_b_begin_y - line_begin_y;
+    const vec3 CmP(line_begins_offset_x, line_begins_offset_y, 0.0f);
+    const vec3 s(line_b_end->x - line_b_begin_x, line_b_end->y - line_b_begin_y, 0.0f);
+    const float CmPxr = (CmP.x * r.y) - (CmP.y * r.x);
+    const float CmPxs = (CmP.x * s.y) - (CmP.y * s.x);
+    const float rxs = (r.x * s.y) - (r.y * s.x);
+
+    if (CmPxr == 0.0f)
+    {
+        // Lines are collinear, and so intersect if they have any overlap.
+        return
+            (line_begins_offset_x < 0.0f) != (line_b_begin_x - line_end_x < 0.0f) ||
+            (line_begins_offset_y < 0.0f) != (line_b_begin_y - line_end_y < 0.0f);
+    }
+    else if (rxs == 0.0f)
+    {
+        // Lines are parallel (no possible intersection).
+        return false;
+    }
+
+    const float rxsr = 1.0f / rxs;
+    const float t = CmPxs * rxsr;
+    const float u = CmPxr * rxsr;
+
+    return
+        t >= 0.0f && t <= 1.0f &&
+        u >= 0.0f && u <= 1.0f;
+}
+
+
+// Collects static lines whose AABB overlaps the given AABB, sorted back into entity order.
+static void collect_static_line_candidates(
+    Narrow_Phase_Context & context,
+    const vec2 & min_point,
+    const vec2 & max_point)
+{
+    vector<int> & static_line_candidates = context.static_line_candidates;
+    static_line_candidates.clear();
+
+    query_bvh(
+        static_line_nodes,
+        static_line_indexes,
+        static_lines,
+        context.bvh_query_stack,
+        min_point,
+        max_point,
+        [&](int static_line_index) -> void
+        {
+            static_line_candidates.push_back(static_line_index);
+        });
+
+    sort(static_line_candidates.begin(), static_line_candidates.end());
+}
+
+
+static void bake_static_collider_data()
+{
+    static_lines.clear();
+    static_line_indexes.clear();
+    static_line_nodes.clear();
+    static_line_collider_indexes.clear();
+
+    const auto add_static_line = [&](
+        Entity entity,
+        bool is_polygon_line,
+        const Collision_Handler * collision_handler,
+        const bool * sends_collision,
+        const bool * enabled,
+        const unsigned int * layer,
+        const unsigned int * mask,
+        const vec3 * begin,
+        const vec3 * end) -> void
+    {
+        vec2 min_point;
+        vec2 max_point;
+        get_line_aabb(*begin, *end, min_point, max_point);
+        static_line_indexes.push_back(static_lines.size());
+
+        static_lines.push_back(
+            {
+                entity,
+                is_polygon_line,
+                collision_handler,
+                sends_collision,
+                enabled,
+                layer,
+                mask,
+                begin,
+                end,
+                min_point,
+                max_point,
+                {},
+            });
+    };
+
+
+    // Bake lines from static colliders, whether enabled or not (colliders are checked for being enabled when queried).
+    for_each(line_collider_datas, [&](Entity entity, const Line_Collider_Data & line_data) -> void
+    {
+        if (line_data.is_static)
+        {
+            static_line_collider_indexes[entity] = static_lines.size();
+
+            add_static_line(
+                entity,
+                false,
+                line_data.collision_handler,
+                line_data.sends_collision,
+                line_data.enabled,
+                line_data.layer,
+                line_data.mask,
+                line_data.begin,
+                line_data.end);
+        }
+    });
+
+    for_each(polygon_collider_datas, [&](Entity entity, const Polygon_Collider_Data & polygon_data) -> void
+    {
+        if (!polygon_data.is_static)
+        {
+            return;
+        }
+
+        const int line_count = polygon_data.begins->size();
+
+        for (int i = 0; i < line_count; i++)
+        {
+            add_static_line(
+                entity,
+                true,
+                polygon_data.collision_handler,
+                polygon_data.sends_collision,
+                polygon_data.enabled,
+                polygon_data.layer,
+                polygon_data.mask,
+                &(*polygon_data.begins)[i],
+                &(*polygon_data.ends)[i]);
+        }
+    });
+
+    if (!static_lines.empty())
+    {
+        build_bvh_node(static_line_nodes, static_line_indexes, static_lines, 0, static_lines.size());
+    }
+
+
+    // Static line colliders never move relative to each other, so which of them intersect is only checked when baked.
+    Narrow_Phase_Context context {};
+
+    for (int i = 0; i < (int)static_lines.size(); i++)
+    {
+        Static_Line & static_line = static_lines[i];
+
+        if (static_line.is_polygon_line)
+        {
+            continue;
+        }
+
+        collect_static_line_candidates(context, static_line.min_point, static_line.max_point);
+
+        for (const int static_line_b_index : context.static_line_candidates)
+        {
+            const Static_Line & static_line_b = static_lines[static_line_b_index];
+
+            if (static_line_b_index > i &&
+                !static_line_b.is_polygon_line &&
+                check_line_line_collision(static_line.begin, static_line.end, static_line_b.begin, static_line_b.end))
+            {
+                static_line.intersecting_lines.push_back(static_line_b_index);
+            }
+        }
+    }
+
+
+    // Circles resting against static colliders are woken when they are re-baked.
+    for_each(circle_collider_datas, [](Entity /*entity*/, Circle_Collider_Data & circle_data) -> void
+    {
+        circle_data.still_frame_count = 0;
+    });
+
+    static_collider_data_dirty = false;
+}
+
+
+// Checks pairs with a continuous circle that didn't collide at the end of their movement for collisions partway through
+// it. Like other pairs, each is only checked by the first circle in it.
+static void check_continuous_circle_collisions(
+    const Narrow_Phase_Context & context,
+    Narrow_Phase_Chunk & chunk,
+    int circle_index)
+{
+    const Entity circle_entity = circle_proxies[circle_index].entity;
+    const Collision_Handler * circle_collision_handler = circle_proxies[circle_index].data->collision_handler;
+    const unsigned char circle_flags_a = circle_flags[circle_index];
+    const vector<int> & circle_hits = context.circle_hits;
+    auto circle_hit = circle_hits.begin();
+
+    for (const int circle_b_index : context.circle_candidates)
+    {
+        const unsigned char circle_b_flags = circle_flags[circle_b_index];
+
+        if (circle_b_index <= circle_index)
+        {
+            continue;
+        }
+
+        while (circle_hit != circle_hits.end() && *circle_hit < circle_b_index)
+        {
+            circle_hit++;
+        }
+
+        if ((circle_hit != circle_hits.end() && *circle_hit == circle_b_index) ||
+            !((circle_flags_a | circle_b_flags) & CIRCLE_CONTINUOUS))
+        {
+            continue;
+        }
+
+        float time_of_impact;
+        chunk.narrow_phase_tests++;
+
+        if (!get_circle_time_of_impact(circle_index, circle_b_index, time_of_impact))
+        {
+            continue;
+        }
+
+        chunk.collision_records.push_back(
+            {
+                circle_entity,
+                circle_collision_handler,
+                circle_proxies[circle_b_index].entity,
+                circle_proxies[circle_b_index].data->collision_handler,
+                circle_proxies[circle_index].data,
+                circle_proxies[circle_b_index].data,
+                nullptr,
+            });
+
+
+        // Continuous circles the collision would correct are moved back to where the pair first touched.
+        const bool receiving =
+            (circle_flags_a & CIRCLE_SENDS_COLLISION) && (circle_b_flags & CIRCLE_RECEIVES_COLLISION);
+
+        const bool sending =
+            (circle_b_flags & CIRCLE_SENDS_COLLISION) && (circle_flags_a & CIRCLE_RECEIVES_COLLISION);
+
+        if (receiving && (circle_b_flags & CIRCLE_CONTINUOUS))
+        {
+            chunk.circle_times_of_impact.push_back({ circle_b_index, time_of_impact });
+        }
+
+        if (sending && (circle_flags_a & CIRCLE_CONTINUOUS))
+        {
+            chunk.circle_times_of_impact.push_back({ circle_index, time_of_impact });
+        }
+    }
+}
+
+
+static void check_circle_collisions(Narrow_Phase_Context & context, Narrow_Phase_Chunk & chunk, int circle_index)
+{
+    const Entity circle_entity = circle_proxies[circle_index].entity;
+    Circle_Collider_Data * circle_data = circle_proxies[circle_index].data;
+    const Collision_Handler * circle_collision_handler = circle_data->collision_handler;
+    const float circle_position_x = circle_position_xs[circle_index];
+    const float circle_position_y = circle_position_ys[circle_index];
+    const vec3 circle_position_2d(circle_position_x, circle_position_y, 0.0f);
+    const float circle_radius = circle_radii[circle_index];
+    const bool circle_sends_collision = circle_flags[circle_index] & CIRCLE_SENDS_COLLISION;
+    const bool circle_receives_collision = circle_flags[circle_index] & CIRCLE_RECEIVES_COLLISION;
+    const bool circle_asleep = circle_flags[circle_index] & CIRCLE_ASLEEP;
+    const unsigned int circle_layer = circle_layers[circle_index];
+    const unsigned int circle_mask = circle_masks[circle_index];
+    vector<Collision_Record> & collision_records = chunk.collision_records;
+    vector<Collision_Correction> & collision_corrections = chunk.collision_corrections;
+
+
+    // Find colliders near this circle. Sleeping circles don't query the broadphase, since the awake colliders near them
+    // have already found them.
+    vec2 min_point;
+    vec2 max_point;
+    get_circle_aabb(circle_index, min_point, max_point);
+    begin_candidate_query(context, circle_layer, circle_mask);
+
+    if (!circle_asleep)
+    {
+        collect_circle_candidates(context, circle_index, min_point, max_point);
+    }
+
+    collect_sleeping_contact_candidates(context, circle_index);
+    end_candidate_query(context);
+
+
+    // Check for collisions with other circle colliders (each pair is only checked by the first circle in it).
+    chunk.narrow_phase_tests += find_circle_hits(context, circle_index);
+
+    for (const int circle_b_index : context.circle_hits)
+    {
+        Circle_Collider_Data * circle_b_data = circle_proxies[circle_b_index].data;
+        const float circle_b_position_x = circle_position_xs[circle_b_index];
+        const float circle_b_position_y = circle_position_ys[circle_b_index];
+        const vec3 circle_b_position_2d(circle_b_position_x, circle_b_position_y, 0.0f);
+        const float actual_distance = distance(circle_position_2d, circle_b_position_2d);
+        const float collision_distance = circle_radius + circle_radii[circle_b_index];
+        const unsigned char circle_b_flags = circle_flags[circle_b_index];
+        const Entity circle_b_entity = circle_proxies[circle_b_index].entity;
+        collision_records.push_back(
+            {
+                circle_entity,
+                circle_collision_handler,
+                circle_b_entity,
+                circle_b_data->collision_handler,
+                circle_data,
+                circle_b_data,
+                nullptr,
+            });
+
+
+        // Pairs of sleeping circles aren't checked, so at most one circle in the pair is asleep.
+        if (circle_asleep && (circle_b_flags & CIRCLE_MOVED))
+        {
+            chunk.woken_circles.push_back(circle_index);
+        }
+        else if ((circle_b_flags & CIRCLE_ASLEEP) && (circle_flags[circle_index] & CIRCLE_MOVED))
+        {
+            chunk.woken_circles.push_back(circle_b_index);
+        }
+
+
+        // Calculate collision corrections if necessary.
+        const bool receiving = circle_sends_collision && (circle_b_flags & CIRCLE_RECEIVES_COLLISION);
+        const bool sending = (circle_b_flags & CIRCLE_SENDS_COLLISION) && circle_receives_collision;
+
+        const vec3 correction =
+            normalize(circle_b_position_2d - circle_position_2d) *
+            (collision_distance - actual_distance);
+
+        if (receiving && sending)
+        {
+            const vec3 shared_correction = correction / 2.0f;
+            collision_corrections.push_back({ circle_b_index, shared_correction });
+            collision_corrections.push_back({ circle_index, -shared_correction });
+        }
+        else if (receiving)
+        {
+            collision_corrections.push_back({ circle_b_index, correction });
+        }
+        else if (sending)
+        {
+            collision_corrections.push_back({ circle_index, -correction });
+        }
+    }
+
+    if (continuous_circle_count > 0)
+    {
+        check_continuous_circle_collisions(context, chunk, circle_index);
+    }
+
+
+    // Check for collisions with line colliders.
+    for (const int line_index : context.line_candidates)
+    {
+        const Line_Collider_Data & line_data = *line_proxies[line_index].data;
+        chunk.narrow_phase_tests++;
+
+        if (check_line_circle_collision(
+                line_data.begin,
+                line_data.end,
+                circle_index,
+                circle_position_2d,
+                circle_position_x,
+                circle_position_y,
+                circle_radius,
+                *line_data.sends_collision,
+                circle_receives_collision,
+                collision_corrections,
+                chunk.circle_times_of_impact))
+        {
+            collision_records.push_back(
+                {
+                    circle_entity,
+                    circle_collision_handler,
+                    line_proxies[line_index].entity,
+                    line_data.collision_handler,
+                    circle_data,
+                    nullptr,
+                    nullptr,
+                });
+        }
+    }
+
+
+    // Check for collisions with polygon colliders. Candidate lines are sorted, so lines of the same polygon are
+    // adjacent.
+    const vector<int> & polygon_line_candidates = context.polygon_line_candidates;
+
+    for (auto i = 0u; i < polygon_line_candidates.size();)
+    {
+        const int polygon_index = polygon_line_proxies[polygon_line_candidates[i]].polygon;
+        const Polygon_Collider_Data & polygon_data = *polygon_proxies[polygon_index].data;
+        bool collision_detected = false;
+
+        for (; i < polygon_line_candidates.size(); i++)
+        {
+            const Polygon_Line_Proxy & polygon_line_proxy = polygon_line_proxies[polygon_line_candidates[i]];
+
+            if (polygon_line_proxy.polygon != polygon_index)
+            {
+                break;
+            }
+
+            chunk.narrow_phase_tests++;
+
+            if (check_line_circle_collision(
+                    &(*polygon_data.begins)[polygon_line_proxy.line],
+                    &(*polygon_data.ends)[polygon_line_proxy.line],
+                    circle_index,
+                    circle_position_2d,
+                    circle_position_x,
+                    circle_position_y,
+                    circle_radius,
+                    *polygon_data.sends_collision,
+                    circle_receives_collision,
+                    collision_corrections,
+                    chunk.circle_times_of_impact))
+            {
+                collision_detected = true;
+            }
+        }
+
+        if (collision_detected)
+        {
+            collision_records.push_back(
+                {
+                    circle_entity,
+                    circle_collision_handler,
+                    polygon_proxies[polygon_index].entity,
+                    polygon_data.collision_handler,
+                    circle_data,
+                    nullptr,
+                    nullptr,
+                });
+        }
+    }
+
+
+    // Check for collisions with static line and polygon colliders, unless this circle is asleep (in which case its
+    // collisions with them from the last update are kept).
+    if (circle_asleep)
+    {
+        return;
+    }
+
+    collect_static_line_candidates(context, min_point, max_point);
+
+    for (const int static_line_index : context.static_line_candidates)
+    {
+        const Static_Line & static_line = static_lines[static_line_index];
+
+        // Don't check for collision if collider is disabled or on a layer this circle doesn't collide with.
+        if (!*static_line.enabled ||
+            !layers_collide(circle_layer, circle_mask, *static_line.layer, *static_line.mask))
+        {
+            continue;
+        }
+
+        chunk.narrow_phase_tests++;
+
+        if (check_line_circle_collision(
+                static_line.begin,
+                static_line.end,
+                circle_index,
+                circle_position_2d,
+                circle_position_x,
+                circle_position_y,
+                circle_radius,
+                *static_line.sends_collision,
+                circle_receives_collision,
+                collision_corrections,
+                chunk.circle_times_of_impact))
+        {
+            collision_records.push_back(
+                {
+                    circle_entity,
+                    circle_collision_handler,
+                    static_line.entity,
+                    static_line.collision_handler,
+                    circle_data,
+                    nullptr,
+                    &static_line,
+                });
+        }
+    }
+}
+
+
+// Checks for line collider collisions that have not already been checked.
+static void check_line_collisions(Narrow_Phase_Context & context, Narrow_Phase_Chunk & chunk, int line_index)
+{
+    const Entity line_entity = line_proxies[line_index].entity;
+    const Line_Collider_Data & line_data = *line_proxies[line_index].data;
+    const Collision_Handler * line_collision_handler = line_data.collision_handler;
+    const unsigned int line_layer = line_proxies[line_index].layer;
+    const unsigned int line_mask = line_proxies[line_index].mask;
+    const vec3 * line_begin = line_data.begin;
+    const vec3 * line_end = line_data.end;
+    vector<Collision_Record> & collision_records = chunk.collision_records;
+
+
+    // Intersections between static lines were found when they were baked.
+    if (line_data.is_static)
+    {
+        const Static_Line & static_line = static_lines[static_line_collider_indexes.at(line_entity)];
+
+        for (const int static_line_b_index : static_line.intersecting_lines)
+        {
+            const Static_Line & static_line_b = static_lines[static_line_b_index];
+
+            if (*static_line_b.enabled &&
+                layers_collide(line_layer, line_mask, *static_line_b.layer, *static_line_b.mask))
+            {
+                collision_records.push_back(
+                    {
+                        line_entity,
+                        line_collision_handler,
+                        static_line_b.entity,
+                        static_line_b.collision_handler,
+                        nullptr,
+                        nullptr,
+                        nullptr,
+                    });
+            }
+        }
+
+        return;
+    }
+
+
+    // Find dynamic lines near this line.
+    begin_candidate_query(context, line_layer, line_mask);
+    collect_line_candidates(context, line_index);
+    end_candidate_query(context);
+
+
+    // Check for collisions with other dynamic line colliders (each pair is only checked by the first line in it).
+    for (const int line_b_index : context.line_candidates)
+    {
+        if (line_b_index <= line_index)
+        {
+            continue;
+        }
+
+        const Line_Collider_Data & line_b_data = *line_proxies[line_b_index].data;
+        chunk.narrow_phase_tests++;
+
+        if (check_line_line_collision(line_begin, line_end, line_b_data.begin, line_b_data.end))
+        {
+            collision_records.push_back(
+                {
+                    line_entity,
+                    line_collision_handler,
+                    line_proxies[line_b_index].entity,
+                    line_b_data.collision_handler,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                });
+        }
+    }
+
+
+    // Check for collisions with static line colliders. Like other pairs, the collision is checked and stored from the
+    // first line in the pair.
+    vec2 min_point;
+    vec2 max_point;
+    get_line_aabb(*line_begin, *line_end, min_point, max_point);
+    collect_static_line_candidates(context, min_point, max_point);
+
+    for (const int static_line_index : context.static_line_candidates)
+    {
+        const Static_Line & static_line = static_lines[static_line_index];
+
+        // Don't check for collision if collider is disabled, on a layer this line doesn't collide with, or a polygon
+        // (which lines don't collide with).
+        if (!*static_line.enabled ||
+            static_line.is_polygon_line ||
+            !layers_collide(line_layer, line_mask, *static_line.layer, *static_line.mask))
+        {
+            continue;
+        }
+
+        chunk.narrow_phase_tests++;
+
+        if (line_entity < static_line.entity)
+        {
+            if (check_line_line_collision(line_begin, line_end, static_line.begin, static_line.end))
+            {
+                collision_records.push_back(
+                    {
+                        line_entity,
+                        line_collision_handler,
+                        static_line.entity,
+                        static_line.collision_handler,
+                        nullptr,
+                        nullptr,
+                        nullptr,
+                    });
+            }
+        }
+        else if (check_line_line_collision(static_line.begin, static_line.end, line_begin, line_end))
+        {
+            collision_records.push_back(
+                {
+                    static_line.entity,
+                    static_line.collision_handler,
+                    line_entity,
+                    line_collision_handler,
+                    nullptr,
+                    nullptr,
+                    nullptr,
+                });
+        }
+    }
+}
+
+
+static void check_narrow_phase_chunk(Narrow_Phase_Context & context, int chunk_index)
+{
+    Narrow_Phase_Chunk & chunk = narrow_phase_chunks[chunk_index];
+    const int circle_count = circle_proxies.size();
+    const int begin = chunk_index * NARROW_PHASE_CHUNK_SIZE;
+    const int end = min(begin + NARROW_PHASE_CHUNK_SIZE, circle_count + (int)line_proxies.size());
+    chunk.collision_records.clear();
+    chunk.collision_corrections.clear();
+    chunk.circle_times_of_impact.clear();
+    chunk.woken_circles.clear();
+    chunk.narrow_phase_tests = 0;
+
+    for (int i = begin; i < end; i++)
+    {
+        if (i < circle_count)
+        {
+            check_circle_collisions(context, chunk, i);
+        }
+        else
+        {
+            check_line_collisions(context, chunk, i - circle_count);
+        }
+    }
+}
+
+
+static void check_claimed_narrow_phase_chunks(Narrow_Phase_Context & context)
+{
+    for (int chunk_index = next_narrow_phase_chunk++;
+         chunk_index < narrow_phase_chunk_count;
+         chunk_index = next_narrow_phase_chunk++)
+    {
+        (*narrow_phase_chunk_checker)(context, chunk_index);
+    }
+}
+
+
+static void run_narrow_phase_worker(int worker_index, unsigned int generation)
+{
+    while (true)
+    {
+        {
+            unique_lock<mutex> lock(narrow_phase_mutex);
+
+            narrow_phase_start_condition.wait(lock, [&]() -> bool
+            {
+                return stopping_narrow_phase_workers || narrow_phase_generation != generation;
+            });
+
+            if (stopping_narrow_phase_workers)
+            {
+                return;
+            }
+
+            generation = narrow_phase_generation;
+        }
+
+        check_claimed_narrow_phase_chunks(narrow_phase_contexts[worker_index]);
+
+        {
+            lock_guard<mutex> lock(narrow_phase_mutex);
+            finished_worker_count++;
+        }
+
+        narrow_phase_finish_condition.notify_one();
+    }
+}
+
+
+static void stop_narrow_phase_workers()
+{
+    {
+        lock_guard<mutex> lock(narrow_phase_mutex);
+        stopping_narrow_phase_workers = true;
+    }
+
+    narrow_phase_start_condition.notify_all();
+
+    for (thread & worker : narrow_phase_workers)
+    {
+        worker.join();
+    }
+
+    narrow_phase_workers.clear();
+    stopping_narrow_phase_workers = false;
+}
+
+
+static void start_narrow_phase_workers(int worker_count)
+{
+    stop_narrow_phase_workers();
+    narrow_phase_contexts.resize(worker_count);
+
+    for (int i = 1; i < worker_count; i++)
+    {
+        narrow_phase_workers.emplace_back(run_narrow_phase_worker, i, narrow_phase_generation);
+    }
+}
+
+
+// Starts workers if the worker count has changed, and sizes every context's stamps to fit the broadphase.
+static void prepare_narrow_phase_contexts()
+{
+    const int worker_count =
+        physics_worker_count > 0
+        ? physics_worker_count
+        : max((int)thread::hardware_concurrency(), 1);
+
+    if ((int)narrow_phase_contexts.size() != worker_count)
+    {
+        start_narrow_phase_workers(worker_count);
+    }
+
+    for (Narrow_Phase_Context & context : narrow_phase_contexts)
+    {
+        context.circle_stamps.resize(max(context.circle_stamps.size(), circle_proxies.size()), 0);
+        context.line_stamps.resize(max(context.line_stamps.size(), line_proxies.size()), 0);
+
+        context.polygon_line_stamps.resize(
+            max(context.polygon_line_stamps.size(), polygon_line_proxies.size()),
+            0);
+    }
+}
+
+
+// Workers only read collider data and the broadphase, writing results to each chunk and scratch data to their own
+// context, so they share no mutable state beyond the next chunk to check.
+static void check_narrow_phase_chunks(int chunk_count, const Narrow_Phase_Chunk_Checker & chunk_checker)
+{
+    prepare_narrow_phase_contexts();
+    const int worker_count = narrow_phase_contexts.size();
+    narrow_phase_chunk_checker = &chunk_checker;
+    narrow_phase_chunk_count = chunk_count;
+    next_narrow_phase_chunk = 0;
+
+    if (worker_count == 1 || chunk_count < MIN_PARALLEL_NARROW_PHASE_CHUNKS)
+    {
+        check_claimed_narrow_phase_chunks(narrow_phase_contexts[0]);
+        return;
+    }
+
+
+    // Wake workers, check chunks alongside them, then wait for them to finish.
+    {
+        lock_guard<mutex> lock(narrow_phase_mutex);
+        finished_worker_count = 0;
+        narrow_phase_generation++;
+    }
+
+    narrow_phase_start_condition.notify_all();
+    check_claimed_narrow_phase_chunks(narrow_phase_contexts[0]);
+    unique_lock<mutex> lock(narrow_phase_mutex);
+
+    narrow_phase_finish_condition.wait(lock, [&]() -> bool
+    {
+        return finished_worker_count == (int)narrow_phase_workers.size();
+    });
+}
+
+
+static void check_collisions()
+{
+    const steady_clock::time_point broadphase_start_time = steady_clock::now();
+    build_broadphase();
+    find_sleeping_contacts();
+    const steady_clock::time_point narrow_phase_start_time = steady_clock::now();
+    physics_stats.broadphase_time += duration<float, milli>(narrow_phase_start_time - broadphase_start_time).count();
+
+
+    // Check for collisions, then merge each chunk's results in chunk order (the order one thread would find them in).
+    const int circle_count = circle_proxies.size();
+    const int chunk_count =
+        (circle_count + (int)line_proxies.size() + NARROW_PHASE_CHUNK_SIZE - 1) / NARROW_PHASE_CHUNK_SIZE;
+
+    if ((int)narrow_phase_chunks.size() < chunk_count)
+    {
+        narrow_phase_chunks.resize(chunk_count);
+    }
+
+    check_narrow_phase_chunks(chunk_count, check_narrow_phase_chunk);
+    circle_correction_sums.assign(circle_count, vec3());
+    circle_correction_counts.assign(circle_count, 0);
+    circle_times_of_impact.assign(circle_count, 1.0f);
+
+    for (int i = 0; i < chunk_count; i++)
+    {
+        const Narrow_Phase_Chunk & chunk = narrow_phase_chunks[i];
+        collision_records.insert(
+            collision_records.end(),
+            chunk.collision_records.begin(),
+            chunk.collision_records.end());
+
+        for (const Collision_Correction & collision_correction : chunk.collision_corrections)
+        {
+            vec3 & circle_correction_sum = circle_correction_sums[collision_correction.circle];
+            circle_correction_sum = circle_correction_sum + collision_correction.correction;
+            circle_correction_counts[collision_correction.circle]++;
+        }
+
+        for (const Circle_Time_Of_Impact & circle_time_of_impact : chunk.circle_times_of_impact)
+        {
+            float & earliest_time_of_impact = circle_times_of_impact[circle_time_of_impact.circle];
+            earliest_time_of_impact = min(earliest_time_of_impact, circle_time_of_impact.time);
+        }
+
+        for (const int circle_index : chunk.woken_circles)
+        {
+            circle_proxies[circle_index].data->still_frame_count = 0;
+            circle_proxies[circle_index].data->asleep = false;
+        }
+
+        physics_stats.narrow_phase_tests += chunk.narrow_phase_tests;
+    }
+
+
+    // Resolve collisions by moving continuous circles back to where they first collided, and every other circle by the
+    // average of its corrections.
+    for (int i = 0; i < circle_count; i++)
+    {
+        vec3 & position = *circle_proxies[i].data->position;
+        const float time_of_impact = circle_times_of_impact[i];
+
+        if (time_of_impact < 1.0f)
+        {
+            const float previous_position_x = circle_previous_position_xs[i];
+            const float previous_position_y = circle_previous_position_ys[i];
+            position.x = previous_position_x + ((circle_position_xs[i] - previous_position_x) * time_of_impact);
+            position.y = previous_position_y + ((circle_position_ys[i] - previous_position_y) * time_of_impact);
+        }
+        else if (circle_correction_counts[i] > 0)
+        {
+            position += circle_correction_sums[i] / (float)circle_correction_counts[i];
+        }
+    }
+
+    physics_stats.narrow_phase_time += duration<float, milli>(steady_clock::now() - narrow_phase_start_time).count();
+}
+
+
+// Collisions from the last update between sleeping circles, or sleeping circles and enabled static colliders, are kept
+// (with their handlers refreshed), since those pairs won't be checked. Any other collision is dropped.
+static bool keep_sleeping_collision(Collision_Record & collision_record)
+{
+    const Circle_Collider_Data * circle_data = collision_record.circle_data;
+
+    if (circle_data == nullptr || !is_circle_asleep(*circle_data))
+    {
+        return false;
+    }
+
+    const unsigned int circle_layer = *circle_data->layer;
+    const unsigned int circle_mask = *circle_data->mask;
+    const Circle_Collider_Data * circle_b_data = collision_record.circle_b_data;
+    const Static_Line * static_line = collision_record.static_line;
+    collision_record.source_collision_handler = circle_data->collision_handler;
+
+    if (circle_b_data != nullptr)
+    {
+        collision_record.collision_handler = circle_b_data->collision_handler;
+
+        return
+            is_circle_asleep(*circle_b_data) &&
+            layers_collide(circle_layer, circle_mask, *circle_b_data->layer, *circle_b_data->mask);
+    }
+    else if (static_line != nullptr)
+    {
+        collision_record.collision_handler = static_line->collision_handler;
+
+        return
+            *static_line->enabled &&
+            layers_collide(circle_layer, circle_mask, *static_line->layer, *static_line->mask);
+    }
+
+    return false;
+}
+
+
+static bool collision_record_less(
+    const Collision_Record & collision_record_a,
+    const Collision_Record & collision_record_b)
+{
+    return
+        collision_record_a.entity < collision_record_b.entity ||
+        (collision_record_a.entity == collision_record_b.entity &&
+         collision_record_a.collision_entity < collision_record_b.collision_entity);
+}
+
+
+static bool collision_records_equal(
+    const Collision_Record & collision_record_a,
+    const Collision_Record & collision_record_b)
+{
+    return
+        collision_record_a.entity == collision_record_b.entity &&
+        collision_record_a.collision_entity == collision_record_b.collision_entity;
+}
+
+
+static float get_cross_product(const vec2 & a, const vec2 & b)
+{
+    return (a.x * b.y) - (a.y * b.x);
+}
+
+
+// Clips the part of the line through begin (along direction) from entry to exit (as multiples of direction) to the
+// given AABB. Returns false if none of it is inside the AABB.
+static bool clip_to_aabb(
+    const vec2 & begin,
+    const vec2 & direction,
+    const vec2 & min_point,
+    const vec2 & max_point,
+    float & entry,
+    float & exit)
+{
+    const auto clip_axis = [&](float axis_begin, float axis_direction, float axis_min, float axis_max) -> bool
+    {
+        if (axis_direction == 0.0f)
+        {
+            return axis_begin >= axis_min && axis_begin <= axis_max && entry <= exit;
+        }
+
+        const float axis_entry = (axis_min - axis_begin) / axis_direction;
+        const float axis_exit = (axis_max - axis_begin) / axis_direction;
+        entry = max(entry, min(axis_entry, axis_exit));
+        exit = min(exit, max(axis_entry, axis_exit));
+        return entry <= exit;
+    };
+
+    return
+        clip_axis(begin.x, direction.x, min_point.x, max_point.x) &&
+        clip_axis(begin.y, direction.y, min_point.y, max_point.y);
+}
+
+
+static bool line_overlaps_aabb(const vec3 & begin, const vec3 & end, const vec2 & min_point, const vec2 & max_point)
+{
+    float entry = 0.0f;
+    float exit = 1.0f;
+
+    return clip_to_aabb(
+        vec2(begin.x, begin.y),
+        vec2(end.x - begin.x, end.y - begin.y),
+        min_point,
+        max_point,
+        entry,
+        exit);
+}
+
+
+static float get_point_line_distance(const vec2 & point, const vec3 & line_begin, const vec3 & line_end)
+{
+    const vec2 begin(line_begin.x, line_begin.y);
+    const vec2 line_direction = vec2(line_end.x, line_end.y) - begin;
+    const float line_length_squared = dot(line_direction, line_direction);
+
+    const float projection =
+        line_length_squared > 0.0f
+        ? min(max(dot(point - begin, line_direction) / line_length_squared, 0.0f), 1.0f)
+        : 0.0f;
+
+    return distance(point, begin + (line_direction * projection));
+}
+
+
+// Finds how far along a ray (with a normalized direction) it first hits a circle, and the circle's normal there.
+static bool get_ray_circle_hit(
+    const vec2 & origin,
+    const vec2 & direction,
+    const vec2 & center,
+    float radius,
+    float & hit_distance,
+    vec2 & normal)
+{
+    const vec2 center_offset = origin - center;
+    const float B = dot(center_offset, direction);
+    const float C = dot(center_offset, center_offset) - (radius * radius);
+    const float discriminant = (B * B) - C;
+
+    if (C <= 0.0f)
+    {
+        hit_distance = 0.0f;
+        normal = vec2() - direction;
+        return true;
+    }
+
+    if (B > 0.0f || discriminant < 0.0f)
+    {
+        return false;
+    }
+
+    hit_distance = -B - sqrtf(discriminant);
+    normal = ((origin + (direction * hit_distance)) - center) / radius;
+    return true;
+}
+
+
+// Finds how far along a ray (with a normalized direction) it hits a line, and the line's normal facing the ray. Rays
+// parallel to the line don't hit it.
+static bool get_ray_line_hit(
+    const vec2 & origin,
+    const vec2 & direction,
+    const vec3 & line_begin,
+    const vec3 & line_end,
+    float & hit_distance,
+    vec2 & normal)
+{
+    const vec2 begin(line_begin.x, line_begin.y);
+    const vec2 line_direction = vec2(line_end.x, line_end.y) - begin;
+    const vec2 begin_offset = begin - origin;
+    const float denominator = get_cross_product(direction, line_direction);
+
+    if (denominator == 0.0f)
+    {
+        return false;
+    }
+
+    const float ray_projection = get_cross_product(begin_offset, line_direction) / denominator;
+    const float line_projection = get_cross_product(begin_offset, direction) / denominator;
+
+    if (ray_projection < 0.0f || line_projection < 0.0f || line_projection > 1.0f)
+    {
+        return false;
+    }
+
+    hit_distance = ray_projection;
+    normal = normalize(vec2(-line_direction.y, line_direction.x));
+
+    if (dot(normal, direction) > 0.0f)
+    {
+        normal = vec2() - normal;
+    }
+
+    return true;
+}
+
+
+static void update_spatial_query_bounds()
+{
+    spatial_query_bounds_empty = true;
+
+    const auto add_aabb = [](const vec2 & min_point, const vec2 & max_point) -> void
+    {
+        if (spatial_query_bounds_empty)
+        {
+            spatial_query_min_point = min_point;
+            spatial_query_max_point = max_point;
+            spatial_query_bounds_empty = false;
+            return;
+        }
+
+        spatial_query_min_point.x = min(spatial_query_min_point.x, min_point.x);
+        spatial_query_min_point.y = min(spatial_query_min_point.y, min_point.y);
+        spatial_query_max_point.x = max(spatial_query_max_point.x, max_point.x);
+        spatial_query_max_point.y = max(spatial_query_max_point.y, max_point.y);
+    };
+
+    vec2 min_point;
+    vec2 max_point;
+
+    for (int i = 0; i < (int)circle_proxies.size(); i++)
+    {
+        get_circle_aabb(i, min_point, max_point);
+        add_aabb(min_point, max_point);
+    }
+
+    for (const Line_Proxy & line_proxy : line_proxies)
+    {
+        get_line_aabb(*line_proxy.data->begin, *line_proxy.data->end, min_point, max_point);
+        add_aabb(min_point, max_point);
+    }
+
+    for (const Polygon_Line_Proxy & polygon_line_proxy : polygon_line_proxies)
+    {
+        const Polygon_Collider_Data & polygon_data = *polygon_proxies[polygon_line_proxy.polygon].data;
+
+        get_line_aabb(
+            (*polygon_data.begins)[polygon_line_proxy.line],
+            (*polygon_data.ends)[polygon_line_proxy.line],
+            min_point,
+            max_point);
+
+        add_aabb(min_point, max_point);
+    }
+
+    if (!static_line_nodes.empty())
+    {
+        add_aabb(static_line_nodes[0].min_point, static_line_nodes[0].max_point);
+    }
+}
+
+
+static void prepare_spatial_queries()
+{
+    if (static_collider_data_dirty)
+    {
+        bake_static_collider_data();
+    }
+
+    if (spatial_query_broadphase_dirty)
+    {
+        build_broadphase();
+        update_spatial_query_bounds();
+        spatial_query_broadphase_dirty = false;
+    }
+
+    prepare_narrow_phase_contexts();
+}
+
+
+// Boxes that overlap an AABB along an axis have their min endpoint between the AABB's min (less the largest box size
+// along that axis) and its max, so only endpoints in that range are scanned, along whichever axis has fewer of them.
+static void collect_sweep_aabb_candidates(
+    Narrow_Phase_Context & context,
+    const vec2 & min_point,
+    const vec2 & max_point)
+{
+    const auto endpoint_value_less = [](const Sweep_Endpoint & endpoint, double value) -> bool
+    {
+        return endpoint.value < value;
+    };
+
+    const auto value_endpoint_less = [](float value, const Sweep_Endpoint & endpoint) -> bool
+    {
+        return value < endpoint.value;
+    };
+
+    const auto x_begin = lower_bound(
+        sweep_endpoints_x.begin(),
+        sweep_endpoints_x.end(),
+        min_point.x - sweep_max_box_width,
+        endpoint_value_less);
+
+    const auto y_begin = lower_bound(
+        sweep_endpoints_y.begin(),
+        sweep_endpoints_y.end(),
+        min_point.y - sweep_max_box_height,
+        endpoint_value_less);
+
+    const auto x_end = upper_bound(x_begin, sweep_endpoints_x.end(), max_point.x, value_endpoint_less);
+    const auto y_end = upper_bound(y_begin, sweep_endpoints_y.end(), max_point.y, value_endpoint_less);
+    const bool scan_x = x_end - x_begin <= y_end - y_begin;
+
+    for (auto endpoint = scan_x ? x_begin : y_begin; endpoint != (scan_x ? x_end : y_end); ++endpoint)
+    {
+        const Sweep_Box & sweep_box = sweep_boxes[endpoint->box];
+
+        if (endpoint->is_min && aabbs_overlap(min_point, max_point, sweep_box.min_point, sweep_box.max_point))
+        {
+            collect_candidate(context, sweep_box.proxy);
+        }
+    }
+}
+
+
+// Queries are treated as a collider on every layer with the query's mask.
+static void begin_spatial_query(Narrow_Phase_Context & context, unsigned int mask)
+{
+    begin_candidate_query(context, ~0u, mask);
+    context.static_line_candidates.clear();
+}
+
+
+// Collects candidates within the given AABB (clipped to the bounds of every collider), including static lines.
+static void collect_spatial_query_candidates(
+    Narrow_Phase_Context & context,
+    unsigned int mask,
+    const vec2 & min_point,
+    const vec2 & max_point)
+{
+    begin_spatial_query(context, mask);
+
+    if (spatial_query_bounds_empty ||
+        !aabbs_overlap(min_point, max_point, spatial_query_min_point, spatial_query_max_point))
+    {
+        return;
+    }
+
+    const vec2 clipped_min_point(
+        max(min_point.x, spatial_query_min_point.x),
+        max(min_point.y, spatial_query_min_point.y));
+
+    const vec2 clipped_max_point(
+        min(max_point.x, spatial_query_max_point.x),
+        min(max_point.y, spatial_query_max_point.y));
+
+    switch (broadphase_mode)
+    {
+        case Broadphase_Modes::SPATIAL_HASH:
+            collect_hash_aabb_candidates(context, clipped_min_point, clipped_max_point);
+            break;
+
+        case Broadphase_Modes::SWEEP_AND_PRUNE:
+            collect_sweep_aabb_candidates(context, clipped_min_point, clipped_max_point);
+            break;
+
+        case Broadphase_Modes::BRUTE_FORCE:
+            collect_all_candidates(context);
+            break;
+    }
+
+    collect_sleeping_circle_candidates(context, clipped_min_point, clipped_max_point);
+    end_candidate_query(context);
+    collect_static_line_candidates(context, clipped_min_point, clipped_max_point);
+}
+
+
+// Calls circle_handler with each circle candidate's entity, center and radius, then line_handler with each line
+// candidate's entity and line (polygons once per line), in the order ties between them are broken in.
+template<typename Circle_Handler, typename Line_Handler>
+static void for_each_spatial_query_candidate(
+    const Narrow_Phase_Context & context,
+    unsigned int mask,
+    const Circle_Handler & circle_handler,
+    const Line_Handler & line_handler)
+{
+    for (const int circle_index : context.circle_candidates)
+    {
+        circle_handler(
+            circle_proxies[circle_index].entity,
+            vec2(circle_position_xs[circle_index], circle_position_ys[circle_index]),
+            fabsf(circle_radii[circle_index]));
+    }
+
+    for (const int line_index : context.line_candidates)
+    {
+        const Line_Proxy & line_proxy = line_proxies[line_index];
+        line_handler(line_proxy.entity, *line_proxy.data->begin, *line_proxy.data->end);
+    }
 
-        // Check for collisions with other line colliders.
-        for_each(line_collider_datas, lines_iterator, [&](
-            Entity line_b_entity,
-            const Line_Collider_Data & line_b_data) -> void
+    for (const int polygon_line_index : context.polygon_line_candidates)
+    {
+        const Polygon_Line_Proxy & polygon_line_proxy = polygon_line_proxies[polygon_line_index];
+        const Polygon_Proxy & polygon_proxy = polygon_proxies[polygon_line_proxy.polygon];
+
+        line_handler(
+            polygon_proxy.entity,
+            (*polygon_proxy.data->begins)[polygon_line_proxy.line],
+            (*polygon_proxy.data->ends)[polygon_line_proxy.line]);
+    }
+
+
+    // Static lines are baked whether enabled or not, and aren't filtered by layer when collected.
+    for (const int static_line_index : context.static_line_candidates)
+    {
+        const Static_Line & static_line = static_lines[static_line_index];
+
+        if (*static_line.enabled && layers_collide(~0u, mask, *static_line.layer, *static_line.mask))
+        {
+            line_handler(static_line.entity, *static_line.begin, *static_line.end);
+        }
+    }
+}
+
+
+// Polygons are found once per overlapping line, so overlaps are sorted into entity order without duplicates.
+static void sort_overlaps(vector<Entity> & entities)
+{
+    sort(entities.begin(), entities.end());
+    entities.erase(unique(entities.begin(), entities.end()), entities.end());
+}
+
+
+static void cast_ray(Narrow_Phase_Context & context, const Raycast_Query & query, Raycast_Hit & raycast_hit)
+{
+    const vec2 origin(query.origin.x, query.origin.y);
+    const vec2 direction(query.direction.x, query.direction.y);
+    const float direction_length = sqrtf(dot(direction, direction));
+    float entry = 0.0f;
+    float exit = query.max_distance;
+    raycast_hit = { false, -1, vec3(), vec3(), 0.0f };
+
+    if (direction_length == 0.0f ||
+        spatial_query_bounds_empty ||
+        !clip_to_aabb(
+            origin,
+            direction / direction_length,
+            spatial_query_min_point,
+            spatial_query_max_point,
+            entry,
+            exit))
+    {
+        return;
+    }
+
+
+    // Collect candidates along the part of the ray inside the bounds of every collider.
+    const vec2 ray_direction = direction / direction_length;
+    const vec2 ray_begin = origin + (ray_direction * entry);
+    const vec2 ray_end = origin + (ray_direction * exit);
+    const vec3 ray_begin_3d(ray_begin.x, ray_begin.y, 0.0f);
+    const vec3 ray_end_3d(ray_end.x, ray_end.y, 0.0f);
+    vec2 min_point;
+    vec2 max_point;
+    get_line_aabb(ray_begin_3d, ray_end_3d, min_point, max_point);
+    begin_spatial_query(context, query.mask);
+
+    switch (broadphase_mode)
+    {
+        case Broadphase_Modes::SPATIAL_HASH:
+            collect_hash_line_candidates(context, ray_begin_3d, ray_end_3d);
+            break;
+
+        case Broadphase_Modes::SWEEP_AND_PRUNE:
+            collect_sweep_aabb_candidates(context, min_point, max_point);
+            break;
+
+        case Broadphase_Modes::BRUTE_FORCE:
+            collect_all_candidates(context);
+            break;
+    }
+
+    collect_sleeping_circle_candidates(context, min_point, max_point);
+    end_candidate_query(context);
+    collect_static_line_candidates(context, min_point, max_point);
+
+
+    // Keep the closest hit, or the first found when several are equally close.
+    float hit_distance;
+    vec2 normal;
+
+    const auto add_hit = [&](Entity entity) -> void
+    {
+        if (hit_distance > query.max_distance || (raycast_hit.hit && hit_distance >= raycast_hit.distance))
+        {
+            return;
+        }
+
+        const vec2 point = origin + (ray_direction * hit_distance);
+        raycast_hit = { true, entity, vec3(point.x, point.y, 0.0f), vec3(normal.x, normal.y, 0.0f), hit_distance };
+    };
+
+    for_each_spatial_query_candidate(
+        context,
+        query.mask,
+        [&](Entity entity, const vec2 & center, float radius) -> void
         {
-            // Don't check for collision if collider is disabled.
-            if (!*line_b_data.enabled)
+            if (get_ray_circle_hit(origin, ray_direction, center, radius, hit_distance, normal))
             {
-                return;
+                add_hit(entity);
             }
-
-            const Collision_Handler * line_b_collision_handler = line_b_data.collision_handler;
-            const vec3 * line_b_begin = line_b_data.begin;
-            const vec3 * line_b_end = line_b_data.end;
-            const float line_b_begin_x = line_b_begin->x;
-            const float line_b_begin_y = line_b_begin->y;
-            const float line_begins_offset_x = line_b_begin_x - line_begin_x;
-            const float line_begins_offset_y = line_b_begin_y - line_begin_y;
-            const vec3 CmP(line_begins_offset_x, line_begins_offset_y, 0.0f);
-            const vec3 s(line_b_end->x - line_b_begin_x, line_b_end->y - line_b_begin_y, 0.0f);
-            const float CmPxr = (CmP.x * r.y) - (CmP.y * r.x);
-            const float CmPxs = (CmP.x * s.y) - (CmP.y * s.x);
-            const float rxs = (r.x * s.y) - (r.y * s.x);
-
-            if (CmPxr == 0.0f)
-            {
-                // Lines are collinear, and so intersect if they have any overlap.
-
-                if ((line_begins_offset_x < 0.0f) != (line_b_begin_x - line_end_x < 0.0f) ||
-                    (line_begins_offset_y < 0.0f) != (line_b_begin_y - line_end_y < 0.0f))
-                {
-                    collision_handlers[line_b_entity] = line_b_collision_handler;
-                }
+        },
+        [&](Entity entity, const vec3 & line_begin, const vec3 & line_end) -> void
+        {
+            if (get_ray_line_hit(origin, ray_direction, line_begin, line_end, hit_distance, normal))
+            {
+                add_hit(entity);
             }
-            else if (rxs == 0.0f)
+        });
+}
+
+
+static void find_circle_overlaps(
+    Narrow_Phase_Context & context,
+    const Overlap_Circle_Query & query,
+    vector<Entity> & entities)
+{
+    const vec2 position(query.position.x, query.position.y);
+    const float radius = fabsf(query.radius);
+    entities.clear();
+    collect_spatial_query_candidates(context, query.mask, position - vec2(radius), position + vec2(radius));
+
+    for_each_spatial_query_candidate(
+        context,
+        query.mask,
+        [&](Entity entity, const vec2 & center, float circle_radius) -> void
+        {
+            if (distance(position, center) <= radius + circle_radius)
             {
-                // Lines are parallel (no possible intersection).
+                entities.push_back(entity);
             }
-            else
+        },
+        [&](Entity entity, const vec3 & line_begin, const vec3 & line_end) -> void
+        {
+            if (get_point_line_distance(position, line_begin, line_end) <= radius)
             {
-                const float rxsr = 1.0f / rxs;
-                const float t = CmPxs * rxsr;
-                const float u = CmPxr * rxsr;
+                entities.push_back(entity);
+            }
+        });
 
-                if (t >= 0.0f && t <= 1.0f &&
-                    u >= 0.0f && u <= 1.0f)
-                {
-                    collision_handlers[line_b_entity] = line_b_collision_handler;
-                }
+    sort_overlaps(entities);
+}
+
+
+static void find_aabb_overlaps(
+    Narrow_Phase_Context & context,
+    const Overlap_AABB_Query & query,
+    vector<Entity> & entities)
+{
+    const vec2 min_point(min(query.min_point.x, query.max_point.x), min(query.min_point.y, query.max_point.y));
+    const vec2 max_point(max(query.min_point.x, query.max_point.x), max(query.min_point.y, query.max_point.y));
+    entities.clear();
+    collect_spatial_query_candidates(context, query.mask, min_point, max_point);
+
+    for_each_spatial_query_candidate(
+        context,
+        query.mask,
+        [&](Entity entity, const vec2 & center, float radius) -> void
+        {
+            const vec2 closest_point(
+                min(max(center.x, min_point.x), max_point.x),
+                min(max(center.y, min_point.y), max_point.y));
+
+            if (distance(center, closest_point) <= radius)
+            {
+                entities.push_back(entity);
+            }
+        },
+        [&](Entity entity, const vec3 & line_begin, const vec3 & line_end) -> void
+        {
+            if (line_overlaps_aabb(line_begin, line_end, min_point, max_point))
+            {
+                entities.push_back(entity);
             }
         });
-    }
 
+    sort_overlaps(entities);
+}
+
+
+// Searches an AABB around the query's position that doubles in size until it contains a collider that is closer than
+// the search distance (so any collider closer still must overlap it too), reaches the query's max distance, or contains
+// the bounds of every collider.
+static void find_nearest(Narrow_Phase_Context & context, const Nearest_Query & query, Nearest_Result & nearest_result)
+{
+    const vec2 position(query.position.x, query.position.y);
+    float search_distance = min(cell_size, query.max_distance);
+    nearest_result = { false, -1, 0.0f };
 
-    // Resolve collisions.
-    for_each(collision_corrections, [=](vec3 * position, const vector<vec3> & corrections) -> void
+    if (query.max_distance < 0.0f || spatial_query_bounds_empty)
     {
-        vec3 final_correction;
+        return;
+    }
 
-        for (const vec3 & correction : corrections)
+    const auto add_candidate = [&](Entity entity, float candidate_distance) -> void
+    {
+        if (candidate_distance <= query.max_distance &&
+            (!nearest_result.found || candidate_distance < nearest_result.distance))
         {
-            final_correction += correction;
-            // if (fabsf(correction.x) > fabsf(final_correction.x))
-            // {
-            //     final_correction.x = correction.x;
-            // }
+            nearest_result = { true, entity, candidate_distance };
+        }
+    };
+
+    while (true)
+    {
+        const vec2 search_min_point = position - vec2(search_distance);
+        const vec2 search_max_point = position + vec2(search_distance);
+        nearest_result = { false, -1, 0.0f };
+        collect_spatial_query_candidates(context, query.mask, search_min_point, search_max_point);
+
+        for_each_spatial_query_candidate(
+            context,
+            query.mask,
+            [&](Entity entity, const vec2 & center, float radius) -> void
+            {
+                add_candidate(entity, max(distance(position, center) - radius, 0.0f));
+            },
+            [&](Entity entity, const vec3 & line_begin, const vec3 & line_end) -> void
+            {
+                add_candidate(entity, get_point_line_distance(position, line_begin, line_end));
+            });
 
-            // if (fabsf(correction.y) > fabsf(final_correction.y))
-            // {
-            //     final_correction.y = correction.y;
-            // }
+        const bool searched_all =
+            search_min_point.x <= spatial_query_min_point.x &&
+            search_min_point.y <= spatial_query_min_point.y &&
+            search_max_point.x >= spatial_query_max_point.x &&
+            search_max_point.y >= spatial_query_max_point.y;
+
+        if ((nearest_result.found && nearest_result.distance <= search_distance) ||
+            search_distance >= query.max_distance ||
+            searched_all)
+        {
+            return;
         }
 
-        (*position) += final_correction / (float)corrections.size()/* / (float)PASS_COUNT*/;
-    });
+        search_distance = min(search_distance * 2.0f, query.max_distance);
+    }
+}
+
+
+// Each query writes its result to the same index in results, so chunks of them can be run on any thread.
+template<typename Query, typename Result, typename Query_Handler>
+static void run_spatial_queries(
+    const vector<Query> & queries,
+    vector<Result> & results,
+    const Query_Handler & query_handler)
+{
+    const int query_count = queries.size();
+    prepare_spatial_queries();
+    results.resize(query_count);
+
+    check_narrow_phase_chunks(
+        (query_count + SPATIAL_QUERY_CHUNK_SIZE - 1) / SPATIAL_QUERY_CHUNK_SIZE,
+        [&](Narrow_Phase_Context & context, int chunk_index) -> void
+        {
+            const int begin = chunk_index * SPATIAL_QUERY_CHUNK_SIZE;
+            const int end = min(begin + SPATIAL_QUERY_CHUNK_SIZE, query_count);
+
+            for (int i = begin; i < end; i++)
+            {
+                query_handler(context, queries[i], results[i]);
+            }
+        });
 }
 
 
@@ -523,20 +3885,41 @@ void load_circle_collider_data(
     const bool * sends_collision,
     const bool * receives_collision,
     const bool * enabled,
+    const unsigned int * layer,
+    const unsigned int * mask,
+    const bool * continuous,
     const float * radius,
     vec3 * position,
     const vec3 * scale)
 {
-    circle_collider_datas[entity] =
+    Circle_Collider_Data & circle_data = circle_collider_datas[entity];
+
+    circle_data =
     {
         collision_handler,
         sends_collision,
         receives_collision,
         enabled,
+        layer,
+        mask,
+        continuous,
         radius,
         scale,
         position,
+        0,
+        false,
+        nullptr,
+        false,
+        vec2(),
+        0.0f,
+        0,
+        0,
+        0,
+        false,
     };
+
+    store_circle_collider_state(circle_data);
+    spatial_query_broadphase_dirty = true;
 }
 
 
@@ -546,18 +3929,35 @@ void load_line_collider_data(
     const bool * sends_collision,
     const bool * receives_collision,
     const bool * enabled,
+    const unsigned int * layer,
+    const unsigned int * mask,
+    bool is_static,
     const vec3 * line_begin,
     const vec3 * line_end)
 {
+    // Replacing a static collider changes the static geometry as much as loading one does.
+    const bool replaces_static_collider =
+        contains_key(line_collider_datas, entity) && line_collider_datas.at(entity).is_static;
+
     line_collider_datas[entity] =
     {
         collision_handler,
         sends_collision,
         receives_collision,
         enabled,
+        layer,
+        mask,
+        is_static,
         line_begin,
         line_end,
     };
+
+    spatial_query_broadphase_dirty = true;
+
+    if (is_static || replaces_static_collider)
+    {
+        invalidate_static_collider_data();
+    }
 }
 
 
@@ -567,83 +3967,354 @@ void load_polygon_collider_data(
     const bool * sends_collision,
     const bool * receives_collision,
     const bool * enabled,
+    const unsigned int * layer,
+    const unsigned int * mask,
+    bool is_static,
     const vector<vec3> * line_begins,
     const vector<vec3> * line_ends,
     vec3 * position)
 {
+    const bool replaces_static_collider =
+        contains_key(polygon_collider_datas, entity) && polygon_collider_datas.at(entity).is_static;
+
     polygon_collider_datas[entity] =
     {
         collision_handler,
         sends_collision,
         receives_collision,
         enabled,
+        layer,
+        mask,
+        is_static,
         line_begins,
         line_ends,
         position,
     };
+
+    spatial_query_broadphase_dirty = true;
+
+    if (is_static || replaces_static_collider)
+    {
+        invalidate_static_collider_data();
+    }
 }
 
 
 void remove_circle_collider_data(Entity entity)
 {
     remove(circle_collider_datas, entity);
+    circle_collider_data_removed = true;
+    spatial_query_broadphase_dirty = true;
 }
 
 
 void remove_line_collider_data(Entity entity)
 {
+    if (contains_key(line_collider_datas, entity) && line_collider_datas.at(entity).is_static)
+    {
+        invalidate_static_collider_data();
+    }
+
     remove(line_collider_datas, entity);
+    spatial_query_broadphase_dirty = true;
 }
 
 
 void remove_polygon_collider_data(Entity entity)
 {
+    if (contains_key(polygon_collider_datas, entity) && polygon_collider_datas.at(entity).is_static)
+    {
+        invalidate_static_collider_data();
+    }
+
     remove(polygon_collider_datas, entity);
+    spatial_query_broadphase_dirty = true;
+}
+
+
+void invalidate_static_collider_data()
+{
+    static_collider_data_dirty = true;
+    spatial_query_broadphase_dirty = true;
+}
+
+
+void reset_collider_motion(Entity entity)
+{
+    const auto circle_data = circle_collider_datas.find(entity);
+
+    if (circle_data != circle_collider_datas.end())
+    {
+        circle_data->second.motion_reset = true;
+    }
+}
+
+
+void load_collision_layers(const vector<Collision_Layer> & collision_layers)
+{
+    // Add every layer before resolving masks, so masks can name layers loaded after them.
+    for (const Collision_Layer & collision_layer : collision_layers)
+    {
+        if (get_collision_layer_index(collision_layer.name) != -1)
+        {
+            continue;
+        }
+
+        if ((int)collision_layer_names.size() == MAX_COLLISION_LAYER_COUNT)
+        {
+            throw runtime_error(
+                "ERROR: can't load collision layer \"" + collision_layer.name + "\", only " +
+                to_string(MAX_COLLISION_LAYER_COUNT) + " collision layers are supported!");
+        }
+
+        collision_layer_names.push_back(collision_layer.name);
+        collision_layer_masks.push_back(~0u);
+    }
+
+    for (const Collision_Layer & collision_layer : collision_layers)
+    {
+        unsigned int & mask = collision_layer_masks[get_collision_layer_index(collision_layer.name)];
+        mask = 0;
+
+        for (const string & mask_layer_name : collision_layer.mask)
+        {
+            mask |= get_collision_layer(mask_layer_name);
+        }
+    }
+}
+
+
+unsigned int get_collision_layer(const string & name)
+{
+    const int index = get_collision_layer_index(name);
+
+    if (index == -1)
+    {
+        throw runtime_error("ERROR: no collision layer named \"" + name + "\" has been loaded!");
+    }
+
+    return 1u << index;
+}
+
+
+unsigned int get_default_collision_mask(unsigned int layer)
+{
+    unsigned int mask = 0;
+
+    for (int i = 0; i < MAX_COLLISION_LAYER_COUNT; i++)
+    {
+        if (layer & (1u << i))
+        {
+            mask |= i < (int)collision_layer_masks.size() ? collision_layer_masks[i] : ~0u;
+        }
+    }
+
+    return mask;
+}
+
+
+void set_broadphase_mode(Broadphase_Modes mode)
+{
+    broadphase_mode = mode;
+    spatial_query_broadphase_dirty = true;
+}
+
+
+void set_physics_worker_count(int count)
+{
+    if (count < 0)
+    {
+        throw runtime_error("ERROR: physics worker count must not be negative!");
+    }
+
+    physics_worker_count = count;
+}
+
+
+void set_sleeping_enabled(bool enabled)
+{
+    sleeping_enabled = enabled;
+}
+
+
+void set_max_continuous_displacement(float distance)
+{
+    if (distance < 0.0f)
+    {
+        throw runtime_error("ERROR: max continuous displacement must not be negative!");
+    }
+
+    max_continuous_displacement = distance;
+}
+
+
+const Physics_Stats & get_physics_stats()
+{
+    return physics_stats;
+}
+
+
+Raycast_Hit raycast(const Raycast_Query & query)
+{
+    Raycast_Hit raycast_hit;
+    prepare_spatial_queries();
+    cast_ray(narrow_phase_contexts[0], query, raycast_hit);
+    return raycast_hit;
+}
+
+
+void raycast(const vector<Raycast_Query> & queries, vector<Raycast_Hit> & hits)
+{
+    run_spatial_queries(queries, hits, cast_ray);
+}
+
+
+vector<Entity> overlap_circle(const Overlap_Circle_Query & query)
+{
+    vector<Entity> entities;
+    prepare_spatial_queries();
+    find_circle_overlaps(narrow_phase_contexts[0], query, entities);
+    return entities;
+}
+
+
+void overlap_circle(const vector<Overlap_Circle_Query> & queries, vector<vector<Entity>> & results)
+{
+    run_spatial_queries(queries, results, find_circle_overlaps);
+}
+
+
+vector<Entity> overlap_aabb(const Overlap_AABB_Query & query)
+{
+    vector<Entity> entities;
+    prepare_spatial_queries();
+    find_aabb_overlaps(narrow_phase_contexts[0], query, entities);
+    return entities;
+}
+
+
+void overlap_aabb(const vector<Overlap_AABB_Query> & queries, vector<vector<Entity>> & results)
+{
+    run_spatial_queries(queries, results, find_aabb_overlaps);
+}
+
+
+Nearest_Result nearest(const Nearest_Query & query)
+{
+    Nearest_Result nearest_result;
+    prepare_spatial_queries();
+    find_nearest(narrow_phase_contexts[0], query, nearest_result);
+    return nearest_result;
+}
+
+
+void nearest(const vector<Nearest_Query> & queries, vector<Nearest_Result> & results)
+{
+    run_spatial_queries(queries, results, find_nearest);
 }
 
 
 void physics_api_update()
 {
-    map<Entity, Collision_Events> collision_events;
+    physics_stats = { 0.0f, 0.0f, 0 };
+
+
+    // Static colliders don't move between passes, so they only need to be re-baked once per frame at most.
+    if (static_collider_data_dirty)
+    {
+        bake_static_collider_data();
+    }
+
+
+    // Keep the last update's collisions between colliders that won't be checked since they are asleep or static.
+    update_sleeping_islands();
+    int kept_collision_record_count = 0;
+
+    for (Collision_Record & collision_record : collision_records)
+    {
+        if (keep_sleeping_collision(collision_record))
+        {
+            collision_records[kept_collision_record_count++] = collision_record;
+        }
+    }
+
+    collision_records.resize(kept_collision_record_count);
 
 
     // Check for collisions and store collision events.
     for (int i = 0; i < PASS_COUNT; i++)
     {
-        check_collisions(collision_events);
+        check_collisions();
     }
 
 
+    // Circles that were disabled, moved or woken this update have to stay unchanged for another SLEEP_FRAME_COUNT
+    // updates to fall asleep. Colliders can't be loaded or removed during the update, so every circle is still in
+    // island_circle_datas.
+    for (Circle_Collider_Data * circle_data : island_circle_datas)
+    {
+        circle_data->still_frame_count =
+            *circle_data->enabled && !circle_collider_changed(*circle_data)
+            ? min(circle_data->still_frame_count + 1, SLEEP_FRAME_COUNT)
+            : 0;
+
+        store_circle_collider_state(*circle_data);
+    }
+
+    spatial_query_broadphase_dirty = true;
+
+
+    // Sort collisions by collider, dropping pairs found more than once, so handlers are triggered once per pair in
+    // entity order.
+    sort(collision_records.begin(), collision_records.end(), collision_record_less);
+
+    collision_records.erase(
+        unique(collision_records.begin(), collision_records.end(), collision_records_equal),
+        collision_records.end());
+
+
     // Trigger collision handlers for all collision events generated during collision detection.
-    for_each(collision_events, [](Entity collider_entity, const Collision_Events & collision_events) -> void
+    const int collision_record_count = collision_records.size();
+
+    for (int begin = 0, end = 0; begin < collision_record_count; begin = end)
     {
-        const Collision_Handler * source_collision_handler = collision_events.source_collision_handler;
-        const map<Entity, const Collision_Handler *> & collision_handlers = collision_events.collision_handlers;
+        const Entity collider_entity = collision_records[begin].entity;
+        const Collision_Handler * source_collision_handler = collision_records[begin].source_collision_handler;
+
+        while (end < collision_record_count && collision_records[end].entity == collider_entity)
+        {
+            end++;
+        }
 
 
         // Trigger source entity's collision handler if it is set.
         if (*source_collision_handler)
         {
-            for_each(collision_handlers, [&](
-                Entity collision_entity,
-                const Collision_Handler * /*collision_entity_handler*/) -> void
+            for (int i = begin; i < end; i++)
             {
-                (*source_collision_handler)(collision_entity);
-            });
+                (*source_collision_handler)(collision_records[i].collision_entity);
+            }
         }
 
 
         // Trigger all collision entities' collision handlers if they are set.
-        for_each(collision_handlers, [=](
-            Entity /*collision_entity*/,
-            const Collision_Handler * collision_entity_handler) -> void
+        for (int i = begin; i < end; i++)
         {
+            const Collision_Handler * collision_entity_handler = collision_records[i].collision_handler;
+
             if (*collision_entity_handler)
             {
                 (*collision_entity_handler)(collider_entity);
             }
-        });
-    });
+        }
+    }
+}
+
+
+void clean_physics()
+{
+    stop_narrow_phase_workers();
+    narrow_phase_contexts.clear();
 }
 
 
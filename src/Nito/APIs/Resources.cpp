@@ -3,18 +3,39 @@
 #include "Nito/APIs/Resources.hpp"
 
 #include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include <iterator>
 #include <SOIL.h>
 #include "Cpp_Utils/Collection.hpp"
 #include "Cpp_Utils/Map.hpp"
 #include "Cpp_Utils/File.hpp"
+#include "Cpp_Utils/String.hpp"
 
 #include "Nito/APIs/Graphics.hpp"
+#include "Nito/APIs/Assets.hpp"
 
 
 using std::string;
 using std::map;
 using std::vector;
 using std::runtime_error;
+using std::max;
+using std::queue;
+using std::thread;
+using std::mutex;
+using std::lock_guard;
+using std::unique_lock;
+using std::condition_variable;
+using std::move;
+using std::ifstream;
+using std::ios;
+using std::istreambuf_iterator;
 
 // glm/glm.hpp
 using glm::vec3;
@@ -32,98 +53,745 @@ using Cpp_Utils::contains_key;
 // Cpp_Utils/File.hpp
 using Cpp_Utils::platform_path;
 
+// Cpp_Utils/String.hpp
+using Cpp_Utils::to_string;
+
 
 namespace Nito
 {
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Texture_Decode_Request
+{
+    string path;
+    string format;
+};
+
+
+struct Decoded_Image
+{
+    string path;
+    unsigned char * data;
+    int width;
+    int height;
+
+    // Archived images point directly into the mapped asset archive, so they aren't freed after uploading.
+    bool archived;
+
+    // Compressed images keep their file's data, with the format and mip levels read from its header.
+    string compressed_format;
+    vector<char> compressed_data;
+    vector<Compressed_Texture_Level> compressed_levels;
+    string error;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Data
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static map<string, Texture> texture_configs;
 static map<string, Texture> textures;
 static map<string, Glyph> glyphs;
+static map<string, Font> fonts;
 static FT_Library ft;
+static const float INFINITE_DISTANCE = 1e20f;
+
+
+// Decode workers persist between loads, decoding requested images and pushing them to a completion queue. Only the main
+// thread has the OpenGL context, so it uploads images as they come off the queue, either while waiting on textures it
+// needs immediately or each update for textures being preloaded. Pending uploads are tracked by path, along with
+// whether they are asynchronous.
+static vector<thread> texture_decode_workers;
+static mutex texture_decode_mutex;
+static condition_variable texture_decode_request_condition;
+static condition_variable texture_decode_finish_condition;
+static queue<Texture_Decode_Request> texture_decode_requests;
+static queue<Decoded_Image> decoded_images;
+static map<string, bool> pending_texture_uploads;
+static bool stopping_texture_decode_workers = false;
+
+
+static const map<string, int> IMAGE_FORMATS
+{
+    { "rgba"       , SOIL_LOAD_RGBA },
+    { "rgb"        , SOIL_LOAD_RGB  },
+
+    // Pre-compressed DDS or KTX images, whose format is read from the file
+    { "compressed" , 0              },
+};
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
-// Interface
+// Utilities
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void init_freetype()
+static void transform_squared_distances(
+    vector<float> & grid,
+    int offset,
+    int stride,
+    int count,
+    vector<float> & samples,
+    vector<int> & parabola_vertices,
+    vector<float> & parabola_boundaries)
 {
-    if (FT_Init_FreeType(&ft))
+    // Source: Felzenszwalb & Huttenlocher, "Distance Transforms of Sampled Functions"
+
+    for (int i = 0; i < count; i++)
     {
-        throw runtime_error("FREETYPE ERROR: could not initialize FreeType!");
+        samples[i] = grid[offset + (i * stride)];
+    }
+
+    const auto get_parabola_intersection = [&](int q, int r) -> float
+    {
+        return ((samples[q] + (q * q)) - (samples[r] + (r * r))) / ((2 * q) - (2 * r));
+    };
+
+    int k = 0;
+    parabola_vertices[0] = 0;
+    parabola_boundaries[0] = -INFINITE_DISTANCE;
+    parabola_boundaries[1] = INFINITE_DISTANCE;
+
+    for (int q = 1; q < count; q++)
+    {
+        float intersection = get_parabola_intersection(q, parabola_vertices[k]);
+
+        while (intersection <= parabola_boundaries[k])
+        {
+            k--;
+            intersection = get_parabola_intersection(q, parabola_vertices[k]);
+        }
+
+        k++;
+        parabola_vertices[k] = q;
+        parabola_boundaries[k] = intersection;
+        parabola_boundaries[k + 1] = INFINITE_DISTANCE;
+    }
+
+    k = 0;
+
+    for (int q = 0; q < count; q++)
+    {
+        while (parabola_boundaries[k + 1] < q)
+        {
+            k++;
+        }
+
+        const int vertex = parabola_vertices[k];
+        grid[offset + (q * stride)] = ((q - vertex) * (q - vertex)) + samples[vertex];
     }
 }
 
 
-void load_textures(const JSON & texture_group)
+static vector<float> calculate_distances(const vector<bool> & features, int width, int height)
 {
-    static const map<string, int> IMAGE_FORMATS
+    const int max_dimension = width > height ? width : height;
+    vector<float> grid(features.size());
+    vector<float> samples(max_dimension);
+    vector<int> parabola_vertices(max_dimension);
+    vector<float> parabola_boundaries(max_dimension + 1);
+
+    for (auto i = 0u; i < features.size(); i++)
+    {
+        grid[i] = features[i] ? 0.0f : INFINITE_DISTANCE;
+    }
+
+
+    // Distance transforms are separable, so transform columns then rows.
+    for (int x = 0; x < width; x++)
     {
-        { "rgba" , SOIL_LOAD_RGBA },
-        { "rgb"  , SOIL_LOAD_RGB  },
+        transform_squared_distances(grid, x, width, height, samples, parabola_vertices, parabola_boundaries);
+    }
+
+    for (int y = 0; y < height; y++)
+    {
+        transform_squared_distances(grid, y * width, 1, width, samples, parabola_vertices, parabola_boundaries);
+    }
+
+    for (float & distance : grid)
+    {
+        distance = sqrtf(distance);
+    }
+
+    return grid;
+}
+
+
+static vector<unsigned char> generate_signed_distance_field(const FT_Bitmap & bitmap, int spread)
+{
+    // Pad the glyph bitmap by spread pixels on each side so distances outside the glyph's outline can be stored.
+    const int bitmap_width = bitmap.width;
+    const int bitmap_height = bitmap.rows;
+    const int width = bitmap_width + (spread * 2);
+    const int height = bitmap_height + (spread * 2);
+    vector<bool> inside_pixels(width * height, false);
+    vector<bool> outside_pixels(width * height, true);
+
+    for (int y = 0; y < bitmap_height; y++)
+    {
+        for (int x = 0; x < bitmap_width; x++)
+        {
+            const int index = ((y + spread) * width) + x + spread;
+            const bool inside = bitmap.buffer[(y * bitmap.pitch) + x] >= 128;
+            inside_pixels[index] = inside;
+            outside_pixels[index] = !inside;
+        }
+    }
+
+    const vector<float> inside_distances = calculate_distances(inside_pixels, width, height);
+    const vector<float> outside_distances = calculate_distances(outside_pixels, width, height);
+    vector<unsigned char> signed_distance_field(width * height);
+
+
+    // Map signed distances in [-spread, spread] to [1, 0], so 0.5 lies on the glyph's outline.
+    for (auto i = 0u; i < signed_distance_field.size(); i++)
+    {
+        const float signed_distance = inside_distances[i] - outside_distances[i];
+        float value = 0.5f - (signed_distance / (spread * 2.0f));
+
+        if (value < 0.0f)
+        {
+            value = 0.0f;
+        }
+        else if (value > 1.0f)
+        {
+            value = 1.0f;
+        }
+
+        signed_distance_field[i] = (unsigned char)(value * 255.0f);
+    }
+
+    return signed_distance_field;
+}
+
+
+static unsigned int read_uint32(const vector<char> & data, size_t offset)
+{
+    if (offset + 4 > data.size())
+    {
+        throw runtime_error("ERROR: unexpected end of compressed texture data!");
+    }
+
+    // Container headers are little-endian.
+    const auto bytes = (const unsigned char *)&data[offset];
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+
+static size_t get_compressed_level_size(const string & format, int width, int height)
+{
+    const size_t block_size = format == "bc1" || format == "bc1_rgb" ? 8 : 16;
+    return max((width + 3) / 4, 1) * max((height + 3) / 4, 1) * block_size;
+}
+
+
+static void read_dds_image(Decoded_Image & decoded_image)
+{
+    // DXGI formats for DX10 extended headers
+    static const map<unsigned int, string> DXGI_FORMATS
+    {
+        { 71 , "bc1" },
+        { 77 , "bc3" },
+        { 98 , "bc7" },
     };
 
+    static const map<string, string> FOUR_CC_FORMATS
+    {
+        { "DXT1" , "bc1" },
+        { "DXT5" , "bc3" },
+    };
 
-    const string format = texture_group["format"];
-    const vector<string> paths = texture_group["paths"];
+    const vector<char> & data = decoded_image.compressed_data;
 
+    if (data.size() < 128 || string(&data[0], 4) != "DDS ")
+    {
+        throw runtime_error("ERROR: invalid DDS header!");
+    }
 
-    // Populate texture group options.
-    map<string, string> options;
+    const string four_cc(&data[84], 4);
+    size_t offset = 128;
+    decoded_image.height = read_uint32(data, 12);
+    decoded_image.width = read_uint32(data, 16);
 
-    for_each(texture_group["options"], [&](const string & option_key, const string & option_value) -> void
+    if (four_cc == "DX10")
     {
-        options[option_key] = option_value;
-    });
+        const unsigned int dxgi_format = read_uint32(data, 128);
 
+        if (!contains_key(DXGI_FORMATS, dxgi_format))
+        {
+            throw runtime_error("ERROR: unsupported DXGI format " + to_string(dxgi_format) + "!");
+        }
 
-    // Load each texture for the texture group.
-    for (const string & path : paths)
+        decoded_image.compressed_format = DXGI_FORMATS.at(dxgi_format);
+        offset += 20;
+    }
+    else if (contains_key(FOUR_CC_FORMATS, four_cc))
     {
-        // Create and configure new texture.
-        Texture texture;
-        texture.format = format;
-        texture.options = options;
+        decoded_image.compressed_format = FOUR_CC_FORMATS.at(four_cc);
+    }
+    else
+    {
+        throw runtime_error("ERROR: unsupported DDS format \"" + four_cc + "\"!");
+    }
+
+
+    // Mip levels are stored back to back, each half the size of the previous level.
+    const int level_count = max((int)read_uint32(data, 28), 1);
+    int width = decoded_image.width;
+    int height = decoded_image.height;
+
+    for (int level = 0; level < level_count; level++)
+    {
+        const size_t size = get_compressed_level_size(decoded_image.compressed_format, width, height);
+
+        if (offset + size > data.size())
+        {
+            throw runtime_error("ERROR: unexpected end of DDS data!");
+        }
+
+        decoded_image.compressed_levels.push_back({ width, height, offset, size });
+        offset += size;
+        width = max(width / 2, 1);
+        height = max(height / 2, 1);
+    }
+}
+
+
+static void read_ktx_image(Decoded_Image & decoded_image)
+{
+    static const char KTX_IDENTIFIER[12] { '\xAB', 'K', 'T', 'X', ' ', '1', '1', '\xBB', '\r', '\n', '\x1A', '\n' };
+    static const unsigned int KTX_ENDIANNESS = 0x04030201;
+
+    // Opaque BC1 data is kept as such, since uploading it as BC1 with alpha would make some of its blocks transparent.
+    static const map<unsigned int, string> GL_INTERNAL_FORMATS
+    {
+        { GL_COMPRESSED_RGB_S3TC_DXT1_EXT  , "bc1_rgb" },
+        { GL_COMPRESSED_RGBA_S3TC_DXT1_EXT , "bc1" },
+        { GL_COMPRESSED_RGBA_S3TC_DXT5_EXT , "bc3" },
+        { GL_COMPRESSED_RGBA_BPTC_UNORM    , "bc7" },
+    };
+
+    const vector<char> & data = decoded_image.compressed_data;
+
+    if (data.size() < 64 || string(&data[0], 12) != string(KTX_IDENTIFIER, 12))
+    {
+        throw runtime_error("ERROR: invalid KTX header!");
+    }
+
+    if (read_uint32(data, 12) != KTX_ENDIANNESS)
+    {
+        throw runtime_error("ERROR: big-endian KTX data is not supported!");
+    }
+
+    const unsigned int internal_format = read_uint32(data, 28);
+
+    if (!contains_key(GL_INTERNAL_FORMATS, internal_format))
+    {
+        throw runtime_error("ERROR: unsupported KTX internal format " + to_string(internal_format) + "!");
+    }
+
+    decoded_image.compressed_format = GL_INTERNAL_FORMATS.at(internal_format);
+    decoded_image.width = read_uint32(data, 36);
+    decoded_image.height = read_uint32(data, 40);
+
+
+    // Each mip level is prefixed with its size, and follows the key/value data after the header.
+    const int level_count = max((int)read_uint32(data, 56), 1);
+    size_t offset = 64 + read_uint32(data, 60);
+    int width = decoded_image.width;
+    int height = decoded_image.height;
+
+    for (int level = 0; level < level_count; level++)
+    {
+        const size_t size = read_uint32(data, offset);
+        offset += 4;
+
+        if (offset + size > data.size())
+        {
+            throw runtime_error("ERROR: unexpected end of KTX data!");
+        }
+
+        decoded_image.compressed_levels.push_back({ width, height, offset, size });
+        offset += (size + 3) & ~(size_t)3;
+        width = max(width / 2, 1);
+        height = max(height / 2, 1);
+    }
+}
+
 
+static bool has_extension(const string & path, const string & extension)
+{
+    return path.size() >= extension.size() &&
+           path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+
+static void read_compressed_image(const string & path, Decoded_Image & decoded_image)
+{
+    const Asset * asset = get_archived_asset(path);
+
+    if (asset != nullptr)
+    {
+        decoded_image.compressed_data.assign(asset->data, asset->data + asset->size);
+    }
+    else
+    {
+        ifstream image_file(platform_path(path), ios::binary);
+
+        if (!image_file)
+        {
+            throw runtime_error("ERROR: could not open compressed texture \"" + path + "\"!");
+        }
 
-        // Load texture data from image at path.
-        int image_width;
-        int image_height;
+        decoded_image.compressed_data.assign(istreambuf_iterator<char>(image_file), istreambuf_iterator<char>());
+    }
+
+    if (has_extension(path, ".dds"))
+    {
+        read_dds_image(decoded_image);
+    }
+    else if (has_extension(path, ".ktx"))
+    {
+        read_ktx_image(decoded_image);
+    }
+    else
+    {
+        throw runtime_error("ERROR: \"" + path + "\" is not a DDS or KTX file!");
+    }
+}
 
-        unsigned char * image_data = SOIL_load_image(
-            platform_path(path).c_str(),
-            &image_width,
-            &image_height,
+
+static void free_decoded_image(const Decoded_Image & decoded_image)
+{
+    if (!decoded_image.archived)
+    {
+        SOIL_free_image_data(decoded_image.data);
+    }
+}
+
+
+static Decoded_Image decode_image(const Texture_Decode_Request & request)
+{
+    Decoded_Image decoded_image;
+    decoded_image.path = request.path;
+    decoded_image.data = nullptr;
+    decoded_image.archived = false;
+    const Asset * asset = get_archived_asset(request.path);
+
+
+    // Errors can't be thrown from worker threads, so they are passed to the main thread to throw.
+    if (request.format == "compressed")
+    {
+        try
+        {
+            read_compressed_image(request.path, decoded_image);
+        }
+        catch (const runtime_error & error)
+        {
+            decoded_image.error = error.what();
+        }
+    }
+    else if (asset != nullptr && asset->type == Asset::Types::TEXTURE && asset->texture_format == request.format)
+    {
+        // Archived textures were decoded when packed, so they are uploaded straight from the archive.
+        decoded_image.data = (unsigned char *)asset->data;
+        decoded_image.width = asset->width;
+        decoded_image.height = asset->height;
+        decoded_image.archived = true;
+    }
+    else
+    {
+        decoded_image.data = SOIL_load_image(
+            platform_path(request.path).c_str(),
+            &decoded_image.width,
+            &decoded_image.height,
             nullptr,
-            IMAGE_FORMATS.at(texture.format));
+            IMAGE_FORMATS.at(request.format));
+    }
 
+    return decoded_image;
+}
+
+
+static void run_texture_decode_worker()
+{
+    while (true)
+    {
+        Texture_Decode_Request request;
 
-        // Load texture dimensions from image.
-        texture.dimensions =
         {
-            (float)image_width,
-            (float)image_height,
-            vec3(),
-        };
+            unique_lock<mutex> lock(texture_decode_mutex);
+
+            texture_decode_request_condition.wait(lock, []() -> bool
+            {
+                return stopping_texture_decode_workers || !texture_decode_requests.empty();
+            });
+
+            if (stopping_texture_decode_workers)
+            {
+                return;
+            }
+
+            request = move(texture_decode_requests.front());
+            texture_decode_requests.pop();
+        }
+
+        Decoded_Image decoded_image = decode_image(request);
+
+        {
+            lock_guard<mutex> lock(texture_decode_mutex);
+            decoded_images.push(move(decoded_image));
+        }
+
+        texture_decode_finish_condition.notify_all();
+    }
+}
+
+
+static void request_texture_decodes(const vector<string> & paths, bool async)
+{
+    for (const string & path : paths)
+    {
+        if (!contains_key(texture_configs, path))
+        {
+            throw runtime_error("ERROR: no texture with path \"" + path + "\" was registered with Resources API!");
+        }
+    }
+
+
+    // Start decode workers on the first load.
+    if (texture_decode_workers.empty())
+    {
+        const int worker_count = max((int)thread::hardware_concurrency(), 1);
+
+        for (int i = 0; i < worker_count; i++)
+        {
+            texture_decode_workers.emplace_back(run_texture_decode_worker);
+        }
+    }
+
+
+    // Textures that are already being decoded aren't requested again, but are uploaded synchronously if any request
+    // for them is synchronous.
+    {
+        lock_guard<mutex> lock(texture_decode_mutex);
+
+        for (const string & path : paths)
+        {
+            const auto pending_texture_upload = pending_texture_uploads.find(path);
+
+            if (pending_texture_upload != pending_texture_uploads.end())
+            {
+                pending_texture_upload->second = pending_texture_upload->second && async;
+                continue;
+            }
+
+            pending_texture_uploads[path] = async;
+            texture_decode_requests.push({ path, texture_configs.at(path).format });
+        }
+    }
+
+    texture_decode_request_condition.notify_all();
+}
+
+
+static bool pop_decoded_image(Decoded_Image & decoded_image, bool wait)
+{
+    unique_lock<mutex> lock(texture_decode_mutex);
+
+    if (wait)
+    {
+        texture_decode_finish_condition.wait(lock, []() -> bool
+        {
+            return !decoded_images.empty();
+        });
+    }
+    else if (decoded_images.empty())
+    {
+        return false;
+    }
+
+    decoded_image = move(decoded_images.front());
+    decoded_images.pop();
+    return true;
+}
+
+
+static void upload_decoded_image(const Decoded_Image & decoded_image)
+{
+    const string & path = decoded_image.path;
+    const bool async = pending_texture_uploads.at(path);
+    pending_texture_uploads.erase(path);
+
+    if (!decoded_image.error.empty())
+    {
+        throw runtime_error(decoded_image.error);
+    }
+
+
+    // Load texture dimensions from image, and the actual format of compressed images.
+    Texture texture = texture_configs.at(path);
+    const bool compressed = texture.format == "compressed";
+
+    texture.dimensions =
+    {
+        (float)decoded_image.width,
+        (float)decoded_image.height,
+        vec3(),
+    };
+
+    if (compressed)
+    {
+        texture.format = decoded_image.compressed_format;
+    }
+
+
+    // Track texture and pass its data to Graphics API.
+    textures[path] = texture;
+
+
+    // Load then free image data (async uploads copy the data before returning). Compressed images are loaded directly,
+    // as they are already small enough not to stall rendering.
+    if (compressed)
+    {
+        load_compressed_texture_data(
+            texture,
+            decoded_image.compressed_data,
+            decoded_image.compressed_levels,
+            path,
+            true);
+    }
+    else if (async)
+    {
+        load_texture_data_async(texture, decoded_image.data, path, true);
+    }
+    else
+    {
+        load_texture_data(texture, decoded_image.data, path, true);
+    }
+
+    free_decoded_image(decoded_image);
+}
+
+
+static void load_texture_paths(const vector<string> & paths, bool async)
+{
+    request_texture_decodes(paths, async);
+
+
+    // Upload images as they are decoded until none of the paths are pending, including images decoded for textures
+    // being preloaded in the meantime.
+    Decoded_Image decoded_image;
+
+    for (const string & path : paths)
+    {
+        while (contains_key(pending_texture_uploads, path))
+        {
+            pop_decoded_image(decoded_image, true);
+            upload_decoded_image(decoded_image);
+        }
+    }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Interface
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void init_freetype()
+{
+    if (FT_Init_FreeType(&ft))
+    {
+        throw runtime_error("FREETYPE ERROR: could not initialize FreeType!");
+    }
+}
+
 
+void register_textures(const vector<JSON> & texture_groups)
+{
+    for (const JSON & texture_group : texture_groups)
+    {
+        const string format = texture_group["format"];
+        const bool mipmaps = contains_key(texture_group, "mipmaps") ? texture_group["mipmaps"].get<bool>() : false;
+        Texture::Options options;
 
-        // Track texture and pass its data to Graphics API.
-        textures[path] = texture;
+        if (!contains_key(IMAGE_FORMATS, format))
+        {
+            throw runtime_error("ERROR: \"" + format + "\" is not a valid texture format!");
+        }
 
+        for_each(texture_group["options"], [&](const string & option_key, const string & option_value) -> void
+        {
+            options[option_key] = option_value;
+        });
 
-        // Load then free image data.
-        load_texture_data(texture, image_data, path);
-        SOIL_free_image_data(image_data);
+        for (const string & path : texture_group["paths"].get<vector<string>>())
+        {
+            Texture & texture = texture_configs[path];
+            texture.format = format;
+            texture.options = options;
+            texture.mipmaps = mipmaps;
+        }
     }
 }
 
 
+void load_textures(const vector<JSON> & texture_groups, bool async)
+{
+    // Register then load the textures from all groups together so they can be decoded in parallel.
+    vector<string> paths;
+    register_textures(texture_groups);
+
+    for (const JSON & texture_group : texture_groups)
+    {
+        for (const string & path : texture_group["paths"].get<vector<string>>())
+        {
+            paths.push_back(path);
+        }
+    }
+
+    load_texture_paths(paths, async);
+}
+
+
+void load_texture(const string & path, bool async)
+{
+    load_texture_paths({ path }, async);
+}
+
+
+void preload_texture(const string & path)
+{
+    request_texture_decodes({ path }, true);
+}
+
+
+bool is_texture_registered(const string & path)
+{
+    return contains_key(texture_configs, path);
+}
+
+
+bool is_texture_loaded(const string & path)
+{
+    return contains_key(textures, path);
+}
+
+
+bool is_texture_loading(const string & path)
+{
+    return contains_key(pending_texture_uploads, path);
+}
+
+
 void load_font(const JSON & config)
 {
     static const map<string, string> FONT_TEXTURE_OPTIONS
@@ -134,18 +802,46 @@ void load_font(const JSON & config)
         { "mag_filter" , "linear"        },
     };
 
+    static const int DEFAULT_SDF_SPREAD = 8;
+
 
     // Attempt to load font face.
     FT_Face face;
     const string font_face_path = config["path"];
+    const unsigned int font_height = config["height"];
+
+    const Asset * font_face_asset = get_archived_asset(font_face_path);
 
-    if (FT_New_Face(ft, font_face_path.c_str(), 0, &face))
+    const FT_Error font_face_error =
+        font_face_asset != nullptr
+        ? FT_New_Memory_Face(ft, (const FT_Byte *)font_face_asset->data, font_face_asset->size, 0, &face)
+        : FT_New_Face(ft, font_face_path.c_str(), 0, &face);
+
+    if (font_face_error)
     {
         throw runtime_error("FREETYPE ERROR: failed to load font face from \"" + font_face_path + "\"!");
     }
 
     // Setting the width to 0 lets the face dynamically calculate the width based on the given height.
-    FT_Set_Pixel_Sizes(face, 0, config["height"]);
+    FT_Set_Pixel_Sizes(face, 0, font_height);
+
+
+    // Determine whether glyphs should be rendered as coverage bitmaps or as signed distance fields.
+    const string mode = contains_key(config, "mode") ? config["mode"].get<string>() : "bitmap";
+
+    if (mode != "bitmap" && mode != "sdf")
+    {
+        throw runtime_error("ERROR: \"" + mode + "\" is not a valid font mode for \"" + font_face_path + "\"!");
+    }
+
+    const bool sdf = mode == "sdf";
+    const int spread = sdf ? (contains_key(config, "spread") ? config["spread"].get<int>() : DEFAULT_SDF_SPREAD) : 0;
+
+    fonts[font_face_path] =
+    {
+        font_height,
+        sdf,
+    };
 
 
     // Load ASCII characters.
@@ -161,10 +857,27 @@ void load_font(const JSON & config)
         Texture texture;
         texture.format = "r";
         texture.options = FONT_TEXTURE_OPTIONS;
+        texture.mipmaps = false;
         FT_GlyphSlot glyph = face->glyph;
         const FT_Bitmap & bitmap = glyph->bitmap;
+        const unsigned char * texture_data = bitmap.buffer;
         unsigned int width = bitmap.width;
         unsigned int height = bitmap.rows;
+        float left = glyph->bitmap_left;
+        float top = glyph->bitmap_top;
+        vector<unsigned char> signed_distance_field;
+
+
+        // Replace bitmap with its signed distance field for SDF fonts; glyphs without bitmaps (spaces) are left empty.
+        if (sdf && width != 0 && height != 0)
+        {
+            signed_distance_field = generate_signed_distance_field(bitmap, spread);
+            texture_data = &signed_distance_field[0];
+            width += spread * 2;
+            height += spread * 2;
+            left -= spread;
+            top += spread;
+        }
 
 
         // Calculate origin from glyph metrics.
@@ -172,12 +885,12 @@ void load_font(const JSON & config)
 
         if (width != 0)
         {
-            origin.x = -((float)glyph->bitmap_left / width);
+            origin.x = -(left / width);
         }
 
         if (height != 0)
         {
-            origin.y = -(((float)glyph->bitmap_top / height) - 1);
+            origin.y = -((top / height) - 1);
         }
 
         texture.dimensions =
@@ -198,13 +911,20 @@ void load_font(const JSON & config)
             vec2(glyph->bitmap_left, glyph->bitmap_top),
         };
 
-        load_texture_data(texture, bitmap.buffer, glyph_identifier);
+        load_texture_data(texture, texture_data, glyph_identifier);
     }
 }
 
 
 const Texture & get_loaded_texture(const string & path)
 {
+    // Registered textures are loaded on their first reference. Their dimensions are needed immediately, so this waits
+    // for their image to be decoded (unless they were preloaded), but they are still uploaded asynchronously.
+    if (!contains_key(textures, path) && contains_key(texture_configs, path))
+    {
+        load_texture(path, true);
+    }
+
     if (!contains_key(textures, path))
     {
         throw runtime_error("ERROR: no texture with path \"" + path + "\" was loaded by Resources API!");
@@ -225,4 +945,57 @@ const Glyph & get_loaded_glyph(const string & identifier)
 }
 
 
+const Font & get_loaded_font(const string & path)
+{
+    if (!contains_key(fonts, path))
+    {
+        throw runtime_error("ERROR: no font with path \"" + path + "\" was loaded by Resources API!");
+    }
+
+    return fonts.at(path);
+}
+
+
+void resources_api_update()
+{
+    // Upload preloaded textures whose images have been decoded, without waiting on the rest.
+    Decoded_Image decoded_image;
+
+    while (pop_decoded_image(decoded_image, false))
+    {
+        upload_decoded_image(decoded_image);
+    }
+}
+
+
+void clean_resources()
+{
+    {
+        lock_guard<mutex> lock(texture_decode_mutex);
+        stopping_texture_decode_workers = true;
+    }
+
+    texture_decode_request_condition.notify_all();
+
+    for (thread & worker : texture_decode_workers)
+    {
+        worker.join();
+    }
+
+    texture_decode_workers.clear();
+    stopping_texture_decode_workers = false;
+
+
+    // Free images that were decoded but never uploaded.
+    while (!decoded_images.empty())
+    {
+        free_decoded_image(decoded_images.front());
+        decoded_images.pop();
+    }
+
+    texture_decode_requests = queue<Texture_Decode_Request>();
+    pending_texture_uploads.clear();
+}
+
+
 } // namespace Nito
@@ -2,21 +2,38 @@
 
 #include <map>
 #include <stdexcept>
-#include "Cpp_Utils/File.hpp"
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <future>
+#include <chrono>
 #include "Cpp_Utils/Collection.hpp"
 #include "Cpp_Utils/Map.hpp"
 #include "Cpp_Utils/Vector.hpp"
 #include "Cpp_Utils/String.hpp"
-#include "Cpp_Utils/Fn.hpp"
+
+#include "Nito/APIs/Assets.hpp"
+#include "Nito/APIs/Resources.hpp"
 
 
 using std::string;
 using std::map;
 using std::vector;
 using std::runtime_error;
-
-// Cpp_Utils/File.hpp
-using Cpp_Utils::read_json_file;
+using std::ofstream;
+using std::ios;
+using std::size_t;
+using std::uint8_t;
+using std::uint32_t;
+using std::memcpy;
+using std::memcmp;
+using std::find;
+using std::future;
+using std::future_status;
+using std::async;
+using std::launch;
+using std::chrono::seconds;
 
 // Cpp_Utils/Collection.hpp
 using Cpp_Utils::for_each;
@@ -34,25 +51,80 @@ using Cpp_Utils::to_string;
 using Cpp_Utils::JSON;
 using Cpp_Utils::merge;
 
-// Cpp_Utils/Fn.hpp
-using Cpp_Utils::transform;
-
 
 namespace Nito
 {
 
 
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+struct Compiled_Component
+{
+    uint32_t entity_index;
+    uint8_t layout;
+    vector<char> data;
+};
+
+
+// Components compiled with a fixed layout keep it as compiled_data, and are constructed by their type's compiled
+// component reader rather than their allocator.
+struct Staged_Component
+{
+    unsigned int entity_index;
+    string type;
+    JSON data;
+    bool compiled;
+    vector<char> compiled_data;
+};
+
+
+struct Staged_Scene
+{
+    string name;
+    unsigned int entity_count;
+    vector<Staged_Component> components;
+    vector<vector<string>> entity_systems;
+
+    // Paths referenced by components' "texture_path" properties (or properties ending in it, like
+    // "hover_texture_path"), which are preloaded before the scene is instantiated. Compiled scenes store them, as their
+    // fixed-layout components aren't JSON.
+    vector<string> texture_paths;
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Data
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Compiled scene layout:
+//     header:     magic (8 bytes), version (u32), entity count (u32)
+//     systems:    system count (u32), then each system's name
+//     textures:   texture path count (u32), then each texture path
+//     components: component type count (u32), then per type: name, component count (u32), and per component: entity
+//                 index (u32), layout (u8), data size (u32), then data in the component type's fixed layout or as CBOR
+//     entities:   per entity: system count (u32), then indexes into the system names (u32) in subscription order
+// Strings are stored as their size (u32) followed by their characters.
+static const char COMPILED_SCENE_MAGIC[8] { 'N', 'I', 'T', 'O', 'S', 'C', 'N', 'E' };
+static const uint32_t COMPILED_SCENE_VERSION = 2;
+static const uint8_t CBOR_COMPONENT_LAYOUT = 0;
+static const uint8_t FIXED_COMPONENT_LAYOUT = 1;
+
+
 static string scene_to_load = "";
+static bool scene_to_load_async = false;
+static future<Staged_Scene> staging_scene;
+static Staged_Scene preloading_scene;
+static bool scene_preloading = false;
 static map<string, string> scenes;
 static map<string, JSON> blueprints;
 static map<string, vector<string>> system_requirements;
 static map<string, vector<string>> component_requirements;
 static map<string, Scene_Load_Handler> scene_load_handlers;
+static map<string, Compiled_Component_Handlers> compiled_component_handlers;
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -88,7 +160,10 @@ static void add_components(Entity entity, const JSON & entity_data, vector<strin
 }
 
 
-static void subscribe_to_systems(Entity entity, const JSON & entity_data, const vector<string> & entity_component_list)
+static vector<string> resolve_entity_systems(
+    Entity entity,
+    const JSON & entity_data,
+    const vector<string> & entity_component_list)
 {
     vector<string> entity_systems;
 
@@ -118,7 +193,7 @@ static void subscribe_to_systems(Entity entity, const JSON & entity_data, const
     }
 
 
-    // Validate all system and component requirements are met for all entity systems, then subscribe entity to them.
+    // Validate all system and component requirements are met for all entity systems.
     for (const string & system_name : entity_systems)
     {
         // Defining components required by a system is optional, so make sure requirements are defined before
@@ -127,68 +202,367 @@ static void subscribe_to_systems(Entity entity, const JSON & entity_data, const
         {
             for (const string & required_component : system_requirements[system_name])
             {
-                if (!has_component(entity, required_component))
+                if (!contains(entity_component_list, required_component))
                 {
                     throw runtime_error(
                         get_system_requirement_message(entity, system_name, required_component, "component"));
                 }
             }
         }
+    }
 
+    return entity_systems;
+}
 
-        // If entity meets all system and component requirements for this system, subscribe entity to it.
+
+static void subscribe_to_systems(Entity entity, const JSON & entity_data, const vector<string> & entity_component_list)
+{
+    for (const string & system_name : resolve_entity_systems(entity, entity_data, entity_component_list))
+    {
         subscribe_to_system(entity, system_name);
     }
 }
 
 
-static void load_scene(const string & name)
+template<typename T>
+static void write_value(ofstream & compiled_scene_file, T value)
 {
-    if (!scene_exists(name))
+    compiled_scene_file.write((const char *)&value, sizeof(value));
+}
+
+
+static void write_string(ofstream & compiled_scene_file, const string & value)
+{
+    write_value<uint32_t>(compiled_scene_file, value.size());
+    compiled_scene_file.write(value.data(), value.size());
+}
+
+
+static void check_compiled_scene_size(size_t offset, size_t read_size, size_t size)
+{
+    if (offset + read_size > size)
     {
-        throw runtime_error("ERROR: no scene named \"" + name + "\" was set in the Scene API!");
+        throw runtime_error("ERROR: unexpected end of compiled scene!");
     }
+}
 
 
-    // Delete any existing entity data before loading entity data from scene.
-    delete_all_entities();
+// Components are compiled to their type's fixed layout where possible, falling back to CBOR.
+static Compiled_Component compile_component(uint32_t entity_index, const string & type, const JSON & data)
+{
+    Compiled_Component compiled_component { entity_index, FIXED_COMPONENT_LAYOUT, {} };
+
+    if (!contains_key(compiled_component_handlers, type) ||
+        !compiled_component_handlers.at(type).writer(data, compiled_component.data))
+    {
+        const vector<uint8_t> cbor_data = JSON::to_cbor(data);
+        compiled_component.layout = CBOR_COMPONENT_LAYOUT;
+        compiled_component.data.assign(cbor_data.begin(), cbor_data.end());
+    }
 
+    return compiled_component;
+}
+
+
+static bool is_compiled_scene(const char * data, size_t size)
+{
+    return
+        size >= sizeof(COMPILED_SCENE_MAGIC) &&
+        memcmp(data, COMPILED_SCENE_MAGIC, sizeof(COMPILED_SCENE_MAGIC)) == 0;
+}
 
-    // Load entities.
-    const vector<JSON> scene_data = read_json_file(scenes.at(name));
 
-    const vector<Entity> entities = transform<Entity>(scene_data, [](const JSON & /*entity_data*/) -> Entity
+static bool is_texture_path_property(const string & key)
+{
+    static const string TEXTURE_PATH_SUFFIX = "texture_path";
+
+    return key.size() >= TEXTURE_PATH_SUFFIX.size() &&
+           key.compare(key.size() - TEXTURE_PATH_SUFFIX.size(), TEXTURE_PATH_SUFFIX.size(), TEXTURE_PATH_SUFFIX) == 0;
+}
+
+
+static void collect_texture_paths(const JSON & component_data, vector<string> & texture_paths)
+{
+    if (!component_data.is_object())
     {
-        return create_entity();
-    });
+        return;
+    }
+
+    for (auto property = component_data.begin(); property != component_data.end(); property++)
+    {
+        if (property->is_string() &&
+            is_texture_path_property(property.key()) &&
+            !contains(texture_paths, property->get<string>()))
+        {
+            texture_paths.push_back(property->get<string>());
+        }
+    }
+}
+
+
+static void stage_json_scene(const vector<JSON> & scene_data, Staged_Scene & staged_scene)
+{
+    staged_scene.entity_count = scene_data.size();
+
+    for (auto i = 0u; i < scene_data.size(); i++)
+    {
+        const JSON & entity_data = scene_data[i];
+        vector<string> entity_component_list;
+
+        // Defining components for an entity is optional.
+        if (contains_key(entity_data, "components"))
+        {
+            for_each(entity_data["components"], [&](const string & component_name, const JSON & data) -> void
+            {
+                staged_scene.components.push_back({ i, component_name, data, false, {} });
+                entity_component_list.push_back(component_name);
+                collect_texture_paths(data, staged_scene.texture_paths);
+            });
+        }
+
+        staged_scene.entity_systems.push_back(resolve_entity_systems(i, entity_data, entity_component_list));
+    }
+}
+
+
+static void stage_compiled_scene(const char * data, size_t size, Staged_Scene & staged_scene)
+{
+    size_t offset = sizeof(COMPILED_SCENE_MAGIC);
+
+    if (read_compiled_value<uint32_t>(data, size, offset) != COMPILED_SCENE_VERSION)
+    {
+        throw runtime_error("ERROR: compiled scene was compiled with an unsupported version!");
+    }
+
+    const uint32_t entity_count = read_compiled_value<uint32_t>(data, size, offset);
+    staged_scene.entity_count = entity_count;
+
+
+    // Load system names referenced by entity subscriptions.
+    const uint32_t system_count = read_compiled_value<uint32_t>(data, size, offset);
+    vector<string> system_names;
+
+    for (uint32_t i = 0; i < system_count; i++)
+    {
+        system_names.push_back(read_compiled_string(data, size, offset));
+    }
+
+
+    // Load texture paths referenced by components.
+    const uint32_t texture_path_count = read_compiled_value<uint32_t>(data, size, offset);
+
+    for (uint32_t i = 0; i < texture_path_count; i++)
+    {
+        staged_scene.texture_paths.push_back(read_compiled_string(data, size, offset));
+    }
+
+
+    // Components are stored one type at a time, so each component allocator runs over all of its components together.
+    const uint32_t component_type_count = read_compiled_value<uint32_t>(data, size, offset);
+
+    for (uint32_t i = 0; i < component_type_count; i++)
+    {
+        const string component_name = read_compiled_string(data, size, offset);
+        const uint32_t component_count = read_compiled_value<uint32_t>(data, size, offset);
+
+        for (uint32_t j = 0; j < component_count; j++)
+        {
+            const uint32_t entity_index = read_compiled_value<uint32_t>(data, size, offset);
+            const uint8_t layout = read_compiled_value<uint8_t>(data, size, offset);
+            const uint32_t data_size = read_compiled_value<uint32_t>(data, size, offset);
+            check_compiled_scene_size(offset, data_size, size);
+
+            if (entity_index >= entity_count)
+            {
+                throw runtime_error("ERROR: compiled scene component references an entity outside of the scene!");
+            }
+
+
+            // Fixed-layout components are kept as they are, to be constructed directly when the scene is instantiated.
+            const char * component_data = data + offset;
+
+            if (layout == FIXED_COMPONENT_LAYOUT)
+            {
+                staged_scene.components.push_back(
+                    {
+                        entity_index,
+                        component_name,
+                        JSON(),
+                        true,
+                        vector<char>(component_data, component_data + data_size),
+                    });
+            }
+            else
+            {
+                staged_scene.components.push_back(
+                    {
+                        entity_index,
+                        component_name,
+                        JSON::from_cbor((const uint8_t *)component_data, (const uint8_t *)component_data + data_size),
+                        false,
+                        {},
+                    });
+            }
+
+            offset += data_size;
+        }
+    }
+
+
+    // Requirements were resolved and validated when the scene was compiled.
+    for (uint32_t i = 0; i < entity_count; i++)
+    {
+        const uint32_t entity_system_count = read_compiled_value<uint32_t>(data, size, offset);
+        vector<string> entity_systems;
+
+        for (uint32_t j = 0; j < entity_system_count; j++)
+        {
+            const uint32_t system_index = read_compiled_value<uint32_t>(data, size, offset);
+
+            if (system_index >= system_count)
+            {
+                throw runtime_error("ERROR: compiled scene subscription references an unknown system!");
+            }
+
+            entity_systems.push_back(system_names[system_index]);
+        }
+
+        staged_scene.entity_systems.push_back(entity_systems);
+    }
+}
+
+
+// Reads, parses and validates a scene without touching the ECS, so it is safe to run on a worker thread.
+static Staged_Scene stage_scene(const string & name, const string & path)
+{
+    Staged_Scene staged_scene;
+    staged_scene.name = name;
+
+
+    // Archived scenes are read directly from the mapped asset archive.
+    const Asset * asset = get_archived_asset(path);
+    const string scene_file = asset != nullptr ? "" : read_asset_file(path);
+    const char * data = asset != nullptr ? asset->data : scene_file.data();
+    const size_t size = asset != nullptr ? asset->size : scene_file.size();
+
+    if (is_compiled_scene(data, size))
+    {
+        stage_compiled_scene(data, size, staged_scene);
+    }
+    else
+    {
+        stage_json_scene(JSON::parse(data, data + size).get<vector<JSON>>(), staged_scene);
+    }
+
+    return staged_scene;
+}
+
+
+static Component read_compiled_component(const Staged_Component & component)
+{
+    if (!contains_key(compiled_component_handlers, component.type))
+    {
+        throw runtime_error(
+            "ERROR: no compiled component handlers were set for \"" + component.type + "\" components in the Scene "
+            "API!");
+    }
 
+    const vector<char> & compiled_data = component.compiled_data;
+    size_t offset = 0;
 
-    // Add components to entities.
-    map<Entity, vector<string>> entity_component_lists;
+    const Component compiled_component =
+        compiled_component_handlers.at(component.type).reader(compiled_data.data(), compiled_data.size(), offset);
 
-    for (auto i = 0u; i < entities.size(); i++)
+    if (offset != compiled_data.size())
     {
-        const Entity entity = entities[i];
-        add_components(entity, scene_data[i], entity_component_lists[entity]);
+        throw runtime_error("ERROR: compiled \"" + component.type + "\" component has unexpected data!");
     }
 
+    return compiled_component;
+}
+
+
+// Swaps the staged scene in for the current one. Component allocators and system subscribers may use APIs that aren't
+// thread-safe (Graphics, Resources, etc.), so this must run on the main thread.
+static void instantiate_staged_scene(const Staged_Scene & staged_scene)
+{
+    // Delete any existing entity data before loading entity data from scene.
+    delete_all_entities();
+
+    vector<Entity> entities;
 
-    // Subscribe entities to systems.
-    for (auto i = 0u; i < entities.size(); i++)
+    for (unsigned int i = 0; i < staged_scene.entity_count; i++)
     {
-        const Entity entity = entities[i];
-        subscribe_to_systems(entity, scene_data[i], entity_component_lists.at(entity));
+        entities.push_back(create_entity());
+    }
+
+    for (const Staged_Component & component : staged_scene.components)
+    {
+        if (component.compiled)
+        {
+            add_component(entities[component.entity_index], component.type, read_compiled_component(component));
+        }
+        else
+        {
+            add_component(entities[component.entity_index], component.type, component.data);
+        }
+    }
+
+    for (unsigned int i = 0; i < staged_scene.entity_count; i++)
+    {
+        for (const string & system_name : staged_scene.entity_systems[i])
+        {
+            subscribe_to_system(entities[i], system_name);
+        }
     }
 
 
     // Trigger scene-load handlers.
     for_each(scene_load_handlers, [&](const string & /*id*/, const Scene_Load_Handler & handler) -> void
     {
-        handler(name);
+        handler(staged_scene.name);
     });
 }
 
 
+// Starts loading the staged scene's registered textures in the background, so their images are decoded in parallel
+// rather than one at a time as components reference them. Fonts are all loaded at startup, so they are already
+// resident.
+static void preload_staged_scene_textures(const Staged_Scene & staged_scene)
+{
+    for (const string & texture_path : staged_scene.texture_paths)
+    {
+        if (is_texture_registered(texture_path) && !is_texture_loaded(texture_path))
+        {
+            preload_texture(texture_path);
+        }
+    }
+}
+
+
+static bool is_staged_scene_loading_textures(const Staged_Scene & staged_scene)
+{
+    for (const string & texture_path : staged_scene.texture_paths)
+    {
+        if (is_texture_loading(texture_path))
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static void validate_scene_exists(const string & name)
+{
+    if (!scene_exists(name))
+    {
+        throw runtime_error("ERROR: no scene named \"" + name + "\" was set in the Scene API!");
+    }
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Interface
@@ -233,15 +607,129 @@ void set_blueprints(const JSON & blueprints_data)
 }
 
 
+void compile_scene(const string & scene_path, const string & compiled_scene_path)
+{
+    // Without these every component would silently be stored as CBOR, and no entity's systems would be validated.
+    if (compiled_component_handlers.empty())
+    {
+        throw runtime_error(
+            "ERROR: can't compile scene \"" + scene_path + "\", no compiled component handlers have been set!");
+    }
+
+    if (system_requirements.empty() && component_requirements.empty())
+    {
+        throw runtime_error(
+            "ERROR: can't compile scene \"" + scene_path + "\", no system or component requirements have been set!");
+    }
+
+    const vector<JSON> scene_data = read_asset_json_file(scene_path);
+    map<string, vector<Compiled_Component>> component_groups;
+    vector<string> system_names;
+    vector<string> texture_paths;
+    vector<vector<uint32_t>> entity_system_indexes;
+
+
+    // Group components by type, and resolve each entity's systems so requirements are validated now rather than on
+    // every load.
+    for (auto i = 0u; i < scene_data.size(); i++)
+    {
+        const JSON & entity_data = scene_data[i];
+        vector<string> entity_component_list;
+        vector<uint32_t> system_indexes;
+
+        if (contains_key(entity_data, "components"))
+        {
+            for_each(entity_data["components"], [&](const string & component_name, const JSON & data) -> void
+            {
+                component_groups[component_name].push_back(compile_component(i, component_name, data));
+                entity_component_list.push_back(component_name);
+                collect_texture_paths(data, texture_paths);
+            });
+        }
+
+        for (const string & system_name : resolve_entity_systems(i, entity_data, entity_component_list))
+        {
+            if (!contains(system_names, system_name))
+            {
+                system_names.push_back(system_name);
+            }
+
+            const auto system_name_iterator = find(system_names.begin(), system_names.end(), system_name);
+            system_indexes.push_back(system_name_iterator - system_names.begin());
+        }
+
+        entity_system_indexes.push_back(system_indexes);
+    }
+
+
+    // Write compiled scene.
+    ofstream compiled_scene_file(compiled_scene_path, ios::binary | ios::trunc);
+
+    if (!compiled_scene_file)
+    {
+        throw runtime_error("ERROR: could not create compiled scene \"" + compiled_scene_path + "\"!");
+    }
+
+    compiled_scene_file.write(COMPILED_SCENE_MAGIC, sizeof(COMPILED_SCENE_MAGIC));
+    write_value<uint32_t>(compiled_scene_file, COMPILED_SCENE_VERSION);
+    write_value<uint32_t>(compiled_scene_file, scene_data.size());
+    write_value<uint32_t>(compiled_scene_file, system_names.size());
+
+    for (const string & system_name : system_names)
+    {
+        write_string(compiled_scene_file, system_name);
+    }
+
+    write_value<uint32_t>(compiled_scene_file, texture_paths.size());
+
+    for (const string & texture_path : texture_paths)
+    {
+        write_string(compiled_scene_file, texture_path);
+    }
+
+    write_value<uint32_t>(compiled_scene_file, component_groups.size());
+
+    for_each(component_groups, [&](const string & component_name, const vector<Compiled_Component> & components) -> void
+    {
+        write_string(compiled_scene_file, component_name);
+        write_value<uint32_t>(compiled_scene_file, components.size());
+
+        for (const Compiled_Component & component : components)
+        {
+            write_value<uint32_t>(compiled_scene_file, component.entity_index);
+            write_value<uint8_t>(compiled_scene_file, component.layout);
+            write_value<uint32_t>(compiled_scene_file, component.data.size());
+            compiled_scene_file.write(component.data.data(), component.data.size());
+        }
+    });
+
+    for (const vector<uint32_t> & system_indexes : entity_system_indexes)
+    {
+        write_value<uint32_t>(compiled_scene_file, system_indexes.size());
+
+        for (const uint32_t system_index : system_indexes)
+        {
+            write_value<uint32_t>(compiled_scene_file, system_index);
+        }
+    }
+
+    if (!compiled_scene_file)
+    {
+        throw runtime_error("ERROR: failed to write compiled scene \"" + compiled_scene_path + "\"!");
+    }
+}
+
+
 bool scene_exists(const string & name)
 {
     return contains_key(scenes, name);
 }
 
 
-void set_scene_to_load(const string & name)
+void set_scene_to_load(const string & name, bool async)
 {
     scene_to_load = name;
+    scene_to_load_async = async;
 }
 
 
@@ -249,9 +737,50 @@ void check_load_scene()
 {
     if (scene_to_load != "")
     {
-        load_scene(scene_to_load);
+        validate_scene_exists(scene_to_load);
+
+        // A newer request replaces any scene still being staged or preloaded, waiting for its worker to finish then
+        // discarding it.
+        scene_preloading = false;
+        preloading_scene = Staged_Scene();
+
+        if (scene_to_load_async)
+        {
+            staging_scene = async(launch::async, stage_scene, scene_to_load, scenes.at(scene_to_load));
+        }
+        else
+        {
+            staging_scene = future<Staged_Scene>();
+            const Staged_Scene staged_scene = stage_scene(scene_to_load, scenes.at(scene_to_load));
+            preload_staged_scene_textures(staged_scene);
+            instantiate_staged_scene(staged_scene);
+        }
+
         scene_to_load = "";
     }
+
+
+    // Preload the staged scene's textures once it is ready, then swap it in at the frame boundary once they have been
+    // decoded and uploaded, leaving the current scene running until then.
+    if (staging_scene.valid() && staging_scene.wait_for(seconds(0)) == future_status::ready)
+    {
+        preloading_scene = staging_scene.get();
+        scene_preloading = true;
+        preload_staged_scene_textures(preloading_scene);
+    }
+
+    if (scene_preloading && !is_staged_scene_loading_textures(preloading_scene))
+    {
+        scene_preloading = false;
+        instantiate_staged_scene(preloading_scene);
+        preloading_scene = Staged_Scene();
+    }
+}
+
+
+bool is_scene_loading()
+{
+    return scene_to_load != "" || staging_scene.valid() || scene_preloading;
 }
 
 
@@ -288,4 +817,41 @@ void set_scene_load_handler(const string & id, const Scene_Load_Handler & handle
 }
 
 
+void set_compiled_component_handlers(const string & type, const Compiled_Component_Handlers & handlers)
+{
+    compiled_component_handlers[type] = handlers;
+}
+
+
+void write_compiled_data(vector<char> & compiled_data, const void * value, size_t value_size)
+{
+    compiled_data.insert(compiled_data.end(), (const char *)value, (const char *)value + value_size);
+}
+
+
+void write_compiled_string(vector<char> & compiled_data, const string & value)
+{
+    write_compiled_value<uint32_t>(compiled_data, value.size());
+    compiled_data.insert(compiled_data.end(), value.begin(), value.end());
+}
+
+
+void read_compiled_data(const char * compiled_data, size_t size, size_t & offset, void * value, size_t value_size)
+{
+    check_compiled_scene_size(offset, value_size, size);
+    memcpy(value, compiled_data + offset, value_size);
+    offset += value_size;
+}
+
+
+string read_compiled_string(const char * compiled_data, size_t size, size_t & offset)
+{
+    const uint32_t string_size = read_compiled_value<uint32_t>(compiled_data, size, offset);
+    check_compiled_scene_size(offset, string_size, size);
+    const string value(compiled_data + offset, string_size);
+    offset += string_size;
+    return value;
+}
+
+
 } // namespace Nito
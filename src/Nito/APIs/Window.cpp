@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <stdexcept>
+#include <cstdio>
 #include <GLFW/glfw3.h>
 #include "Cpp_Utils/String.hpp"
 #include "Cpp_Utils/Map.hpp"
@@ -15,6 +16,7 @@ using std::runtime_error;
 
 // glm/glm.hpp
 using glm::vec3;
+using glm::max;
 
 // Cpp_Utils/String.hpp
 using Cpp_Utils::to_string;
@@ -39,6 +41,7 @@ static vector<Window_Created_Handler> window_created_handlers;
 static GLFWwindow * window;
 static float delta_time;
 static vec3 window_size;
+static int frame_count;
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -64,10 +67,23 @@ static void window_size_callback(GLFWwindow * /*window*/, int width, int height)
 // Interface
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-void init_glfw()
+void init_glfw(bool headless)
 {
     glfwSetErrorCallback(error_callback);
 
+
+    // The null platform doesn't connect to a display server, so the engine can run on machines without one. It was
+    // added in GLFW 3.4, so headless mode isn't available when built against older versions.
+    if (headless)
+    {
+#if GLFW_VERSION_MAJOR > 3 || GLFW_VERSION_MINOR >= 4
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+        throw runtime_error("ERROR: headless mode requires GLFW 3.4 or later!");
+#endif
+    }
+
+
     if (!glfwInit())
     {
         throw runtime_error("GLFW ERROR: failed to initialize GLFW!");
@@ -110,6 +126,19 @@ void create_window(const Window_Config & window_config)
     });
 
 
+    // Headless windows are never shown, and use an OSMesa context so rendering falls back to Mesa's software
+    // rasterizer.
+    if (window_config.headless)
+    {
+#if GLFW_VERSION_MAJOR > 3 || GLFW_VERSION_MINOR >= 4
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_OSMESA_CONTEXT_API);
+#else
+        throw runtime_error("ERROR: headless mode requires GLFW 3.4 or later!");
+#endif
+    }
+
+
     // Window creation
     int window_width = window_config.width;
     int window_height = window_config.height;
@@ -128,6 +157,7 @@ void create_window(const Window_Config & window_config)
 
     window_size.x = window_width;
     window_size.y = window_height;
+    frame_count = window_config.frame_count;
 
 
     // Window post-configuration
@@ -137,7 +167,9 @@ void create_window(const Window_Config & window_config)
     }
 
     glfwMakeContextCurrent(window);
-    glfwSwapInterval(SWAP_INTERVALS.at(window_config.refresh_rate));
+
+    // Don't throttle headless windows to a refresh rate so frame times reflect the work done each frame.
+    glfwSwapInterval(window_config.headless ? 0 : SWAP_INTERVALS.at(window_config.refresh_rate));
     glfwSetWindowSizeCallback(window, window_size_callback);
 
 
@@ -219,15 +251,39 @@ void run_window_loop(const Window_Loop_Callback & callback)
 {
     delta_time = 0.02f;
     // float frame_start_time = get_time();
+    int frame = 0;
+    float slowest_frame_time = 0.0f;
+    const float loop_start_time = get_time();
 
     while (!glfwWindowShouldClose(window))
     {
+        const float frame_start_time = get_time();
         glfwPollEvents();
         callback();
         glfwSwapBuffers(window);
+        slowest_frame_time = max(slowest_frame_time, get_time() - frame_start_time);
         // const float current_time = get_time();
         // delta_time = current_time - frame_start_time;
         // frame_start_time = current_time;
+
+        if (frame_count > 0 && ++frame >= frame_count)
+        {
+            close_window();
+        }
+    }
+
+
+    // Report frame times for runs with a fixed frame count.
+    if (frame_count > 0 && frame > 0)
+    {
+        const float total_time = get_time() - loop_start_time;
+
+        printf(
+            "%d frames in %f seconds (average frame: %f ms, slowest frame: %f ms)\n",
+            frame,
+            total_time,
+            (total_time / frame) * 1000.0f,
+            slowest_frame_time * 1000.0f);
     }
 }
 
@@ -8,6 +8,8 @@
 #include <map>
 #include <functional>
 #include <stdexcept>
+#include <cstddef>
+#include <cstdint>
 #include <glm/glm.hpp>
 #include "Cpp_Utils/JSON.hpp"
 #include "Cpp_Utils/File.hpp"
@@ -19,7 +21,9 @@
 
 #include "Nito/Components.hpp"
 #include "Nito/Collider_Component.hpp"
+#include "Nito/APIs/Assets.hpp"
 #include "Nito/APIs/Audio.hpp"
+#include "Nito/APIs/Debug_Draw.hpp"
 #include "Nito/APIs/ECS.hpp"
 #include "Nito/APIs/Graphics.hpp"
 #include "Nito/APIs/Input.hpp"
@@ -46,16 +50,17 @@ using std::vector;
 using std::map;
 using std::function;
 using std::runtime_error;
+using std::size_t;
+using std::uint8_t;
+using std::uint32_t;
 
 // glm/glm.hpp
 using glm::vec3;
 
 // Cpp_Utils/JSON.hpp
 using Cpp_Utils::JSON;
-using Cpp_Utils::read_json_file;
 
 // Cpp_Utils/File.hpp
-using Cpp_Utils::read_file;
 using Cpp_Utils::file_exists;
 using Cpp_Utils::directify;
 
@@ -85,8 +90,18 @@ namespace Nito
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 static const string DEFAULT_SCENE_NAME = "default";
+static const string ASSET_ARCHIVE_PATH = "resources.pak";
 static float time_scale;
 static vector<Update_Handler> update_handlers;
+static map<string, Broadphase_Modes> scene_broadphase_modes;
+
+
+static const map<string, Broadphase_Modes> BROADPHASE_MODES
+{
+    { "spatial_hash"    , Broadphase_Modes::SPATIAL_HASH    },
+    { "sweep_and_prune" , Broadphase_Modes::SWEEP_AND_PRUNE },
+    { "brute_force"     , Broadphase_Modes::BRUTE_FORCE     },
+};
 
 
 static const Component_Handlers TRANSFORM_COMPONENT_HANDLERS
@@ -151,15 +166,24 @@ static const Component_Handlers TRANSFORM_COMPONENT_HANDLERS
 static const vector<Update_Handler> ENGINE_UPDATE_HANDLERS
 {
     input_api_update,
+    resources_api_update,
     physics_api_update,
     ui_transform_update,
     local_transform_update,
+
+    // Should come after all update handlers that move entities, and before all update handlers that load render data so
+    // it can be culled against the camera's view.
+    camera_view_update,
+
     renderer_update,
     text_renderer_update,
     circle_collider_update,
     line_collider_update,
     polygon_collider_update,
 
+    // Should come after all update handlers that draw debug geometry (colliders, etc.).
+    debug_draw_api_update,
+
     // Should come after all update handlers that will affect renderable data (renderers, colliders, etc.).
     camera_update,
 };
@@ -233,6 +257,7 @@ static const map<string, const Component_Handlers> ENGINE_COMPONENT_HANDLERS
                     contains_key(data, "render") ? data["render"].get<bool>() : true,
                     data["texture_path"],
                     data["shader_pipeline_name"],
+                    contains_key(data, "static") ? data["static"].get<bool>() : false,
                 };
             },
             get_component_deallocator<Sprite>(),
@@ -352,6 +377,7 @@ static const map<string, const Component_Handlers> ENGINE_COMPONENT_HANDLERS
                     data["font"],
                     color,
                     data["value"],
+                    contains_key(data, "size") ? data["size"].get<float>() : 0.0f,
                 };
             },
             get_component_deallocator<Text>(),
@@ -369,12 +395,47 @@ static const map<string, const Component_Handlers> ENGINE_COMPONENT_HANDLERS
         {
             [](const JSON & data) -> Component
             {
+                // Layers and masks are either bitfields or collision layer names. Without a mask, the layer's default
+                // mask is used.
+                unsigned int layer = get_collision_layer("default");
+
+                if (contains_key(data, "layer"))
+                {
+                    const JSON & layer_data = data["layer"];
+                    layer = layer_data.is_string() ? get_collision_layer(layer_data) : layer_data.get<unsigned int>();
+                }
+
+                unsigned int mask = get_default_collision_mask(layer);
+
+                if (contains_key(data, "mask"))
+                {
+                    const JSON & mask_data = data["mask"];
+
+                    if (mask_data.is_array())
+                    {
+                        mask = 0;
+
+                        for (const string & mask_layer_name : mask_data.get<vector<string>>())
+                        {
+                            mask |= get_collision_layer(mask_layer_name);
+                        }
+                    }
+                    else
+                    {
+                        mask = mask_data.get<unsigned int>();
+                    }
+                }
+
                 return new Collider
                 {
                     contains_key(data, "render") ? data["render"].get<bool>() : false,
                     contains_key(data, "enabled") ? data["enabled"].get<bool>() : true,
                     contains_key(data, "send_collision") ? data["send_collision"].get<bool>() : false,
                     contains_key(data, "receives_collision") ? data["receives_collision"].get<bool>() : false,
+                    layer,
+                    mask,
+                    contains_key(data, "static") ? data["static"].get<bool>() : false,
+                    contains_key(data, "continuous") ? data["continuous"].get<bool>() : false,
                     {},
                 };
             },
@@ -458,11 +519,460 @@ static const map<string, const Component_Handlers> ENGINE_COMPONENT_HANDLERS
 };
 
 
+// Engine components are compiled by allocating them from their JSON data then writing their fields, so their defaults
+// are only resolved by their allocators.
+template<typename T>
+static Compiled_Component_Handlers get_compiled_component_handlers(
+    const string & type,
+    const function<void(const T &, vector<char> &)> & field_writer,
+    const function<T *(const char *, size_t, size_t &)> & field_reader)
+{
+    return
+    {
+        [=](const JSON & data, vector<char> & compiled_data) -> bool
+        {
+            const Component_Handlers & component_handlers = ENGINE_COMPONENT_HANDLERS.at(type);
+            const Component component = component_handlers.allocator(data);
+            field_writer(*(T *)component, compiled_data);
+            component_handlers.deallocator(component);
+            return true;
+        },
+        [=](const char * compiled_data, size_t size, size_t & offset) -> Component
+        {
+            return field_reader(compiled_data, size, offset);
+        },
+    };
+}
+
+
+static Compiled_Component_Handlers get_compiled_string_component_handlers(const string & type)
+{
+    return get_compiled_component_handlers<string>(
+        type,
+        [](const string & value, vector<char> & compiled_data) -> void
+        {
+            write_compiled_string(compiled_data, value);
+        },
+        [](const char * compiled_data, size_t size, size_t & offset) -> string *
+        {
+            return new string(read_compiled_string(compiled_data, size, offset));
+        });
+}
+
+
+static Compiled_Component_Handlers get_compiled_transform_component_handlers(const string & type)
+{
+    return get_compiled_component_handlers<Transform>(
+        type,
+        [](const Transform & transform, vector<char> & compiled_data) -> void
+        {
+            write_compiled_value(compiled_data, transform.position);
+            write_compiled_value(compiled_data, transform.scale);
+            write_compiled_value(compiled_data, transform.rotation);
+        },
+        [](const char * compiled_data, size_t size, size_t & offset) -> Transform *
+        {
+            // Braced initializers are evaluated in order, so fields are read in the order they were written.
+            return new Transform
+            {
+                read_compiled_value<vec3>(compiled_data, size, offset),
+                read_compiled_value<vec3>(compiled_data, size, offset),
+                read_compiled_value<float>(compiled_data, size, offset),
+            };
+        });
+}
+
+
+// Collision layers might not be loaded when scenes are compiled, so collider layers and masks are written as given, and
+// resolved when loaded like the collider allocator resolves them:
+//     layer: whether it's named (u8), then its name or bitfield (u32)
+//     mask:  0 (u8) for the layer's default mask, 1 then its bitfield (u32), or 2 then its layer names' count (u32) and
+//            names
+static const Compiled_Component_Handlers COLLIDER_COMPILED_COMPONENT_HANDLERS
+{
+    [](const JSON & data, vector<char> & compiled_data) -> bool
+    {
+        JSON flag_data = data;
+        flag_data.erase("layer");
+        flag_data.erase("mask");
+        const Component_Handlers & component_handlers = ENGINE_COMPONENT_HANDLERS.at("collider");
+        const Component component = component_handlers.allocator(flag_data);
+        const Collider & collider = *(Collider *)component;
+        write_compiled_value(compiled_data, collider.render);
+        write_compiled_value(compiled_data, collider.enabled);
+        write_compiled_value(compiled_data, collider.sends_collision);
+        write_compiled_value(compiled_data, collider.receives_collision);
+        write_compiled_value(compiled_data, collider.is_static);
+        write_compiled_value(compiled_data, collider.continuous);
+        component_handlers.deallocator(component);
+
+        const JSON layer_data = contains_key(data, "layer") ? data["layer"] : JSON("default");
+        write_compiled_value<uint8_t>(compiled_data, layer_data.is_string());
+
+        if (layer_data.is_string())
+        {
+            write_compiled_string(compiled_data, layer_data.get<string>());
+        }
+        else
+        {
+            write_compiled_value(compiled_data, layer_data.get<unsigned int>());
+        }
+
+        if (!contains_key(data, "mask"))
+        {
+            write_compiled_value<uint8_t>(compiled_data, 0);
+        }
+        else if (data["mask"].is_array())
+        {
+            const vector<string> mask_layer_names = data["mask"];
+            write_compiled_value<uint8_t>(compiled_data, 2);
+            write_compiled_value<uint32_t>(compiled_data, mask_layer_names.size());
+
+            for (const string & mask_layer_name : mask_layer_names)
+            {
+                write_compiled_string(compiled_data, mask_layer_name);
+            }
+        }
+        else
+        {
+            write_compiled_value<uint8_t>(compiled_data, 1);
+            write_compiled_value(compiled_data, data["mask"].get<unsigned int>());
+        }
+
+        return true;
+    },
+    [](const char * compiled_data, size_t size, size_t & offset) -> Component
+    {
+        auto collider = new Collider {};
+        collider->render = read_compiled_value<bool>(compiled_data, size, offset);
+        collider->enabled = read_compiled_value<bool>(compiled_data, size, offset);
+        collider->sends_collision = read_compiled_value<bool>(compiled_data, size, offset);
+        collider->receives_collision = read_compiled_value<bool>(compiled_data, size, offset);
+        collider->is_static = read_compiled_value<bool>(compiled_data, size, offset);
+        collider->continuous = read_compiled_value<bool>(compiled_data, size, offset);
+
+        collider->layer =
+            read_compiled_value<uint8_t>(compiled_data, size, offset)
+            ? get_collision_layer(read_compiled_string(compiled_data, size, offset))
+            : read_compiled_value<unsigned int>(compiled_data, size, offset);
+
+        const uint8_t mask_type = read_compiled_value<uint8_t>(compiled_data, size, offset);
+
+        if (mask_type == 0)
+        {
+            collider->mask = get_default_collision_mask(collider->layer);
+        }
+        else if (mask_type == 1)
+        {
+            collider->mask = read_compiled_value<unsigned int>(compiled_data, size, offset);
+        }
+        else
+        {
+            const uint32_t mask_layer_count = read_compiled_value<uint32_t>(compiled_data, size, offset);
+            collider->mask = 0;
+
+            for (uint32_t i = 0; i < mask_layer_count; i++)
+            {
+                collider->mask |= get_collision_layer(read_compiled_string(compiled_data, size, offset));
+            }
+        }
+
+        return collider;
+    },
+};
+
+
+static const map<string, const Compiled_Component_Handlers> ENGINE_COMPILED_COMPONENT_HANDLERS
+{
+    {
+        "transform",
+        get_compiled_transform_component_handlers("transform")
+    },
+    {
+        "local_transform",
+        get_compiled_transform_component_handlers("local_transform")
+    },
+    {
+        "ui_transform",
+        get_compiled_component_handlers<UI_Transform>(
+            "ui_transform",
+            [](const UI_Transform & ui_transform, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value(compiled_data, ui_transform.position);
+                write_compiled_value(compiled_data, ui_transform.anchor);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> UI_Transform *
+            {
+                return new UI_Transform
+                {
+                    read_compiled_value<vec3>(compiled_data, size, offset),
+                    read_compiled_value<vec3>(compiled_data, size, offset),
+                };
+            })
+    },
+    {
+        "sprite",
+        get_compiled_component_handlers<Sprite>(
+            "sprite",
+            [](const Sprite & sprite, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value(compiled_data, sprite.render);
+                write_compiled_string(compiled_data, sprite.texture_path);
+                write_compiled_string(compiled_data, sprite.shader_pipeline_name);
+                write_compiled_value(compiled_data, sprite.is_static);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Sprite *
+            {
+                return new Sprite
+                {
+                    read_compiled_value<bool>(compiled_data, size, offset),
+                    read_compiled_string(compiled_data, size, offset),
+                    read_compiled_string(compiled_data, size, offset),
+                    read_compiled_value<bool>(compiled_data, size, offset),
+                };
+            })
+    },
+    {
+        "id",
+        get_compiled_string_component_handlers("id")
+    },
+    {
+        "render_layer",
+        get_compiled_string_component_handlers("render_layer")
+    },
+    {
+        "camera",
+        get_compiled_component_handlers<Camera>(
+            "camera",
+            [](const Camera & camera, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value(compiled_data, camera.z_near);
+                write_compiled_value(compiled_data, camera.z_far);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Camera *
+            {
+                return new Camera
+                {
+                    read_compiled_value<float>(compiled_data, size, offset),
+                    read_compiled_value<float>(compiled_data, size, offset),
+                };
+            })
+    },
+    {
+        "dimensions",
+        get_compiled_component_handlers<Dimensions>(
+            "dimensions",
+            [](const Dimensions & dimensions, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value(compiled_data, dimensions.width);
+                write_compiled_value(compiled_data, dimensions.height);
+                write_compiled_value(compiled_data, dimensions.origin);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Dimensions *
+            {
+                return new Dimensions
+                {
+                    read_compiled_value<float>(compiled_data, size, offset),
+                    read_compiled_value<float>(compiled_data, size, offset),
+                    read_compiled_value<vec3>(compiled_data, size, offset),
+                };
+            })
+    },
+    {
+        "ui_mouse_event_handlers",
+        get_compiled_component_handlers<UI_Mouse_Event_Handlers>(
+            "ui_mouse_event_handlers",
+            [](const UI_Mouse_Event_Handlers & /*ui_mouse_event_handlers*/, vector<char> & /*compiled_data*/) -> void
+            {
+            },
+            [](const char * /*compiled_data*/, size_t /*size*/, size_t & /*offset*/) -> UI_Mouse_Event_Handlers *
+            {
+                return new UI_Mouse_Event_Handlers;
+            })
+    },
+    {
+        "button",
+        get_compiled_component_handlers<Button>(
+            "button",
+            [](const Button & button, vector<char> & compiled_data) -> void
+            {
+                write_compiled_string(compiled_data, button.hover_texture_path);
+                write_compiled_string(compiled_data, button.pressed_texture_path);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Button *
+            {
+                return new Button
+                {
+                    read_compiled_string(compiled_data, size, offset),
+                    read_compiled_string(compiled_data, size, offset),
+                    {},
+                };
+            })
+    },
+    {
+        "text",
+        get_compiled_component_handlers<Text>(
+            "text",
+            [](const Text & text, vector<char> & compiled_data) -> void
+            {
+                write_compiled_string(compiled_data, text.font);
+                write_compiled_value(compiled_data, text.color);
+                write_compiled_string(compiled_data, text.value);
+                write_compiled_value(compiled_data, text.size);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Text *
+            {
+                return new Text
+                {
+                    read_compiled_string(compiled_data, size, offset),
+                    read_compiled_value<vec3>(compiled_data, size, offset),
+                    read_compiled_string(compiled_data, size, offset),
+                    read_compiled_value<float>(compiled_data, size, offset),
+                };
+            })
+    },
+    {
+        "parent_id",
+        get_compiled_string_component_handlers("parent_id")
+    },
+    {
+        "collider",
+        COLLIDER_COMPILED_COMPONENT_HANDLERS
+    },
+    {
+        "circle_collider",
+        get_compiled_component_handlers<Circle_Collider>(
+            "circle_collider",
+            [](const Circle_Collider & circle_collider, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value(compiled_data, circle_collider.radius);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Circle_Collider *
+            {
+                return new Circle_Collider
+                {
+                    read_compiled_value<float>(compiled_data, size, offset),
+                };
+            })
+    },
+    {
+        "line_collider",
+        get_compiled_component_handlers<Line_Collider>(
+            "line_collider",
+            [](const Line_Collider & line_collider, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value(compiled_data, line_collider.begin);
+                write_compiled_value(compiled_data, line_collider.end);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Line_Collider *
+            {
+                return new Line_Collider
+                {
+                    read_compiled_value<vec3>(compiled_data, size, offset),
+                    read_compiled_value<vec3>(compiled_data, size, offset),
+                };
+            })
+    },
+    {
+        "polygon_collider",
+        get_compiled_component_handlers<Polygon_Collider>(
+            "polygon_collider",
+            [](const Polygon_Collider & polygon_collider, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value<uint32_t>(compiled_data, polygon_collider.points.size());
+
+                for (const vec3 & point : polygon_collider.points)
+                {
+                    write_compiled_value(compiled_data, point);
+                }
+
+                write_compiled_value(compiled_data, polygon_collider.wrap);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Polygon_Collider *
+            {
+                auto polygon_collider = new Polygon_Collider;
+                const uint32_t point_count = read_compiled_value<uint32_t>(compiled_data, size, offset);
+
+                for (uint32_t i = 0; i < point_count; i++)
+                {
+                    polygon_collider->points.push_back(read_compiled_value<vec3>(compiled_data, size, offset));
+                }
+
+                polygon_collider->wrap = read_compiled_value<bool>(compiled_data, size, offset);
+                return polygon_collider;
+            })
+    },
+    {
+        "light_source",
+        get_compiled_component_handlers<Light_Source>(
+            "light_source",
+            [](const Light_Source & light_source, vector<char> & compiled_data) -> void
+            {
+                write_compiled_value(compiled_data, light_source.intensity);
+                write_compiled_value(compiled_data, light_source.range);
+                write_compiled_value(compiled_data, light_source.color);
+                write_compiled_value(compiled_data, light_source.enabled);
+            },
+            [](const char * compiled_data, size_t size, size_t & offset) -> Light_Source *
+            {
+                return new Light_Source
+                {
+                    read_compiled_value<float>(compiled_data, size, offset),
+                    read_compiled_value<float>(compiled_data, size, offset),
+                    read_compiled_value<vec3>(compiled_data, size, offset),
+                    read_compiled_value<bool>(compiled_data, size, offset),
+                };
+            })
+    },
+};
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Utilities
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static string get_nito_path()
+{
+#if _WIN32
+    const char * env_nito_path = "nito";
+#elif __gnu_linux__
+    const char * env_nito_path = getenv("NITO_PATH");
+#endif
+
+
+    if (env_nito_path == nullptr)
+    {
+        throw runtime_error(
+            "ERROR: the environment variable NITO_PATH could not be found; please set an environment variable called "
+            "NITO_PATH to the root directory of your Nito installation!");
+    }
+
+    return directify(string(env_nito_path));
+}
+
+
+static void load_requirements(const string & root_path)
+{
+    // Load system requirements.
+    const string system_requirements_path = root_path + "resources/data/system_requirements.json";
+
+    if (asset_exists(system_requirements_path))
+    {
+        for_each(read_asset_json_file(system_requirements_path), set_system_requirements);
+    }
+
+
+    // Load component requirements.
+    const string component_requirements_path = root_path + "resources/data/component_requirements.json";
+
+    if (asset_exists(component_requirements_path))
+    {
+        for_each(read_asset_json_file(component_requirements_path), set_component_requirements);
+    }
+}
+
+
 static void load_resources(
     const string & root_path,
     const string & version_source,
@@ -471,9 +981,9 @@ static void load_resources(
     // Load render layers
     const string render_layers_path = root_path + "resources/configs/render_layers.json";
 
-    if (file_exists(render_layers_path))
+    if (asset_exists(render_layers_path))
     {
-        const JSON render_layers_config = read_json_file(render_layers_path);
+        const JSON render_layers_config = read_asset_json_file(render_layers_path);
 
         for (const JSON & render_layer : render_layers_config)
         {
@@ -482,12 +992,28 @@ static void load_resources(
     }
 
 
+    // Load collision layers.
+    const string collision_layers_path = root_path + "resources/configs/collision_layers.json";
+
+    if (asset_exists(collision_layers_path))
+    {
+        vector<Collision_Layer> collision_layers;
+
+        for (const JSON & collision_layer : read_asset_json_file(collision_layers_path))
+        {
+            collision_layers.push_back({ collision_layer["name"], collision_layer["mask"].get<vector<string>>() });
+        }
+
+        load_collision_layers(collision_layers);
+    }
+
+
     // Load shader pipelines.
     const string shader_pipelines_path = root_path + "resources/data/shader_pipelines.json";
 
-    if (file_exists(shader_pipelines_path))
+    if (asset_exists(shader_pipelines_path))
     {
-        const JSON shader_pipelines_data = read_json_file(shader_pipelines_path);
+        const JSON shader_pipelines_data = read_asset_json_file(shader_pipelines_path);
         vector<Shader_Pipeline> shader_pipelines;
 
         for (const JSON & shader_pipeline_data : shader_pipelines_data)
@@ -510,7 +1036,7 @@ static void load_resources(
                     shader_sources.push_back(vertex_attributes_source);
                 }
 
-                shader_sources.push_back(read_file(root_path + source_path));
+                shader_sources.push_back(read_asset_file(root_path + source_path));
             });
 
             shader_pipelines.push_back(shader_pipeline);
@@ -520,66 +1046,71 @@ static void load_resources(
     }
 
 
-    // Load system requirements.
-    const string system_requirements_path = root_path + "resources/data/system_requirements.json";
-
-    if (file_exists(system_requirements_path))
-    {
-        for_each(read_json_file(system_requirements_path), set_system_requirements);
-    }
-
-
-    // Load component requirements.
-    const string component_requirements_path = root_path + "resources/data/component_requirements.json";
-
-    if (file_exists(component_requirements_path))
-    {
-        for_each(read_json_file(component_requirements_path), set_component_requirements);
-    }
-
-
     // Load texture data.
     const string textures_path = root_path + "resources/data/textures.json";
 
-    if (file_exists(textures_path))
+    if (asset_exists(textures_path))
     {
-        for_each(read_json_file(textures_path).get<vector<JSON>>(), load_textures);
+        register_textures(read_asset_json_file(textures_path).get<vector<JSON>>());
     }
 
 
     // Load font data.
     const string fonts_path = root_path + "resources/data/fonts.json";
 
-    if (file_exists(fonts_path))
+    if (asset_exists(fonts_path))
     {
-        for_each(read_json_file(fonts_path).get<vector<JSON>>(), load_font);
+        for_each(read_asset_json_file(fonts_path).get<vector<JSON>>(), load_font);
     }
 
 
     // Load audio files.
     const string audio_files_path = root_path + "resources/data/audio_files.json";
 
-    if (file_exists(audio_files_path))
+    if (asset_exists(audio_files_path))
     {
-        for_each(read_json_file(audio_files_path).get<vector<string>>(), load_audio_file);
+        for_each(read_asset_json_file(audio_files_path).get<vector<string>>(), load_audio_file);
     }
 
 
     // Load scenes.
     const string scenes_path = root_path + "resources/data/scenes.json";
 
-    if (file_exists(scenes_path))
+    if (asset_exists(scenes_path))
     {
-        for_each(read_json_file(scenes_path), set_scene);
+        // Scenes are either a path, or an object with a path and the broadphase physics should use for that scene.
+        for_each(read_asset_json_file(scenes_path), [](const string & name, const JSON & scene_data) -> void
+        {
+            if (!scene_data.is_object())
+            {
+                set_scene(name, scene_data.get<string>());
+                return;
+            }
+
+            set_scene(name, scene_data["path"].get<string>());
+
+            if (contains_key(scene_data, "broadphase"))
+            {
+                const string broadphase = scene_data["broadphase"];
+
+                if (!contains_key(BROADPHASE_MODES, broadphase))
+                {
+                    throw runtime_error(
+                        "ERROR: scene \"" + name + "\" uses unknown broadphase \"" + broadphase + "\"!");
+                }
+
+                scene_broadphase_modes[name] = BROADPHASE_MODES.at(broadphase);
+            }
+        });
     }
 
 
     // Load blueprints.
     const string blueprints_path = root_path + "resources/data/blueprints.json";
 
-    if (file_exists(blueprints_path))
+    if (asset_exists(blueprints_path))
     {
-        set_blueprints(read_json_file(blueprints_path));
+        set_blueprints(read_asset_json_file(blueprints_path));
     }
 }
 
@@ -595,6 +1126,17 @@ void add_update_handler(const Update_Handler & update_handler)
 }
 
 
+void load_engine_scene_data()
+{
+    for_each(ENGINE_COMPILED_COMPONENT_HANDLERS, set_compiled_component_handlers);
+
+
+    // Load engine requirements first, then project requirements.
+    load_requirements(get_nito_path());
+    load_requirements("./");
+}
+
+
 int run_engine()
 {
     // Initialize time scale to 1.
@@ -602,21 +1144,7 @@ int run_engine()
 
 
     // Validate and load Nito installation root path from environment.
-#if _WIN32
-    const char * env_nito_path = "nito";
-#elif __gnu_linux__
-    const char * env_nito_path = getenv("NITO_PATH");
-#endif
-
-
-    if (env_nito_path == nullptr)
-    {
-        throw runtime_error(
-            "ERROR: the environment variable NITO_PATH could not be found; please set an environment variable called "
-            "NITO_PATH to the root directory of your Nito installation!");
-    }
-
-    const string NITO_PATH = directify(string(env_nito_path));
+    const string NITO_PATH = get_nito_path();
 
 
     // Load engine handlers.
@@ -643,13 +1171,28 @@ int run_engine()
     ui_mouse_event_dispatcher_init();
 
 
+    // Resources are read from the packed asset archive when one is shipped, falling back to loose files otherwise.
+    // Engine resources are archived relative to the Nito installation, wherever it is.
+    set_asset_root("nito", NITO_PATH);
+
+    if (file_exists(ASSET_ARCHIVE_PATH))
+    {
+        open_asset_archive(ASSET_ARCHIVE_PATH);
+    }
+
+
+    // Load the handlers and requirements scenes are compiled and validated with.
+    load_engine_scene_data();
+
+
     // Initalize 3rd-party libraries.
-    init_glfw();
+    const JSON window_config = read_asset_json_file("resources/configs/window.json");
+    const bool headless = contains_key(window_config, "headless") ? window_config["headless"].get<bool>() : false;
+    init_glfw(headless);
     init_freetype();
 
 
     // Create window.
-    const JSON window_config = read_json_file("resources/configs/window.json");
     map<string, int> window_hints;
 
     for_each(window_config["hints"], [&](const string & hint_key, const int hint_value) -> void
@@ -664,6 +1207,8 @@ int run_engine()
             window_config["title"],
             window_config["refresh_rate"],
             window_hints,
+            headless,
+            contains_key(window_config, "frame_count") ? window_config["frame_count"].get<int>() : 0,
         });
 
 
@@ -671,11 +1216,26 @@ int run_engine()
     init_glew();
 
 
+    // Headless windows have no display to present to, so render into an offscreen framebuffer instead.
+    if (headless)
+    {
+        create_offscreen_framebuffer(window_config["width"], window_config["height"]);
+    }
+
+
     // Initialize Graphics API.
-    const JSON opengl_config = read_json_file(NITO_PATH + "resources/configs/opengl.json");
+    const JSON opengl_config = read_asset_json_file(NITO_PATH + "resources/configs/opengl.json");
     const JSON clear_color = opengl_config["clear_color"];
     const JSON blending = opengl_config["blending"];
 
+    const string shader_cache_path =
+        contains_key(opengl_config, "shader_cache_path") ? opengl_config["shader_cache_path"].get<string>() : "";
+
+    const unsigned int texture_memory_budget =
+        contains_key(opengl_config, "texture_memory_budget")
+        ? opengl_config["texture_memory_budget"].get<unsigned int>()
+        : 0;
+
     configure_opengl(
         {
             opengl_config["pixels_per_unit"],
@@ -692,9 +1252,16 @@ int run_engine()
                 blending["source_factor"],
                 blending["destination_factor"],
             },
+            shader_cache_path,
+            texture_memory_budget,
         });
 
 
+    // Textures are loaded in the background when first used, and reloaded if used again after being evicted, so
+    // rendering isn't stalled while they are decoded and copied to the GPU.
+    set_texture_loader(preload_texture);
+
+
     // !!! MUST COME AFTER GRAPHICS ENGINE AND WINDOW INITIALIZATION !!!
     ui_transform_init();
 
@@ -722,44 +1289,10 @@ int run_engine()
     load_vertex_data(get_default_vertex_container_id(), default_vertex_data, default_index_data);
 
 
-    // Load circle collider vertex data.
-    const float PI = 3.14159;
-    vector<GLfloat> circle_collider_vertex_data;
-    vector<GLuint> circle_collider_index_data;
-    float radius = 0.5f;
-    int index = 0;
-
-    for (float angle = 0.0f; angle <= 2 * PI; angle += 0.25f)
-    {
-        circle_collider_vertex_data.push_back(radius * cos(angle));
-        circle_collider_vertex_data.push_back(radius * sin(angle));
-        circle_collider_vertex_data.push_back(0.0f);
-        circle_collider_vertex_data.push_back(0.0f);
-        circle_collider_vertex_data.push_back(0.0f);
-        circle_collider_index_data.push_back(index++);
-    }
-
-    circle_collider_index_data.push_back(0);
-    load_vertex_data("circle_collider", circle_collider_vertex_data, circle_collider_index_data);
-
-
-    // Load line collider vertex data.
-    const vector<GLfloat> line_collider_vertex_data
-    {
-        // Position       // UV
-        0.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        1.0f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.0f, 0.0f, 0.0f, 0.0f,
-        0.5f, 0.1f, 0.0f, 0.0f, 0.0f,
-    };
-
-    const vector<GLuint> line_collider_index_data { 0, 1, 2, 3 };
-    load_vertex_data("line_collider", line_collider_vertex_data, line_collider_index_data);
-
-
     // Load engine resources first, then project resources.
-    const string version_source = read_file(NITO_PATH + "resources/shaders/shared/version.glsl");
-    const string vertex_attributes_source = read_file(NITO_PATH + "resources/shaders/shared/vertex_attributes.glsl");
+    const string version_source = read_asset_file(NITO_PATH + "resources/shaders/shared/version.glsl");
+    const string vertex_attributes_source =
+        read_asset_file(NITO_PATH + "resources/shaders/shared/vertex_attributes.glsl");
     load_resources(NITO_PATH, version_source, vertex_attributes_source);
     load_resources("./", version_source, vertex_attributes_source);
 
@@ -774,6 +1307,16 @@ int run_engine()
     set_scene_to_load(DEFAULT_SCENE_NAME);
 
 
+    // Switch physics to the broadphase each scene was configured with.
+    set_scene_load_handler("engine", [](const string & scene_name) -> void
+    {
+        set_broadphase_mode(
+            contains_key(scene_broadphase_modes, scene_name)
+            ? scene_broadphase_modes[scene_name]
+            : Broadphase_Modes::SPATIAL_HASH);
+    });
+
+
     // Main loop
     run_window_loop([&]() -> void
     {
@@ -791,6 +1334,9 @@ int run_engine()
     destroy_graphics();
     terminate_glfw();
     clean_openal();
+    clean_physics();
+    clean_resources();
+    close_asset_archive();
 
 
     return 0;
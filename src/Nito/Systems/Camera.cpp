@@ -2,6 +2,7 @@
 
 #include <map>
 #include <stdexcept>
+#include <cmath>
 #include <glm/glm.hpp>
 
 #include "Nito/Components.hpp"
@@ -16,6 +17,11 @@ using std::runtime_error;
 
 // glm/glm.hpp
 using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+using glm::min;
+using glm::max;
+using glm::inverse;
 
 
 namespace Nito
@@ -30,6 +36,7 @@ namespace Nito
 static const Camera * entity_camera;
 static const Dimensions * entity_dimensions;
 static const Transform * entity_transform;
+static mat4 view_matrix;
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -69,7 +76,7 @@ void camera_unsubscribe(Entity /*entity*/)
 }
 
 
-void camera_update()
+void camera_view_update()
 {
     static const vec3 & window_size = get_window_size();
 
@@ -81,19 +88,53 @@ void camera_update()
     const float entity_width = window_size.x;
     const float entity_height = window_size.y;
 
+    view_matrix = calculate_view_matrix(
+        entity_width,
+        entity_height,
+        entity_dimensions->origin,
+        entity_transform->position,
+        entity_transform->scale,
+        entity_transform->rotation);
+
+
+    // Project the window's corners back into world space to get the bounds render data must overlap to be visible.
+    const mat4 inverse_view_matrix = inverse(view_matrix);
+    const float corners_x[] { 0.0f, entity_width };
+    const float corners_y[] { 0.0f, entity_height };
+    Render_Bounds view_bounds { vec3(INFINITY), vec3(-INFINITY) };
+
+    for (const float corner_x : corners_x)
+    {
+        for (const float corner_y : corners_y)
+        {
+            const vec4 world_corner = inverse_view_matrix * vec4(corner_x, corner_y, 0.0f, 1.0f);
+            const vec3 corner(world_corner.x, world_corner.y, 0.0f);
+            view_bounds.min = min(view_bounds.min, corner);
+            view_bounds.max = max(view_bounds.max, corner);
+        }
+    }
+
+    set_render_view_bounds(view_bounds);
+}
+
+
+void camera_update()
+{
+    static const vec3 & window_size = get_window_size();
+
+    if (!entity_subscribed())
+    {
+        return;
+    }
+
+    // View matrix was calculated by camera_view_update() earlier this frame.
     render(
         {
-            entity_width,
-            entity_height,
+            window_size.x,
+            window_size.y,
             entity_camera->z_near,
             entity_camera->z_far,
-            calculate_view_matrix(
-                entity_width,
-                entity_height,
-                entity_dimensions->origin,
-                entity_transform->position,
-                entity_transform->scale,
-                entity_transform->rotation),
+            view_matrix,
         });
 
     cleanup_rendering();
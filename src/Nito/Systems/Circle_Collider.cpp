@@ -1,26 +1,24 @@
 #include "Nito/Systems/Circle_Collider.hpp"
 
 #include <map>
-#include <string>
 #include <functional>
+#include <cmath>
 #include <glm/glm.hpp>
 #include "Cpp_Utils/Map.hpp"
 #include "Cpp_Utils/Collection.hpp"
 
 #include "Nito/Components.hpp"
 #include "Nito/Collider_Component.hpp"
-#include "Nito/Utilities.hpp"
 #include "Nito/APIs/Graphics.hpp"
+#include "Nito/APIs/Debug_Draw.hpp"
 #include "Nito/APIs/Physics.hpp"
 
 
 using std::map;
-using std::string;
 using std::function;
 
 // glm/glm.hpp
 using glm::vec3;
-using glm::vec4;
 
 // Cpp_Utils/Map.hpp
 using Cpp_Utils::remove;
@@ -78,6 +76,9 @@ void circle_collider_subscribe(Entity entity)
         &collider->sends_collision,
         &collider->receives_collision,
         &collider->enabled,
+        &collider->layer,
+        &collider->mask,
+        &collider->continuous,
         &circle_collider->radius,
         &transform->position,
         &transform->scale);
@@ -100,30 +101,21 @@ void circle_collider_update()
         // Render collider if flagged.
         if (entity_state.collider->render)
         {
-            static const string VERTEX_CONTAINER_ID("circle_collider");
-            static const float ROTATION = 0.0f;
-
             const Transform * entity_transform = entity_state.transform;
-            const float dimensional_size = entity_state.circle_collider->radius * pixels_per_unit * 2;
-            vec3 position = entity_transform->position;
-            position.z = -1.0f;
-
-            load_render_data(
-                {
-                    Render_Modes::LINE_STRIP,
-                    &Collider::LAYER_NAME,
-                    nullptr,
-                    &Collider::SHADER_PIPELINE_NAME,
-                    &VERTEX_CONTAINER_ID,
-                    &Collider::UNIFORMS,
-                    calculate_model_matrix(
-                        dimensional_size,
-                        dimensional_size,
-                        Collider::ORIGIN,
-                        position,
-                        entity_transform->scale,
-                        ROTATION)
-                });
+            const float radius = entity_state.circle_collider->radius * fabsf(entity_transform->scale.x);
+
+
+            // Don't submit circles outside the camera's view.
+            const vec3 scaled_position = entity_transform->position * pixels_per_unit;
+            const vec3 scaled_radius(radius * pixels_per_unit);
+            const Render_Bounds render_bounds { scaled_position - scaled_radius, scaled_position + scaled_radius };
+
+            if (!in_render_view(Collider::LAYER_NAME, render_bounds))
+            {
+                return;
+            }
+
+            draw_debug_circle(entity_transform->position, radius, Collider::COLOR);
         }
     });
 }
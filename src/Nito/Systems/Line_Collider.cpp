@@ -41,6 +41,10 @@ struct Line_Collider_State
     const Line_Collider * line_collider;
     vec3 world_begin;
     vec3 world_end;
+
+    // Transform the world positions of a static collider were last calculated with.
+    Transform static_transform;
+    bool static_transform_valid;
 };
 
 
@@ -64,6 +68,7 @@ void line_collider_subscribe(Entity entity)
     line_collider_state.transform = (Transform *)get_component(entity, "transform");
     line_collider_state.collider = collider;
     line_collider_state.line_collider = (Line_Collider *)get_component(entity, "line_collider");
+    line_collider_state.static_transform_valid = false;
 
     load_line_collider_data(
         entity,
@@ -71,6 +76,9 @@ void line_collider_subscribe(Entity entity)
         &collider->sends_collision,
         &collider->receives_collision,
         &collider->enabled,
+        &collider->layer,
+        &collider->mask,
+        collider->is_static,
         &line_collider_state.world_begin,
         &line_collider_state.world_end);
 }
@@ -93,9 +101,24 @@ void line_collider_update()
         vec3 & entity_world_end = entity_state.world_end;
 
 
-        // Update world begin and end positions for line collider.
-        entity_world_begin = get_child_world_position(entity_transform, entity_line_collider->begin);
-        entity_world_end = get_child_world_position(entity_transform, entity_line_collider->end);
+        // Update world begin and end positions for line collider. Static colliders are only updated when their
+        // transform changes, which also invalidates the Physics API's static geometry.
+        const bool is_static = entity_state.collider->is_static;
+
+        if (!is_static ||
+            !entity_state.static_transform_valid ||
+            !transforms_equal(entity_state.static_transform, *entity_transform))
+        {
+            entity_world_begin = get_child_world_position(entity_transform, entity_line_collider->begin);
+            entity_world_end = get_child_world_position(entity_transform, entity_line_collider->end);
+
+            if (is_static)
+            {
+                entity_state.static_transform = *entity_transform;
+                entity_state.static_transform_valid = true;
+                invalidate_static_collider_data();
+            }
+        }
 
 
         // Render collider if flagged.
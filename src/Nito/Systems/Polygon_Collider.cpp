@@ -46,6 +46,10 @@ struct Polygon_Collider_State
     const Polygon_Collider * polygon_collider;
     vector<vec3> line_begins;
     vector<vec3> line_ends;
+
+    // Transform the world positions of a static collider were last calculated with.
+    Transform static_transform;
+    bool static_transform_valid;
 };
 
 
@@ -71,6 +75,7 @@ void polygon_collider_subscribe(Entity entity)
     polygon_collider_state.transform = transform;
     polygon_collider_state.collider = collider;
     polygon_collider_state.polygon_collider = polygon_collider;
+    polygon_collider_state.static_transform_valid = false;
 
 
     // Populate line begin and end vectors.
@@ -91,6 +96,9 @@ void polygon_collider_subscribe(Entity entity)
         &collider->sends_collision,
         &collider->receives_collision,
         &collider->enabled,
+        &collider->layer,
+        &collider->mask,
+        collider->is_static,
         &line_begins,
         &line_ends,
         &transform->position);
@@ -117,16 +125,31 @@ void polygon_collider_update()
         const int point_count = points.size();
 
 
-        // Update world begin and end positions for each line in polygon collider.
-        for (int curr = 0, next = 1; curr < line_count; curr++, next++)
+        // Update world begin and end positions for each line in polygon collider. Static colliders are only updated
+        // when their transform changes, which also invalidates the Physics API's static geometry.
+        const bool is_static = entity_state.collider->is_static;
+
+        if (!is_static ||
+            !entity_state.static_transform_valid ||
+            !transforms_equal(entity_state.static_transform, *entity_transform))
         {
-            if (next >= point_count)
+            for (int curr = 0, next = 1; curr < line_count; curr++, next++)
             {
-                next = 0;
+                if (next >= point_count)
+                {
+                    next = 0;
+                }
+
+                line_begins[curr] = get_child_world_position(entity_transform, points[curr]);
+                line_ends[curr] = get_child_world_position(entity_transform, points[next]);
             }
 
-            line_begins[curr] = get_child_world_position(entity_transform, points[curr]);
-            line_ends[curr] = get_child_world_position(entity_transform, points[next]);
+            if (is_static)
+            {
+                entity_state.static_transform = *entity_transform;
+                entity_state.static_transform_valid = true;
+                invalidate_static_collider_data();
+            }
         }
 
 
@@ -1,9 +1,17 @@
 #include "Nito/Systems/Renderer.hpp"
 
 #include <map>
+#include <vector>
 #include <string>
+#include <tuple>
+#include <cmath>
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 #include "Cpp_Utils/Collection.hpp"
 #include "Cpp_Utils/Map.hpp"
+#include "Cpp_Utils/Vector.hpp"
+#include "Cpp_Utils/String.hpp"
 
 #include "Nito/Components.hpp"
 #include "Nito/Utilities.hpp"
@@ -11,13 +19,33 @@
 
 
 using std::map;
+using std::vector;
 using std::string;
+using std::tuple;
+using std::make_tuple;
+
+// glm/glm.hpp
+using glm::vec3;
+using glm::vec4;
+using glm::mat4;
+using glm::min;
+using glm::max;
+
+// glm/gtc/matrix_transform.hpp
+using glm::translate;
 
 // Cpp_Utils/Collection.hpp
 using Cpp_Utils::for_each;
 
 // Cpp_Utils/Map.hpp
 using Cpp_Utils::remove;
+using Cpp_Utils::contains_key;
+
+// Cpp_Utils/Vector.hpp
+using Cpp_Utils::sort;
+
+// Cpp_Utils/String.hpp
+using Cpp_Utils::to_string;
 
 
 namespace Nito
@@ -38,12 +66,198 @@ struct Renderer_State
 };
 
 
+struct Static_Batch
+{
+    string render_layer;
+    string texture_path;
+    string shader_pipeline_name;
+    string vertex_container_id;
+    mat4 model_matrix;
+    Render_Bounds render_bounds;
+    vector<GLfloat> vertex_data;
+    vector<GLuint> index_data;
+};
+
+
+// Static sprites are batched by render layer, texture path, shader pipeline name, depth and grid cell.
+using Static_Batch_Key = tuple<string, string, string, float, int, int>;
+
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // Data
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-static map<Entity, Renderer_State> entity_states;
+static const float STATIC_GRID_CELL_SIZE = 512.0f;
+static map<Entity, Renderer_State> dynamic_entity_states;
+static map<Entity, Renderer_State> static_entity_states;
+static vector<Static_Batch> static_batches;
+static bool static_batches_dirty = false;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Utilities
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static int get_grid_cell(float position)
+{
+    return (int)floorf(position / STATIC_GRID_CELL_SIZE);
+}
+
+
+static mat4 calculate_entity_model_matrix(const Renderer_State & entity_state)
+{
+    const Transform * entity_transform = entity_state.transform;
+    const Dimensions * entity_dimensions = entity_state.dimensions;
+
+    return calculate_model_matrix(
+        entity_dimensions->width,
+        entity_dimensions->height,
+        entity_dimensions->origin,
+        entity_transform->position,
+        entity_transform->scale,
+        entity_transform->rotation);
+}
+
+
+static Render_Bounds calculate_entity_render_bounds(const Renderer_State & entity_state)
+{
+    const Transform * entity_transform = entity_state.transform;
+    const Dimensions * entity_dimensions = entity_state.dimensions;
+
+    return calculate_render_bounds(
+        entity_dimensions->width,
+        entity_dimensions->height,
+        entity_dimensions->origin,
+        entity_transform->position,
+        entity_transform->scale,
+        entity_transform->rotation);
+}
+
+
+static void bake_static_batches()
+{
+    // Default vertex data for a sprite's quad (see run_engine()).
+    static const vec3 QUAD_CORNERS[]
+    {
+        vec3(0.0f, 0.0f, 0.0f),
+        vec3(0.0f, 1.0f, 0.0f),
+        vec3(1.0f, 1.0f, 0.0f),
+        vec3(1.0f, 0.0f, 0.0f),
+    };
+
+    static const GLuint QUAD_INDEXES[] { 0, 1, 2, 0, 2, 3 };
+
+
+    // Unload previously baked vertex data.
+    for (const Static_Batch & static_batch : static_batches)
+    {
+        unload_vertex_data(static_batch.vertex_container_id);
+    }
+
+    static_batches.clear();
+
+
+    // Sort static sprites in the same order render() draws them (furthest first), so they are baked into their batches
+    // in draw order.
+    vector<const Renderer_State *> sorted_entity_states;
+
+    for_each(static_entity_states, [&](Entity /*entity*/, const Renderer_State & entity_state) -> void
+    {
+        if (entity_state.sprite->render)
+        {
+            sorted_entity_states.push_back(&entity_state);
+        }
+    });
+
+    sort(sorted_entity_states, [](const Renderer_State * a, const Renderer_State * b) -> bool
+    {
+        return a->transform->position.z > b->transform->position.z;
+    });
+
+
+    // Transform each sprite's quad into world space and append it to its batch. Sprites in world-space layers are also
+    // batched by the grid cell containing their center, so batches can be culled against the camera's view.
+    map<Static_Batch_Key, Static_Batch> keyed_static_batches;
+    const float pixels_per_unit = get_pixels_per_unit();
+
+    for (const Renderer_State * entity_state : sorted_entity_states)
+    {
+        const Sprite * entity_sprite = entity_state->sprite;
+        const string & entity_render_layer = *entity_state->render_layer;
+        const float depth = entity_state->transform->position.z;
+        const Render_Bounds entity_render_bounds = calculate_entity_render_bounds(*entity_state);
+        int cell_x = 0;
+        int cell_y = 0;
+
+        if (is_world_render_layer(entity_render_layer))
+        {
+            cell_x = get_grid_cell((entity_render_bounds.min.x + entity_render_bounds.max.x) / 2.0f);
+            cell_y = get_grid_cell((entity_render_bounds.min.y + entity_render_bounds.max.y) / 2.0f);
+        }
+
+        const Static_Batch_Key key = make_tuple(
+            entity_render_layer,
+            entity_sprite->texture_path,
+            entity_sprite->shader_pipeline_name,
+            depth,
+            cell_x,
+            cell_y);
+
+        const bool new_static_batch = !contains_key(keyed_static_batches, key);
+        Static_Batch & static_batch = keyed_static_batches[key];
+
+        if (new_static_batch)
+        {
+            static_batch.render_layer = entity_render_layer;
+            static_batch.texture_path = entity_sprite->texture_path;
+            static_batch.shader_pipeline_name = entity_sprite->shader_pipeline_name;
+            static_batch.model_matrix = translate(mat4(), vec3(0.0f, 0.0f, depth * pixels_per_unit));
+            static_batch.render_bounds = entity_render_bounds;
+        }
+        else
+        {
+            static_batch.render_bounds.min = min(static_batch.render_bounds.min, entity_render_bounds.min);
+            static_batch.render_bounds.max = max(static_batch.render_bounds.max, entity_render_bounds.max);
+        }
+
+
+        // Depth is applied by the batch's model matrix, so baked vertices are flattened to z = 0.
+        const mat4 entity_model_matrix = calculate_entity_model_matrix(*entity_state);
+        vector<GLfloat> & vertex_data = static_batch.vertex_data;
+        vector<GLuint> & index_data = static_batch.index_data;
+        const GLuint index_offset = vertex_data.size() / 5;
+
+        for (const vec3 & quad_corner : QUAD_CORNERS)
+        {
+            const vec4 position = entity_model_matrix * vec4(quad_corner, 1.0f);
+            vertex_data.push_back(position.x);
+            vertex_data.push_back(position.y);
+            vertex_data.push_back(0.0f);
+            vertex_data.push_back(quad_corner.x);
+            vertex_data.push_back(quad_corner.y);
+        }
+
+        for (const GLuint quad_index : QUAD_INDEXES)
+        {
+            index_data.push_back(index_offset + quad_index);
+        }
+    }
+
+
+    // Load baked vertex data into persistent vertex containers.
+    for_each(keyed_static_batches, [](const Static_Batch_Key & /*key*/, Static_Batch & static_batch) -> void
+    {
+        static_batch.vertex_container_id = "static_sprites : " + to_string(static_batches.size());
+        load_vertex_data(static_batch.vertex_container_id, static_batch.vertex_data, static_batch.index_data);
+        static_batch.vertex_data.clear();
+        static_batch.index_data.clear();
+        static_batches.push_back(static_batch);
+    });
+
+    static_batches_dirty = false;
+}
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -53,10 +267,18 @@ static map<Entity, Renderer_State> entity_states;
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 void renderer_subscribe(Entity entity)
 {
-    entity_states[entity] =
+    auto sprite = (Sprite *)get_component(entity, "sprite");
+
+    // Static sprites are baked during the next update, once their dimensions and transforms have been resolved.
+    if (sprite->is_static)
+    {
+        static_batches_dirty = true;
+    }
+
+    (sprite->is_static ? static_entity_states : dynamic_entity_states)[entity] =
     {
         (string *)get_component(entity, "render_layer"),
-        (Sprite *)get_component(entity, "sprite"),
+        sprite,
         (Transform *)get_component(entity, "transform"),
         (Dimensions *)get_component(entity, "dimensions"),
     };
@@ -65,24 +287,37 @@ void renderer_subscribe(Entity entity)
 
 void renderer_unsubscribe(Entity entity)
 {
-    remove(entity_states, entity);
+    if (contains_key(static_entity_states, entity))
+    {
+        remove(static_entity_states, entity);
+        static_batches_dirty = true;
+    }
+    else
+    {
+        remove(dynamic_entity_states, entity);
+    }
 }
 
 
 void renderer_update()
 {
-    for_each(entity_states, [](Entity /*entity*/, Renderer_State & entity_state) -> void
+    if (static_batches_dirty)
+    {
+        bake_static_batches();
+    }
+
+
+    // Load render data for dynamic sprites in view.
+    for_each(dynamic_entity_states, [](Entity /*entity*/, Renderer_State & entity_state) -> void
     {
         const Sprite * entity_sprite = entity_state.sprite;
 
-        if (!entity_sprite->render)
+        if (!entity_sprite->render ||
+            !in_render_view(*entity_state.render_layer, calculate_entity_render_bounds(entity_state)))
         {
             return;
         }
 
-        const Transform * entity_transform = entity_state.transform;
-        const Dimensions * entity_dimensions = entity_state.dimensions;
-
         load_render_data(
             {
                 Render_Modes::TRIANGLES,
@@ -91,15 +326,30 @@ void renderer_update()
                 &entity_sprite->shader_pipeline_name,
                 nullptr,
                 nullptr,
-                calculate_model_matrix(
-                    entity_dimensions->width,
-                    entity_dimensions->height,
-                    entity_dimensions->origin,
-                    entity_transform->position,
-                    entity_transform->scale,
-                    entity_transform->rotation),
+                calculate_entity_model_matrix(entity_state),
             });
     });
+
+
+    // Load render data for static batches in view.
+    for (const Static_Batch & static_batch : static_batches)
+    {
+        if (!in_render_view(static_batch.render_layer, static_batch.render_bounds))
+        {
+            continue;
+        }
+
+        load_render_data(
+            {
+                Render_Modes::TRIANGLES,
+                &static_batch.render_layer,
+                &static_batch.texture_path,
+                &static_batch.shader_pipeline_name,
+                &static_batch.vertex_container_id,
+                nullptr,
+                static_batch.model_matrix,
+            });
+    }
 }
 
 
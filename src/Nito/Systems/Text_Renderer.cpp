@@ -42,6 +42,8 @@ struct Text_Renderer_State
     const Transform * transform;
     Dimensions * dimensions;
     const Text * text;
+    const string * shader_pipeline_name;
+    float character_scale;
     Render_Data::Uniforms uniforms;
     vector<string> character_texture_paths;
     vector<const Dimensions *> character_dimensions;
@@ -56,6 +58,7 @@ struct Text_Renderer_State
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 static const string TEXT_SHADER_PIPELINE_NAME = "text";
+static const string TEXT_SDF_SHADER_PIPELINE_NAME = "text_sdf";
 static map<Entity, Text_Renderer_State> entity_states;
 
 
@@ -75,6 +78,18 @@ void text_renderer_subscribe(Entity entity)
     entity_state.text = entity_text;
 
 
+    // SDF fonts are rendered with their own shader pipeline, and any font can be scaled from the height it was loaded
+    // at to the text's size (though only SDF fonts stay crisp when scaled up).
+    const Font & entity_font = get_loaded_font(entity_text->font);
+    const float character_scale = entity_text->size == 0.0f ? 1.0f : entity_text->size / entity_font.height;
+    entity_state.character_scale = character_scale;
+
+    entity_state.shader_pipeline_name =
+        entity_font.sdf
+        ? &TEXT_SDF_SHADER_PIPELINE_NAME
+        : &TEXT_SHADER_PIPELINE_NAME;
+
+
     // Entity's width and height are calculated based on the width and height of its characters, so ensure width and
     // height are 0 in case user specified different values.
     entity_dimensions->width = 0.0f;
@@ -93,7 +108,7 @@ void text_renderer_subscribe(Entity entity)
     {
         const string character_texture_path = font_prefix + character;
         const Glyph & character_glyph = get_loaded_glyph(character_texture_path);
-        float character_advance =  character_glyph.advance / pixels_per_unit;
+        float character_advance = (character_glyph.advance * character_scale) / pixels_per_unit;
         entity_character_texture_paths.push_back(character_texture_path);
         entity_character_dimensions.push_back(&get_loaded_texture(character_texture_path).dimensions);
         entity_character_positions.push_back(vec3());
@@ -101,7 +116,7 @@ void text_renderer_subscribe(Entity entity)
 
 
         // Update text entity's width & height.
-        float character_bearing_y = character_glyph.bearing.y / pixels_per_unit;
+        float character_bearing_y = (character_glyph.bearing.y * character_scale) / pixels_per_unit;
         entity_state.dimensions->width += character_advance;
 
         if (character_bearing_y > entity_state.dimensions->height)
@@ -136,6 +151,7 @@ void text_renderer_update()
         const vector<const Dimensions *> & entity_character_dimensions = entity_state.character_dimensions;
         vector<vec3> & entity_character_positions = entity_state.character_positions;
         const vector<float> & entity_character_advances = entity_state.character_advances;
+        const float character_scale = entity_state.character_scale;
         vec3 character_position_offset(0.0f);
 
         vec3 entity_origin_offset =
@@ -152,24 +168,42 @@ void text_renderer_update()
                 entity_transform,
                 character_position_offset - entity_origin_offset);
 
+            character_position_offset.x += entity_character_advances[character_index];
+
+
+            // Don't submit characters outside the camera's view.
+            const float character_width = character_dimensions->width * character_scale;
+            const float character_height = character_dimensions->height * character_scale;
+
+            const Render_Bounds character_render_bounds = calculate_render_bounds(
+                character_width,
+                character_height,
+                character_dimensions->origin,
+                character_position,
+                entity_transform->scale,
+                entity_transform->rotation);
+
+            if (!in_render_view(*entity_state.render_layer, character_render_bounds))
+            {
+                continue;
+            }
+
             load_render_data(
                 {
                     Render_Modes::TRIANGLES,
                     entity_state.render_layer,
                     &entity_character_texture_paths[character_index],
-                    &TEXT_SHADER_PIPELINE_NAME,
+                    entity_state.shader_pipeline_name,
                     nullptr,
                     &entity_state.uniforms,
                     calculate_model_matrix(
-                        character_dimensions->width,
-                        character_dimensions->height,
+                        character_width,
+                        character_height,
                         character_dimensions->origin,
                         character_position,
                         entity_transform->scale,
                         entity_transform->rotation),
                 });
-
-            character_position_offset.x += entity_character_advances[character_index];
         }
     });
 }
@@ -1,21 +1,19 @@
 #include "Nito/Utilities.hpp"
 
-#include <string>
+#include <cmath>
 #include <glm/gtc/matrix_transform.hpp>
-#include <glm/gtx/vector_angle.hpp>
 
 #include "Nito/Collider_Component.hpp"
 #include "Nito/APIs/Graphics.hpp"
+#include "Nito/APIs/Debug_Draw.hpp"
 
 
-using std::string;
-
 // glm/glm.hpp
 using glm::mat4;
 using glm::vec3;
-using glm::distance;
-using glm::degrees;
 using glm::normalize;
+using glm::min;
+using glm::max;
 
 // glm/gtc/matrix_transform.hpp
 using glm::translate;
@@ -23,9 +21,6 @@ using glm::rotate;
 using glm::scale;
 using glm::radians;
 
-// glm/gtx/vector_angle.hpp
-using glm::orientedAngle;
-
 
 namespace Nito
 {
@@ -83,6 +78,43 @@ mat4 calculate_view_matrix(
 }
 
 
+Render_Bounds calculate_render_bounds(
+    float model_width,
+    float model_height,
+    const vec3 & model_origin,
+    const vec3 & model_position,
+    const vec3 & model_scale,
+    float model_rotation)
+{
+    // Transform the model's corners the same way calculate_model_matrix() does, then take their axis-aligned bounds.
+    const float rotation = radians(model_rotation);
+    const float rotation_cos = cosf(rotation);
+    const float rotation_sin = sinf(rotation);
+    const vec3 model_size = vec3(model_width, model_height, 0.0f) * model_scale;
+    const vec3 model_origin_offset = model_origin * model_size;
+    const vec3 model_scaled_position = model_position * get_pixels_per_unit();
+    const float corners_x[] { -model_origin_offset.x, model_size.x - model_origin_offset.x };
+    const float corners_y[] { -model_origin_offset.y, model_size.y - model_origin_offset.y };
+    Render_Bounds render_bounds { model_scaled_position, model_scaled_position };
+
+    for (const float corner_x : corners_x)
+    {
+        for (const float corner_y : corners_y)
+        {
+            const vec3 corner(
+                model_scaled_position.x + (corner_x * rotation_cos) - (corner_y * rotation_sin),
+                model_scaled_position.y + (corner_x * rotation_sin) + (corner_y * rotation_cos),
+                model_scaled_position.z);
+
+            render_bounds.min = min(render_bounds.min, corner);
+            render_bounds.max = max(render_bounds.max, corner);
+        }
+    }
+
+    return render_bounds;
+}
+
+
 vec3 get_child_world_position(const Transform * parent_transform, const vec3 & child_local_position)
 {
     mat4 position;
@@ -94,35 +126,43 @@ vec3 get_child_world_position(const Transform * parent_transform, const vec3 & c
 }
 
 
+bool transforms_equal(const Transform & transform_a, const Transform & transform_b)
+{
+    return
+        transform_a.position == transform_b.position &&
+        transform_a.scale == transform_b.scale &&
+        transform_a.rotation == transform_b.rotation;
+}
+
+
 void draw_line_collider(const vec3 & line_begin, const vec3 & line_end, const vec3 & scale)
 {
-    static const string VERTEX_CONTAINER_ID("line_collider");
-    static const vec3 BASE_ANGLE_VECTOR(1.0f, 0.0f, 0.0f);
-    static const vec3 ANGLE_AXIS(0.0f, 0.0f, 1.0f);
+    // Height of the marker drawn at the middle of the line, pointing along the line's normal.
+    static const float MARKER_HEIGHT = 0.1f;
 
     const float pixels_per_unit = get_pixels_per_unit();
-    vec3 position = line_begin;
-    position.z = -1.0f;
+    const float marker_height = MARKER_HEIGHT * fabsf(scale.y);
 
-    const float line_orientation =
-        degrees(orientedAngle(BASE_ANGLE_VECTOR, normalize(line_end - line_begin), ANGLE_AXIS));
 
-    load_render_data(
-        {
-            Render_Modes::LINES,
-            &Collider::LAYER_NAME,
-            nullptr,
-            &Collider::SHADER_PIPELINE_NAME,
-            &VERTEX_CONTAINER_ID,
-            &Collider::UNIFORMS,
-            calculate_model_matrix(
-                distance(line_begin, line_end) * pixels_per_unit,
-                pixels_per_unit,
-                Collider::ORIGIN,
-                position,
-                scale,
-                line_orientation)
-        });
+    // Don't submit lines outside the camera's view.
+    const vec3 marker_offset(vec3(marker_height * pixels_per_unit));
+
+    const Render_Bounds render_bounds
+    {
+        (min(line_begin, line_end) * pixels_per_unit) - marker_offset,
+        (max(line_begin, line_end) * pixels_per_unit) + marker_offset,
+    };
+
+    if (!in_render_view(Collider::LAYER_NAME, render_bounds))
+    {
+        return;
+    }
+
+    const vec3 line_direction = normalize(line_end - line_begin);
+    const vec3 marker_begin = (line_begin + line_end) / 2.0f;
+    const vec3 marker_end = marker_begin + (vec3(-line_direction.y, line_direction.x, 0.0f) * marker_height);
+    draw_debug_line(line_begin, line_end, Collider::COLOR);
+    draw_debug_line(marker_begin, marker_end, Collider::COLOR);
 }
 
 
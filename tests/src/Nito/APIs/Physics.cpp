@@ -0,0 +1,1557 @@
+#include <gtest/gtest.h>
+
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include <random>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+#include <cmath>
+#include <atomic>
+#include <glm/glm.hpp>
+
+#include "Nito/APIs/Physics.hpp"
+
+
+using std::vector;
+using std::pair;
+using std::mt19937;
+using std::uniform_real_distribution;
+using std::function;
+using std::sort;
+using std::unique;
+using std::min;
+using std::max;
+using std::atomic;
+using std::size_t;
+using std::malloc;
+using std::free;
+using std::bad_alloc;
+using std::runtime_error;
+
+// glm/glm.hpp
+using glm::vec2;
+using glm::vec3;
+using glm::dot;
+using glm::distance;
+using glm::length;
+
+// Nito/APIs/ECS.hpp
+using Nito::Entity;
+
+// Nito/APIs/Physics.hpp
+using Nito::Broadphase_Modes;
+using Nito::Collision_Handler;
+using Nito::Collision_Layer;
+using Nito::Raycast_Query;
+using Nito::Raycast_Hit;
+using Nito::Overlap_Circle_Query;
+using Nito::Overlap_AABB_Query;
+using Nito::Nearest_Query;
+using Nito::Nearest_Result;
+using Nito::load_circle_collider_data;
+using Nito::load_line_collider_data;
+using Nito::load_polygon_collider_data;
+using Nito::remove_circle_collider_data;
+using Nito::remove_line_collider_data;
+using Nito::remove_polygon_collider_data;
+using Nito::invalidate_static_collider_data;
+using Nito::reset_collider_motion;
+using Nito::load_collision_layers;
+using Nito::get_collision_layer;
+using Nito::get_default_collision_mask;
+using Nito::set_broadphase_mode;
+using Nito::set_physics_worker_count;
+using Nito::set_sleeping_enabled;
+using Nito::set_max_continuous_displacement;
+using Nito::raycast;
+using Nito::overlap_circle;
+using Nito::overlap_aabb;
+using Nito::nearest;
+using Nito::get_physics_stats;
+using Nito::physics_api_update;
+using Nito::clean_physics;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data Structures
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+// Stand in for the components the engine would allocate for collider entities.
+struct Circle
+{
+    Collision_Handler collision_handler;
+    bool sends_collision;
+    bool receives_collision;
+    bool enabled;
+    unsigned int layer;
+    unsigned int mask;
+    bool continuous;
+    float radius;
+    vec3 position;
+    vec3 scale;
+};
+
+
+struct Line
+{
+    Collision_Handler collision_handler;
+    bool sends_collision;
+    bool receives_collision;
+    bool enabled;
+    unsigned int layer;
+    unsigned int mask;
+    bool is_static;
+    vec3 begin;
+    vec3 end;
+};
+
+
+struct Polygon
+{
+    Collision_Handler collision_handler;
+    bool sends_collision;
+    bool receives_collision;
+    bool enabled;
+    unsigned int layer;
+    unsigned int mask;
+    bool is_static;
+    vector<vec3> begins;
+    vector<vec3> ends;
+    vec3 position;
+};
+
+
+// Colliders are loaded with entities in the order circles, lines, polygons, so the scene must be fully built before
+// load() is called and not resized afterwards. The Physics API's state is global, so every collider is removed and the
+// settings tests change are reset when the scene is destroyed.
+struct Test_Scene
+{
+    vector<Circle> circles;
+    vector<Line> lines;
+    vector<Polygon> polygons;
+    vector<vec3> circle_velocities;
+    vector<vec3> line_velocities;
+
+
+    Entity get_circle_entity(int index) const
+    {
+        return index;
+    }
+
+
+    Entity get_line_entity(int index) const
+    {
+        return circles.size() + index;
+    }
+
+
+    Entity get_polygon_entity(int index) const
+    {
+        return circles.size() + lines.size() + index;
+    }
+
+
+    void load()
+    {
+        for (auto i = 0u; i < circles.size(); i++)
+        {
+            Circle & circle = circles[i];
+
+            load_circle_collider_data(
+                get_circle_entity(i),
+                &circle.collision_handler,
+                &circle.sends_collision,
+                &circle.receives_collision,
+                &circle.enabled,
+                &circle.layer,
+                &circle.mask,
+                &circle.continuous,
+                &circle.radius,
+                &circle.position,
+                &circle.scale);
+        }
+
+        for (auto i = 0u; i < lines.size(); i++)
+        {
+            Line & line = lines[i];
+
+            load_line_collider_data(
+                get_line_entity(i),
+                &line.collision_handler,
+                &line.sends_collision,
+                &line.receives_collision,
+                &line.enabled,
+                &line.layer,
+                &line.mask,
+                line.is_static,
+                &line.begin,
+                &line.end);
+        }
+
+        for (auto i = 0u; i < polygons.size(); i++)
+        {
+            Polygon & polygon = polygons[i];
+
+            load_polygon_collider_data(
+                get_polygon_entity(i),
+                &polygon.collision_handler,
+                &polygon.sends_collision,
+                &polygon.receives_collision,
+                &polygon.enabled,
+                &polygon.layer,
+                &polygon.mask,
+                polygon.is_static,
+                &polygon.begins,
+                &polygon.ends,
+                &polygon.position);
+        }
+    }
+
+
+    // Moves every circle and dynamic line by its velocity.
+    void step()
+    {
+        for (auto i = 0u; i < circles.size(); i++)
+        {
+            circles[i].position += circle_velocities[i];
+        }
+
+        for (auto i = 0u; i < lines.size(); i++)
+        {
+            lines[i].begin += line_velocities[i];
+            lines[i].end += line_velocities[i];
+        }
+    }
+
+
+    ~Test_Scene()
+    {
+        for (auto i = 0u; i < circles.size(); i++)
+        {
+            remove_circle_collider_data(get_circle_entity(i));
+        }
+
+        for (auto i = 0u; i < lines.size(); i++)
+        {
+            remove_line_collider_data(get_line_entity(i));
+        }
+
+        for (auto i = 0u; i < polygons.size(); i++)
+        {
+            remove_polygon_collider_data(get_polygon_entity(i));
+        }
+
+
+        // Run an update without colliders so no collisions from this scene are kept for the next one.
+        physics_api_update();
+        set_broadphase_mode(Broadphase_Modes::SPATIAL_HASH);
+        set_physics_worker_count(0);
+        set_sleeping_enabled(true);
+        set_max_continuous_displacement(0.0f);
+    }
+};
+
+
+// The narrow phase worker threads must be stopped before the test program exits.
+struct Physics_Environment : testing::Environment
+{
+    void TearDown() override
+    {
+        clean_physics();
+    }
+};
+
+
+struct Run_Result
+{
+    vector<pair<Entity, Entity>> collision_events;
+    vector<vec3> circle_positions;
+};
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Data
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static const vector<Broadphase_Modes> BROADPHASE_MODES
+{
+    Broadphase_Modes::SPATIAL_HASH,
+    Broadphase_Modes::SWEEP_AND_PRUNE,
+    Broadphase_Modes::BRUTE_FORCE,
+};
+
+
+// Enough circles that their narrow phase is split between workers.
+static const int RANDOM_CIRCLE_COUNT = 400;
+static const int RANDOM_LINE_COUNT = 24;
+static const int RANDOM_POLYGON_COUNT = 12;
+static const float RANDOM_AREA_SIZE = 40.0f;
+static const float DISTANCE_TOLERANCE = 0.0001f;
+
+
+// More updates than circles have to stay unchanged for to fall asleep.
+static const int SLEEP_UPDATE_COUNT = 40;
+
+
+// Events are recorded by the handlers of every collider in a scene as (handling entity, collided entity).
+static vector<pair<Entity, Entity>> collision_events;
+
+
+// Allocations are only counted while counting_allocations is set, and counted from every thread.
+static atomic<bool> counting_allocations(false);
+static atomic<int> allocation_count(0);
+
+
+static testing::Environment * const physics_environment =
+    testing::AddGlobalTestEnvironment(new Physics_Environment);
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Utilities
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+static Collision_Handler get_recording_handler(Entity entity)
+{
+    return [=](Entity collision_entity) -> void
+    {
+        collision_events.push_back({ entity, collision_entity });
+    };
+}
+
+
+// Gives every collider in the scene a handler recording its collision events.
+static void record_collisions(Test_Scene & scene)
+{
+    for (auto i = 0u; i < scene.circles.size(); i++)
+    {
+        scene.circles[i].collision_handler = get_recording_handler(scene.get_circle_entity(i));
+    }
+
+    for (auto i = 0u; i < scene.lines.size(); i++)
+    {
+        scene.lines[i].collision_handler = get_recording_handler(scene.get_line_entity(i));
+    }
+
+    for (auto i = 0u; i < scene.polygons.size(); i++)
+    {
+        scene.polygons[i].collision_handler = get_recording_handler(scene.get_polygon_entity(i));
+    }
+}
+
+
+static bool collision_event_recorded(Entity entity, Entity collision_entity)
+{
+    for (const pair<Entity, Entity> & collision_event : collision_events)
+    {
+        if (collision_event.first == entity && collision_event.second == collision_entity)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static bool collision_events_involve(Entity entity)
+{
+    for (const pair<Entity, Entity> & collision_event : collision_events)
+    {
+        if (collision_event.first == entity || collision_event.second == entity)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+// Adds a circle on the default layer, which doesn't move unless moved by the test.
+static int add_circle(Test_Scene & scene, const vec3 & position, float radius, bool sends_collision)
+{
+    const unsigned int layer = get_collision_layer("default");
+
+    scene.circles.push_back(
+        {
+            Collision_Handler(),
+            sends_collision,
+            true,
+            true,
+            layer,
+            get_default_collision_mask(layer),
+            false,
+            radius,
+            position,
+            vec3(1.0f),
+        });
+
+    scene.circle_velocities.push_back(vec3());
+    return scene.circles.size() - 1;
+}
+
+
+static int add_line(Test_Scene & scene, const vec3 & begin, const vec3 & end, bool sends_collision, bool is_static)
+{
+    const unsigned int layer = get_collision_layer("default");
+
+    scene.lines.push_back(
+        {
+            Collision_Handler(),
+            sends_collision,
+            false,
+            true,
+            layer,
+            get_default_collision_mask(layer),
+            is_static,
+            begin,
+            end,
+        });
+
+    scene.line_velocities.push_back(vec3());
+    return scene.lines.size() - 1;
+}
+
+
+static void update_physics(int frame_count)
+{
+    for (int frame = 0; frame < frame_count; frame++)
+    {
+        collision_events.clear();
+        physics_api_update();
+    }
+}
+
+
+static unsigned int get_other_layer()
+{
+    load_collision_layers({ { "test_other", { "default" } } });
+    return get_collision_layer("test_other");
+}
+
+
+// Builds a scene of circles (some continuous, some on a second layer and some disabled), dynamic and static lines, and
+// dynamic and static polygons spread over the same area, with velocities for the circles and dynamic lines.
+static void build_random_scene(Test_Scene & scene, unsigned int seed, bool recording)
+{
+    mt19937 random(seed);
+    uniform_real_distribution<float> random_position(0.0f, RANDOM_AREA_SIZE);
+    uniform_real_distribution<float> random_radius(0.25f, 1.0f);
+    uniform_real_distribution<float> random_velocity(-0.2f, 0.2f);
+    uniform_real_distribution<float> random_offset(-3.0f, 3.0f);
+    uniform_real_distribution<float> random_unit(0.0f, 1.0f);
+    const unsigned int default_layer = get_collision_layer("default");
+    const unsigned int other_layer = get_other_layer();
+
+    const auto get_layer = [&](int index) -> unsigned int
+    {
+        return index % 5 == 0 ? other_layer : default_layer;
+    };
+
+    for (int i = 0; i < RANDOM_CIRCLE_COUNT; i++)
+    {
+        const unsigned int layer = get_layer(i);
+        const bool continuous = i % 8 == 0;
+        const float speed_scale = continuous ? 10.0f : 1.0f;
+        const float radius = random_radius(random);
+        const vec3 position(random_position(random), random_position(random), 0.0f);
+        const vec3 velocity(random_velocity(random) * speed_scale, random_velocity(random) * speed_scale, 0.0f);
+
+        scene.circles.push_back(
+            {
+                Collision_Handler(),
+                random_unit(random) < 0.8f,
+                random_unit(random) < 0.8f,
+                i % 11 != 0,
+                layer,
+                get_default_collision_mask(layer),
+                continuous,
+                radius,
+                position,
+                vec3(1.0f),
+            });
+
+        scene.circle_velocities.push_back(velocity);
+    }
+
+    for (int i = 0; i < RANDOM_LINE_COUNT; i++)
+    {
+        const unsigned int layer = get_layer(i);
+        const bool is_static = i % 2 == 0;
+        const vec3 begin(random_position(random), random_position(random), 0.0f);
+        const vec3 end = begin + vec3(random_offset(random), random_offset(random), 0.0f);
+
+        scene.lines.push_back(
+            {
+                Collision_Handler(),
+                true,
+                !is_static,
+                i % 7 != 0,
+                layer,
+                get_default_collision_mask(layer),
+                is_static,
+                begin,
+                end,
+            });
+
+        scene.line_velocities.push_back(
+            is_static
+            ? vec3()
+            : vec3(random_velocity(random), random_velocity(random), 0.0f));
+    }
+
+    for (int i = 0; i < RANDOM_POLYGON_COUNT; i++)
+    {
+        const unsigned int layer = get_layer(i);
+        const vec3 center(random_position(random), random_position(random), 0.0f);
+        const float half_size = random_radius(random) * 2.0f;
+        const vec3 corners[] =
+        {
+            center + vec3(-half_size, -half_size, 0.0f),
+            center + vec3(half_size, -half_size, 0.0f),
+            center + vec3(half_size, half_size, 0.0f),
+            center + vec3(-half_size, half_size, 0.0f),
+        };
+
+        Polygon polygon
+        {
+            Collision_Handler(),
+            true,
+            false,
+            true,
+            layer,
+            get_default_collision_mask(layer),
+            i % 2 == 0,
+            {},
+            {},
+            center,
+        };
+
+        for (int corner = 0; corner < 4; corner++)
+        {
+            polygon.begins.push_back(corners[corner]);
+            polygon.ends.push_back(corners[(corner + 1) % 4]);
+        }
+
+        scene.polygons.push_back(polygon);
+    }
+
+    if (recording)
+    {
+        record_collisions(scene);
+    }
+}
+
+
+static Run_Result run_random_scene(Broadphase_Modes broadphase_mode, int worker_count, int frame_count)
+{
+    Run_Result run_result;
+    Test_Scene scene;
+    build_random_scene(scene, 1234u, true);
+    set_broadphase_mode(broadphase_mode);
+    set_physics_worker_count(worker_count);
+    scene.load();
+    collision_events.clear();
+
+    for (int frame = 0; frame < frame_count; frame++)
+    {
+        scene.step();
+        physics_api_update();
+
+        for (const Circle & circle : scene.circles)
+        {
+            run_result.circle_positions.push_back(circle.position);
+        }
+    }
+
+    run_result.collision_events = collision_events;
+    return run_result;
+}
+
+
+// The reference answers below check every collider a query could find, without the broadphase.
+static bool reference_layers_match(unsigned int query_mask, unsigned int layer, unsigned int mask)
+{
+    return mask != 0 && (layer & query_mask);
+}
+
+
+static float get_reference_line_distance(const vec2 & point, const vec3 & line_begin, const vec3 & line_end)
+{
+    const vec2 begin(line_begin.x, line_begin.y);
+    const vec2 line_vector = vec2(line_end.x, line_end.y) - begin;
+    const float line_length_squared = dot(line_vector, line_vector);
+
+    if (line_length_squared == 0.0f)
+    {
+        return distance(point, begin);
+    }
+
+    const float projection = min(max(dot(point - begin, line_vector) / line_length_squared, 0.0f), 1.0f);
+    return distance(point, begin + (line_vector * projection));
+}
+
+
+static bool reference_line_overlaps_aabb(
+    const vec3 & line_begin,
+    const vec3 & line_end,
+    const vec2 & min_point,
+    const vec2 & max_point)
+{
+    float entry = 0.0f;
+    float exit = 1.0f;
+
+    for (int axis = 0; axis < 2; axis++)
+    {
+        const float begin = line_begin[axis];
+        const float delta = line_end[axis] - begin;
+
+        if (delta == 0.0f)
+        {
+            if (begin < min_point[axis] || begin > max_point[axis])
+            {
+                return false;
+            }
+
+            continue;
+        }
+
+        const float t0 = (min_point[axis] - begin) / delta;
+        const float t1 = (max_point[axis] - begin) / delta;
+        entry = max(entry, min(t0, t1));
+        exit = min(exit, max(t0, t1));
+    }
+
+    return entry <= exit;
+}
+
+
+static bool get_reference_ray_circle_distance(
+    const vec2 & origin,
+    const vec2 & direction,
+    const vec2 & center,
+    float radius,
+    float & hit_distance)
+{
+    const vec2 offset = origin - center;
+
+    if (dot(offset, offset) <= radius * radius)
+    {
+        hit_distance = 0.0f;
+        return true;
+    }
+
+    const float projection = -dot(offset, direction);
+    const float closest_distance_squared = dot(offset, offset) - (projection * projection);
+
+    if (projection < 0.0f || closest_distance_squared > radius * radius)
+    {
+        return false;
+    }
+
+    hit_distance = projection - sqrtf((radius * radius) - closest_distance_squared);
+    return true;
+}
+
+
+static bool get_reference_ray_line_distance(
+    const vec2 & origin,
+    const vec2 & direction,
+    const vec3 & line_begin,
+    const vec3 & line_end,
+    float & hit_distance)
+{
+    const vec2 begin(line_begin.x, line_begin.y);
+    const vec2 line_vector = vec2(line_end.x, line_end.y) - begin;
+    const float denominator = (direction.x * line_vector.y) - (direction.y * line_vector.x);
+
+    if (denominator == 0.0f)
+    {
+        return false;
+    }
+
+    const vec2 offset = begin - origin;
+    const float ray_projection = ((offset.x * line_vector.y) - (offset.y * line_vector.x)) / denominator;
+    const float line_projection = ((offset.x * direction.y) - (offset.y * direction.x)) / denominator;
+
+    if (ray_projection < 0.0f || line_projection < 0.0f || line_projection > 1.0f)
+    {
+        return false;
+    }
+
+    hit_distance = ray_projection;
+    return true;
+}
+
+
+// Calls circle_handler(entity, center, radius) and line_handler(entity, begin, end) for every enabled collider in the
+// scene a query with the given mask can find.
+static void for_each_reference_collider(
+    const Test_Scene & scene,
+    unsigned int query_mask,
+    const function<void(Entity, const vec2 &, float)> & circle_handler,
+    const function<void(Entity, const vec3 &, const vec3 &)> & line_handler)
+{
+    for (auto i = 0u; i < scene.circles.size(); i++)
+    {
+        const Circle & circle = scene.circles[i];
+
+        if (circle.enabled && reference_layers_match(query_mask, circle.layer, circle.mask))
+        {
+            circle_handler(
+                scene.get_circle_entity(i),
+                vec2(circle.position.x, circle.position.y),
+                circle.radius * fabsf(circle.scale.x));
+        }
+    }
+
+    for (auto i = 0u; i < scene.lines.size(); i++)
+    {
+        const Line & line = scene.lines[i];
+
+        if (line.enabled && reference_layers_match(query_mask, line.layer, line.mask))
+        {
+            line_handler(scene.get_line_entity(i), line.begin, line.end);
+        }
+    }
+
+    for (auto i = 0u; i < scene.polygons.size(); i++)
+    {
+        const Polygon & polygon = scene.polygons[i];
+
+        if (!polygon.enabled || !reference_layers_match(query_mask, polygon.layer, polygon.mask))
+        {
+            continue;
+        }
+
+        for (auto line = 0u; line < polygon.begins.size(); line++)
+        {
+            line_handler(scene.get_polygon_entity(i), polygon.begins[line], polygon.ends[line]);
+        }
+    }
+}
+
+
+static vector<Entity> get_reference_circle_overlaps(const Test_Scene & scene, const Overlap_Circle_Query & query)
+{
+    const vec2 position(query.position.x, query.position.y);
+    vector<Entity> entities;
+
+    for_each_reference_collider(
+        scene,
+        query.mask,
+        [&](Entity entity, const vec2 & center, float radius) -> void
+        {
+            if (distance(position, center) <= query.radius + radius)
+            {
+                entities.push_back(entity);
+            }
+        },
+        [&](Entity entity, const vec3 & begin, const vec3 & end) -> void
+        {
+            if (get_reference_line_distance(position, begin, end) <= query.radius)
+            {
+                entities.push_back(entity);
+            }
+        });
+
+    sort(entities.begin(), entities.end());
+    entities.erase(unique(entities.begin(), entities.end()), entities.end());
+    return entities;
+}
+
+
+static vector<Entity> get_reference_aabb_overlaps(const Test_Scene & scene, const Overlap_AABB_Query & query)
+{
+    const vec2 min_point(query.min_point.x, query.min_point.y);
+    const vec2 max_point(query.max_point.x, query.max_point.y);
+    vector<Entity> entities;
+
+    for_each_reference_collider(
+        scene,
+        query.mask,
+        [&](Entity entity, const vec2 & center, float radius) -> void
+        {
+            const vec2 closest_point(
+                min(max(center.x, min_point.x), max_point.x),
+                min(max(center.y, min_point.y), max_point.y));
+
+            if (distance(center, closest_point) <= radius)
+            {
+                entities.push_back(entity);
+            }
+        },
+        [&](Entity entity, const vec3 & begin, const vec3 & end) -> void
+        {
+            if (reference_line_overlaps_aabb(begin, end, min_point, max_point))
+            {
+                entities.push_back(entity);
+            }
+        });
+
+    sort(entities.begin(), entities.end());
+    entities.erase(unique(entities.begin(), entities.end()), entities.end());
+    return entities;
+}
+
+
+// Finds every collider's distance along the ray (or to the query's position), so the closest can be found and the
+// distance to whichever equally close collider a query chose can be checked.
+static vector<pair<Entity, float>> get_reference_raycast_distances(
+    const Test_Scene & scene,
+    const Raycast_Query & query)
+{
+    const vec2 origin(query.origin.x, query.origin.y);
+    const vec2 query_direction(query.direction.x, query.direction.y);
+    const vec2 direction = query_direction / length(query_direction);
+    vector<pair<Entity, float>> distances;
+    float hit_distance;
+
+    for_each_reference_collider(
+        scene,
+        query.mask,
+        [&](Entity entity, const vec2 & center, float radius) -> void
+        {
+            if (get_reference_ray_circle_distance(origin, direction, center, radius, hit_distance) &&
+                hit_distance <= query.max_distance)
+            {
+                distances.push_back({ entity, hit_distance });
+            }
+        },
+        [&](Entity entity, const vec3 & begin, const vec3 & end) -> void
+        {
+            if (get_reference_ray_line_distance(origin, direction, begin, end, hit_distance) &&
+                hit_distance <= query.max_distance)
+            {
+                distances.push_back({ entity, hit_distance });
+            }
+        });
+
+    return distances;
+}
+
+
+static vector<pair<Entity, float>> get_reference_nearest_distances(
+    const Test_Scene & scene,
+    const Nearest_Query & query)
+{
+    const vec2 position(query.position.x, query.position.y);
+    vector<pair<Entity, float>> distances;
+
+    const auto add_distance = [&](Entity entity, float collider_distance) -> void
+    {
+        if (collider_distance <= query.max_distance)
+        {
+            distances.push_back({ entity, collider_distance });
+        }
+    };
+
+    for_each_reference_collider(
+        scene,
+        query.mask,
+        [&](Entity entity, const vec2 & center, float radius) -> void
+        {
+            add_distance(entity, max(distance(position, center) - radius, 0.0f));
+        },
+        [&](Entity entity, const vec3 & begin, const vec3 & end) -> void
+        {
+            add_distance(entity, get_reference_line_distance(vec2(position.x, position.y), begin, end));
+        });
+
+    return distances;
+}
+
+
+// Checks a raycast hit or nearest result against the reference distances: it must be found when any collider is, as
+// close as the closest one, and be one of the colliders at that distance.
+static void expect_closest(
+    bool found,
+    Entity entity,
+    float found_distance,
+    const vector<pair<Entity, float>> & reference_distances)
+{
+    ASSERT_EQ(found, !reference_distances.empty());
+
+    if (!found)
+    {
+        return;
+    }
+
+    float closest_distance = reference_distances[0].second;
+    float entity_distance = -1.0f;
+
+    for (const pair<Entity, float> & reference_distance : reference_distances)
+    {
+        closest_distance = min(closest_distance, reference_distance.second);
+
+        if (reference_distance.first == entity)
+        {
+            entity_distance =
+                entity_distance < 0.0f
+                ? reference_distance.second
+                : min(entity_distance, reference_distance.second);
+        }
+    }
+
+    EXPECT_NEAR(found_distance, closest_distance, DISTANCE_TOLERANCE);
+    EXPECT_NEAR(entity_distance, closest_distance, DISTANCE_TOLERANCE);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Allocation Counting
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+void * operator new(size_t size)
+{
+    if (counting_allocations)
+    {
+        allocation_count++;
+    }
+
+    void * memory = malloc(size > 0 ? size : 1);
+
+    if (memory == nullptr)
+    {
+        throw bad_alloc();
+    }
+
+    return memory;
+}
+
+
+void operator delete(void * memory) noexcept
+{
+    free(memory);
+}
+
+
+void operator delete(void * memory, size_t /*size*/) noexcept
+{
+    free(memory);
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Tests
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+TEST(Physics, results_dont_depend_on_worker_count)
+{
+    static const int FRAME_COUNT = 30;
+
+    for (const Broadphase_Modes broadphase_mode : BROADPHASE_MODES)
+    {
+        const Run_Result single_worker_result = run_random_scene(broadphase_mode, 1, FRAME_COUNT);
+        const Run_Result multiple_worker_result = run_random_scene(broadphase_mode, 4, FRAME_COUNT);
+        ASSERT_FALSE(single_worker_result.collision_events.empty());
+        EXPECT_TRUE(single_worker_result.collision_events == multiple_worker_result.collision_events);
+        EXPECT_TRUE(single_worker_result.circle_positions == multiple_worker_result.circle_positions);
+    }
+}
+
+
+// Circles cycle through the same positions every few frames (so no update sees a layout it hasn't seen before once
+// warmed up), while a group of still circles away from them falls asleep.
+TEST(Physics, updates_dont_allocate_once_warmed_up)
+{
+    static const int PERIOD = 4;
+    static const int WARM_UP_FRAME_COUNT = 48;
+    static const int MOVING_CIRCLE_COUNT = 300;
+    static const int STILL_CIRCLE_COUNT = 40;
+
+    for (const Broadphase_Modes broadphase_mode : BROADPHASE_MODES)
+    {
+        for (const int worker_count : { 1, 4 })
+        {
+            Test_Scene scene;
+            build_random_scene(scene, 42u, false);
+            scene.circles.resize(MOVING_CIRCLE_COUNT + STILL_CIRCLE_COUNT);
+            scene.circle_velocities.assign(scene.circles.size(), vec3());
+            vector<vec3> base_positions;
+
+            for (int i = 0; i < STILL_CIRCLE_COUNT; i++)
+            {
+                Circle & circle = scene.circles[MOVING_CIRCLE_COUNT + i];
+                circle = scene.circles[i];
+                circle.continuous = false;
+                circle.enabled = true;
+                circle.position = vec3(100.0f + ((i % 8) * 3.0f), 100.0f + ((i / 8) * 3.0f), 0.0f);
+            }
+
+            for (const Circle & circle : scene.circles)
+            {
+                base_positions.push_back(circle.position);
+            }
+
+            set_broadphase_mode(broadphase_mode);
+            set_physics_worker_count(worker_count);
+            scene.load();
+
+            const auto update = [&](int frame) -> void
+            {
+                const float offset = (frame % PERIOD) * 0.3f;
+
+                for (int i = 0; i < MOVING_CIRCLE_COUNT; i++)
+                {
+                    scene.circles[i].position = base_positions[i] + vec3(offset, -offset, 0.0f);
+                }
+
+                physics_api_update();
+            };
+
+            for (int frame = 0; frame < WARM_UP_FRAME_COUNT; frame++)
+            {
+                update(frame);
+            }
+
+            allocation_count = 0;
+            counting_allocations = true;
+
+            for (int frame = WARM_UP_FRAME_COUNT; frame < WARM_UP_FRAME_COUNT + PERIOD; frame++)
+            {
+                update(frame);
+            }
+
+            counting_allocations = false;
+
+            EXPECT_EQ(allocation_count, 0)
+                << "broadphase mode " << (int)broadphase_mode << ", " << worker_count << " workers";
+        }
+    }
+}
+
+
+TEST(Physics, queries_match_brute_force_reference)
+{
+    static const int QUERY_COUNT = 200;
+    mt19937 random(7u);
+    uniform_real_distribution<float> random_position(-5.0f, RANDOM_AREA_SIZE + 5.0f);
+    uniform_real_distribution<float> random_direction(-1.0f, 1.0f);
+    uniform_real_distribution<float> random_size(0.0f, 6.0f);
+    const unsigned int default_layer = get_collision_layer("default");
+    const unsigned int query_masks[] = { ~0u, default_layer, get_other_layer() };
+    vector<Raycast_Query> raycast_queries;
+    vector<Overlap_Circle_Query> overlap_circle_queries;
+    vector<Overlap_AABB_Query> overlap_aabb_queries;
+    vector<Nearest_Query> nearest_queries;
+
+    for (int i = 0; i < QUERY_COUNT; i++)
+    {
+        const unsigned int mask = query_masks[i % 3];
+        const vec3 position(random_position(random), random_position(random), 0.0f);
+        const vec3 direction(random_direction(random), random_direction(random), 0.0f);
+        const vec3 size(random_size(random), random_size(random), 0.0f);
+        raycast_queries.push_back({ position, direction, random_size(random) * 10.0f, mask });
+        overlap_circle_queries.push_back({ position, random_size(random), mask });
+        overlap_aabb_queries.push_back({ position, position + size, mask });
+        nearest_queries.push_back({ position, random_size(random) * 2.0f, mask });
+    }
+
+    for (const Broadphase_Modes broadphase_mode : BROADPHASE_MODES)
+    {
+        Test_Scene scene;
+        build_random_scene(scene, 99u, false);
+        set_broadphase_mode(broadphase_mode);
+        scene.load();
+
+
+        // Let some circles fall asleep and others move, so queries find colliders in every state.
+        for (int frame = 0; frame < 40; frame++)
+        {
+            if (frame < 5)
+            {
+                scene.step();
+            }
+
+            physics_api_update();
+        }
+
+        for (int i = 0; i < 10; i++)
+        {
+            scene.step();
+        }
+
+        physics_api_update();
+        vector<Raycast_Hit> raycast_hits;
+        vector<vector<Entity>> overlap_circle_results;
+        vector<vector<Entity>> overlap_aabb_results;
+        vector<Nearest_Result> nearest_results;
+        raycast(raycast_queries, raycast_hits);
+        overlap_circle(overlap_circle_queries, overlap_circle_results);
+        overlap_aabb(overlap_aabb_queries, overlap_aabb_results);
+        nearest(nearest_queries, nearest_results);
+
+        for (int i = 0; i < QUERY_COUNT; i++)
+        {
+            SCOPED_TRACE(testing::Message() << "broadphase mode " << (int)broadphase_mode << ", query " << i);
+            const Raycast_Hit raycast_hit = raycast(raycast_queries[i]);
+            const Nearest_Result nearest_result = nearest(nearest_queries[i]);
+            const vector<Entity> circle_overlaps = get_reference_circle_overlaps(scene, overlap_circle_queries[i]);
+            const vector<Entity> aabb_overlaps = get_reference_aabb_overlaps(scene, overlap_aabb_queries[i]);
+
+            const vector<pair<Entity, float>> raycast_distances =
+                get_reference_raycast_distances(scene, raycast_queries[i]);
+
+            const vector<pair<Entity, float>> nearest_distances =
+                get_reference_nearest_distances(scene, nearest_queries[i]);
+
+            expect_closest(raycast_hit.hit, raycast_hit.entity, raycast_hit.distance, raycast_distances);
+            expect_closest(nearest_result.found, nearest_result.entity, nearest_result.distance, nearest_distances);
+            EXPECT_EQ(raycast_hits[i].hit, raycast_hit.hit);
+            EXPECT_EQ(raycast_hits[i].entity, raycast_hit.entity);
+            EXPECT_EQ(nearest_results[i].found, nearest_result.found);
+            EXPECT_EQ(nearest_results[i].entity, nearest_result.entity);
+            EXPECT_EQ(overlap_circle(overlap_circle_queries[i]), circle_overlaps);
+            EXPECT_EQ(overlap_circle_results[i], circle_overlaps);
+            EXPECT_EQ(overlap_aabb(overlap_aabb_queries[i]), aabb_overlaps);
+            EXPECT_EQ(overlap_aabb_results[i], aabb_overlaps);
+        }
+    }
+}
+
+
+// Circles that don't send collisions stay overlapping, so keep colliding until they fall asleep with their collisions
+// kept.
+TEST(Physics, removing_sleeping_circle_drops_its_kept_collisions)
+{
+    Test_Scene scene;
+    const int circle_a = add_circle(scene, vec3(0.0f, 0.0f, 0.0f), 1.0f, false);
+    const int circle_b = add_circle(scene, vec3(1.0f, 0.0f, 0.0f), 1.0f, false);
+    const int circle_c = add_circle(scene, vec3(2.0f, 0.0f, 0.0f), 1.0f, false);
+    const Entity entity_a = scene.get_circle_entity(circle_a);
+    const Entity entity_b = scene.get_circle_entity(circle_b);
+    const Entity entity_c = scene.get_circle_entity(circle_c);
+    record_collisions(scene);
+    scene.load();
+    update_physics(SLEEP_UPDATE_COUNT);
+    EXPECT_EQ(get_physics_stats().narrow_phase_tests, 0);
+    EXPECT_TRUE(collision_event_recorded(entity_a, entity_b));
+    EXPECT_TRUE(collision_event_recorded(entity_b, entity_c));
+
+    remove_circle_collider_data(entity_b);
+    update_physics(1);
+    EXPECT_FALSE(collision_events_involve(entity_b));
+    EXPECT_TRUE(collision_event_recorded(entity_a, entity_c));
+
+    update_physics(SLEEP_UPDATE_COUNT);
+    EXPECT_EQ(get_physics_stats().narrow_phase_tests, 0);
+    EXPECT_FALSE(collision_events_involve(entity_b));
+    EXPECT_TRUE(collision_event_recorded(entity_a, entity_c));
+}
+
+
+TEST(Physics, rebaking_static_colliders_wakes_sleeping_circles)
+{
+    Test_Scene scene;
+    const int circle = add_circle(scene, vec3(0.0f, 0.5f, 0.0f), 1.0f, false);
+    const int line = add_line(scene, vec3(-2.0f, 0.0f, 0.0f), vec3(2.0f, 0.0f, 0.0f), false, true);
+    const Entity circle_entity = scene.get_circle_entity(circle);
+    const Entity line_entity = scene.get_line_entity(line);
+    Line & line_data = scene.lines[line];
+    record_collisions(scene);
+    scene.load();
+    update_physics(SLEEP_UPDATE_COUNT);
+    EXPECT_EQ(get_physics_stats().narrow_phase_tests, 0);
+    EXPECT_TRUE(collision_event_recorded(circle_entity, line_entity));
+
+
+    // Moving a static line is only seen once static colliders are invalidated.
+    line_data.begin.y = line_data.end.y = -5.0f;
+    invalidate_static_collider_data();
+    update_physics(1);
+    EXPECT_FALSE(collision_events_involve(line_entity));
+
+
+    // Loading a static collider again re-bakes the static colliders too.
+    update_physics(SLEEP_UPDATE_COUNT);
+    line_data.begin.y = line_data.end.y = 0.0f;
+
+    load_line_collider_data(
+        line_entity,
+        &line_data.collision_handler,
+        &line_data.sends_collision,
+        &line_data.receives_collision,
+        &line_data.enabled,
+        &line_data.layer,
+        &line_data.mask,
+        true,
+        &line_data.begin,
+        &line_data.end);
+
+    update_physics(1);
+    EXPECT_TRUE(collision_event_recorded(circle_entity, line_entity));
+
+    update_physics(SLEEP_UPDATE_COUNT);
+    EXPECT_EQ(get_physics_stats().narrow_phase_tests, 0);
+    EXPECT_TRUE(collision_event_recorded(circle_entity, line_entity));
+
+    remove_line_collider_data(line_entity);
+    update_physics(1);
+    EXPECT_FALSE(collision_events_involve(line_entity));
+}
+
+
+TEST(Physics, writing_transform_wakes_sleeping_circle)
+{
+    Test_Scene scene;
+    const int circle_a = add_circle(scene, vec3(0.0f, 0.0f, 0.0f), 1.0f, false);
+    const int circle_b = add_circle(scene, vec3(1.0f, 0.0f, 0.0f), 1.0f, false);
+    const int circle_c = add_circle(scene, vec3(10.0f, 0.0f, 0.0f), 1.0f, false);
+    const Entity entity_a = scene.get_circle_entity(circle_a);
+    const Entity entity_b = scene.get_circle_entity(circle_b);
+    const Entity entity_c = scene.get_circle_entity(circle_c);
+    record_collisions(scene);
+    scene.load();
+    update_physics(SLEEP_UPDATE_COUNT);
+    EXPECT_EQ(get_physics_stats().narrow_phase_tests, 0);
+    EXPECT_TRUE(collision_event_recorded(entity_a, entity_b));
+
+    scene.circles[circle_b].position = vec3(5.0f, 0.0f, 0.0f);
+    update_physics(1);
+    EXPECT_FALSE(collision_event_recorded(entity_a, entity_b));
+
+
+    // A sleeping circle moved into another sleeping circle collides with it.
+    update_physics(SLEEP_UPDATE_COUNT);
+    EXPECT_EQ(get_physics_stats().narrow_phase_tests, 0);
+    scene.circles[circle_c].position = vec3(-1.0f, 0.0f, 0.0f);
+    update_physics(1);
+    EXPECT_TRUE(collision_event_recorded(entity_a, entity_c));
+    EXPECT_FALSE(collision_events_involve(entity_b));
+}
+
+
+// Runs a scene where circles push each other apart and come to rest, clusters of overlapping circles rest against
+// static colliders, a circle moves through them, and circles and static colliders are removed, moved and replaced,
+// recording every update's collision events and circle positions.
+static Run_Result run_sleeping_scene(bool sleeping_enabled, int & narrow_phase_tests)
+{
+    static const int FRAME_COUNT = 280;
+    static const int GRID_SIZE = 5;
+    static const int CLUSTER_COUNT = 3;
+    static const int CLUSTER_SIZE = 6;
+    Run_Result run_result;
+    Test_Scene scene;
+    narrow_phase_tests = 0;
+
+    for (int i = 0; i < GRID_SIZE * GRID_SIZE; i++)
+    {
+        add_circle(scene, vec3((i % GRID_SIZE) * 0.8f, (i / GRID_SIZE) * 0.8f, 0.0f), 0.5f, true);
+    }
+
+    for (int cluster = 0; cluster < CLUSTER_COUNT; cluster++)
+    {
+        for (int i = 0; i < CLUSTER_SIZE; i++)
+        {
+            add_circle(scene, vec3(10.0f + (cluster * 6.0f) + (i * 0.7f), 0.5f, 0.0f), 0.6f, false);
+        }
+    }
+
+    const int first_cluster_circle = GRID_SIZE * GRID_SIZE;
+    const int moving_circle = add_circle(scene, vec3(8.0f, 0.5f, 0.0f), 0.5f, false);
+    const int static_line = add_line(scene, vec3(9.0f, 0.0f, 0.0f), vec3(14.0f, 0.0f, 0.0f), false, true);
+    add_line(scene, vec3(-2.0f, -2.0f, 0.0f), vec3(-2.0f, 6.0f, 0.0f), true, false);
+    Polygon static_polygon;
+    static_polygon.sends_collision = false;
+    static_polygon.receives_collision = false;
+    static_polygon.enabled = true;
+    static_polygon.layer = get_collision_layer("default");
+    static_polygon.mask = get_default_collision_mask(static_polygon.layer);
+    static_polygon.is_static = true;
+    static_polygon.begins = { vec3(21.0f, 0.0f, 0.0f), vec3(25.0f, 0.0f, 0.0f) };
+    static_polygon.ends = { vec3(25.0f, 0.0f, 0.0f), vec3(25.0f, 1.0f, 0.0f) };
+    static_polygon.position = vec3();
+    scene.polygons.push_back(static_polygon);
+    record_collisions(scene);
+    set_sleeping_enabled(sleeping_enabled);
+    scene.load();
+
+    for (int frame = 0; frame < FRAME_COUNT; frame++)
+    {
+        scene.circle_velocities[moving_circle] = frame >= 40 && frame < 80 ? vec3(0.5f, 0.0f, 0.0f) : vec3();
+        scene.step();
+
+        if (frame == 120)
+        {
+            remove_circle_collider_data(scene.get_circle_entity(first_cluster_circle + 1));
+        }
+        else if (frame == 125)
+        {
+            scene.circles[first_cluster_circle + (CLUSTER_SIZE * 2)].position.x -= 0.1f;
+        }
+        else if (frame == 160)
+        {
+            scene.lines[static_line].begin.y = scene.lines[static_line].end.y = 0.2f;
+            invalidate_static_collider_data();
+        }
+        else if (frame == 200)
+        {
+            Polygon & polygon = scene.polygons[0];
+            polygon.begins[0].y = polygon.ends[0].y = polygon.begins[1].y = 0.3f;
+
+            load_polygon_collider_data(
+                scene.get_polygon_entity(0),
+                &polygon.collision_handler,
+                &polygon.sends_collision,
+                &polygon.receives_collision,
+                &polygon.enabled,
+                &polygon.layer,
+                &polygon.mask,
+                true,
+                &polygon.begins,
+                &polygon.ends,
+                &polygon.position);
+        }
+        else if (frame == 240)
+        {
+            remove_line_collider_data(scene.get_line_entity(static_line));
+        }
+
+        collision_events.clear();
+        physics_api_update();
+        narrow_phase_tests += get_physics_stats().narrow_phase_tests;
+        run_result.collision_events.insert(
+            run_result.collision_events.end(),
+            collision_events.begin(),
+            collision_events.end());
+
+        run_result.collision_events.push_back({ -1, frame });
+
+        for (const Circle & circle : scene.circles)
+        {
+            run_result.circle_positions.push_back(circle.position);
+        }
+    }
+
+    return run_result;
+}
+
+
+TEST(Physics, sleeping_keeps_results_of_running_awake)
+{
+    int sleeping_narrow_phase_tests;
+    int awake_narrow_phase_tests;
+    const Run_Result sleeping_result = run_sleeping_scene(true, sleeping_narrow_phase_tests);
+    const Run_Result awake_result = run_sleeping_scene(false, awake_narrow_phase_tests);
+    EXPECT_LT(sleeping_narrow_phase_tests, awake_narrow_phase_tests);
+    EXPECT_TRUE(sleeping_result.collision_events == awake_result.collision_events);
+    EXPECT_TRUE(sleeping_result.circle_positions == awake_result.circle_positions);
+}
+
+
+// Moves a circle across a line in one update, from (-3, y) to (3, y), returning where it ends up and whether it
+// collided with the line.
+static vec3 move_across_line(
+    bool continuous,
+    bool is_static,
+    float y,
+    const vec3 & line_begin = vec3(0.0f, -5.0f, 0.0f),
+    const vec3 & line_end = vec3(0.0f, 5.0f, 0.0f),
+    bool * collided = nullptr)
+{
+    Test_Scene scene;
+    const int circle = add_circle(scene, vec3(-3.0f, y, 0.0f), 0.5f, false);
+    const int line = add_line(scene, line_begin, line_end, true, is_static);
+    scene.circles[circle].continuous = continuous;
+    record_collisions(scene);
+    scene.load();
+    update_physics(1);
+    scene.circles[circle].position = vec3(3.0f, y, 0.0f);
+    update_physics(1);
+
+    if (collided != nullptr)
+    {
+        *collided = collision_event_recorded(scene.get_circle_entity(circle), scene.get_line_entity(line));
+    }
+
+    return scene.circles[circle].position;
+}
+
+
+TEST(Physics, continuous_circle_doesnt_tunnel_through_thin_line)
+{
+    for (const Broadphase_Modes broadphase_mode : BROADPHASE_MODES)
+    {
+        for (const bool is_static : { false, true })
+        {
+            SCOPED_TRACE(testing::Message() << "broadphase mode " << (int)broadphase_mode << ", static " << is_static);
+            bool collided;
+            set_broadphase_mode(broadphase_mode);
+            const vec3 discrete_position = move_across_line(false, is_static, 0.0f);
+            set_broadphase_mode(broadphase_mode);
+
+            const vec3 continuous_position =
+                move_across_line(true, is_static, 0.0f, vec3(0.0f, -5.0f, 0.0f), vec3(0.0f, 5.0f, 0.0f), &collided);
+
+            EXPECT_EQ(discrete_position.x, 3.0f);
+            EXPECT_NEAR(continuous_position.x, -0.5f, DISTANCE_TOLERANCE);
+            EXPECT_EQ(continuous_position.y, 0.0f);
+            EXPECT_TRUE(collided);
+        }
+    }
+}
+
+
+TEST(Physics, continuous_circle_hits_line_ends)
+{
+    const vec3 line_begin(0.0f, 0.0f, 0.0f);
+    const vec3 line_end(0.0f, 5.0f, 0.0f);
+    bool collided;
+
+
+    // Passing 0.3 below the line's end, the circle first touches it 0.4 before reaching it.
+    const vec3 hit_position = move_across_line(true, true, -0.3f, line_begin, line_end, &collided);
+    EXPECT_NEAR(hit_position.x, -0.4f, DISTANCE_TOLERANCE);
+    EXPECT_NEAR(hit_position.y, -0.3f, DISTANCE_TOLERANCE);
+    EXPECT_TRUE(collided);
+
+    const vec3 miss_position = move_across_line(true, true, -0.6f, line_begin, line_end, &collided);
+    EXPECT_EQ(miss_position, vec3(3.0f, -0.6f, 0.0f));
+    EXPECT_FALSE(collided);
+
+
+    // The same applies at the line's beginning when it's swapped around.
+    const vec3 swapped_hit_position = move_across_line(true, true, -0.3f, line_end, line_begin, &collided);
+    EXPECT_NEAR(swapped_hit_position.x, -0.4f, DISTANCE_TOLERANCE);
+    EXPECT_TRUE(collided);
+}
+
+
+// Circles that start touching a line are left to discrete collision checks, so they slide along it unless their center
+// passes through it, in which case they stay where they started.
+TEST(Physics, continuous_circle_starting_on_line_slides_unless_crossing_it)
+{
+    Test_Scene scene;
+    const int circle = add_circle(scene, vec3(-0.5f, 0.0f, 0.0f), 0.5f, false);
+    const int line = add_line(scene, vec3(0.0f, -5.0f, 0.0f), vec3(0.0f, 5.0f, 0.0f), true, true);
+    const Entity circle_entity = scene.get_circle_entity(circle);
+    const Entity line_entity = scene.get_line_entity(line);
+    vec3 & position = scene.circles[circle].position;
+    scene.circles[circle].continuous = true;
+    record_collisions(scene);
+    scene.load();
+    update_physics(1);
+    ASSERT_NEAR(position.x, -0.5f, DISTANCE_TOLERANCE);
+
+    position.y = 2.0f;
+    update_physics(1);
+    EXPECT_NEAR(position.x, -0.5f, DISTANCE_TOLERANCE);
+    EXPECT_EQ(position.y, 2.0f);
+
+    const vec3 start_position = position;
+    position.x = 2.0f;
+    update_physics(1);
+    EXPECT_NEAR(position.x, start_position.x, DISTANCE_TOLERANCE);
+    EXPECT_EQ(position.y, 2.0f);
+    EXPECT_TRUE(collision_event_recorded(circle_entity, line_entity));
+}
+
+
+TEST(Physics, teleported_continuous_circle_isnt_swept)
+{
+    Test_Scene scene;
+    const int circle = add_circle(scene, vec3(-3.0f, 0.0f, 0.0f), 0.5f, false);
+    const int line = add_line(scene, vec3(0.0f, -5.0f, 0.0f), vec3(0.0f, 5.0f, 0.0f), true, true);
+    const Entity circle_entity = scene.get_circle_entity(circle);
+    const Entity line_entity = scene.get_line_entity(line);
+    vec3 & position = scene.circles[circle].position;
+    scene.circles[circle].continuous = true;
+    record_collisions(scene);
+    scene.load();
+    update_physics(1);
+
+
+    // Resetting a circle's motion only skips sweeping it for the next update.
+    position.x = 3.0f;
+    reset_collider_motion(circle_entity);
+    update_physics(1);
+    EXPECT_EQ(position.x, 3.0f);
+    EXPECT_FALSE(collision_events_involve(line_entity));
+
+    position.x = -3.0f;
+    update_physics(1);
+    EXPECT_NEAR(position.x, 0.5f, DISTANCE_TOLERANCE);
+    EXPECT_TRUE(collision_event_recorded(circle_entity, line_entity));
+
+
+    // Circles moving further than the max continuous displacement are treated as teleported, and circles moving exactly
+    // that far are still swept.
+    EXPECT_THROW(set_max_continuous_displacement(-1.0f), runtime_error);
+    set_max_continuous_displacement(5.0f);
+    position.x = 4.0f;
+    update_physics(1);
+    ASSERT_EQ(position.x, 4.0f);
+
+    position.x = -3.0f;
+    update_physics(1);
+    EXPECT_EQ(position.x, -3.0f);
+    EXPECT_FALSE(collision_events_involve(line_entity));
+
+    position.x = 2.0f;
+    update_physics(1);
+    EXPECT_NEAR(position.x, -0.5f, DISTANCE_TOLERANCE);
+    EXPECT_TRUE(collision_event_recorded(circle_entity, line_entity));
+
+    position.x = 5.0f;
+    update_physics(1);
+    EXPECT_EQ(position.x, 5.0f);
+    EXPECT_FALSE(collision_events_involve(line_entity));
+
+    set_max_continuous_displacement(0.0f);
+    position.x = -3.0f;
+    update_physics(1);
+    EXPECT_NEAR(position.x, 0.5f, DISTANCE_TOLERANCE);
+}
+
+
+TEST(Physics, continuous_circles_are_swept_against_each_other)
+{
+    for (const Broadphase_Modes broadphase_mode : BROADPHASE_MODES)
+    {
+        SCOPED_TRACE(testing::Message() << "broadphase mode " << (int)broadphase_mode);
+        Test_Scene scene;
+        const int moving_circle = add_circle(scene, vec3(-5.0f, 0.0f, 0.0f), 0.5f, true);
+        const int still_circle = add_circle(scene, vec3(0.0f, 0.0f, 0.0f), 0.5f, true);
+        const int other_moving_circle = add_circle(scene, vec3(-5.0f, 10.0f, 0.0f), 0.5f, true);
+        const int other_still_circle = add_circle(scene, vec3(5.0f, 10.0f, 0.0f), 0.5f, true);
+        vec3 & moving_position = scene.circles[moving_circle].position;
+        vec3 & other_moving_position = scene.circles[other_moving_circle].position;
+        vec3 & other_still_position = scene.circles[other_still_circle].position;
+        scene.circles[moving_circle].continuous = true;
+        scene.circles[other_moving_circle].continuous = true;
+        scene.circles[other_still_circle].continuous = true;
+        set_broadphase_mode(broadphase_mode);
+        record_collisions(scene);
+        scene.load();
+        update_physics(1);
+
+
+        // A continuous circle passing through a discrete one stops where they first touch, and two continuous circles
+        // passing through each other both stop where they first touch.
+        moving_position.x = 5.0f;
+        other_moving_position.x = 5.0f;
+        other_still_position.x = -5.0f;
+        update_physics(1);
+        EXPECT_NEAR(moving_position.x, -1.0f, DISTANCE_TOLERANCE);
+        EXPECT_EQ(scene.circles[still_circle].position.x, 0.0f);
+        EXPECT_NEAR(other_moving_position.x, -0.5f, DISTANCE_TOLERANCE);
+        EXPECT_NEAR(other_still_position.x, 0.5f, DISTANCE_TOLERANCE);
+
+        EXPECT_TRUE(
+            collision_event_recorded(scene.get_circle_entity(moving_circle), scene.get_circle_entity(still_circle)));
+
+        EXPECT_TRUE(
+            collision_event_recorded(
+                scene.get_circle_entity(other_moving_circle),
+                scene.get_circle_entity(other_still_circle)));
+    }
+}
@@ -0,0 +1,54 @@
+// Scene compiler: compiles JSON scenes into binary scenes offline. Run from a project's directory, with NITO_PATH set,
+// so the engine's and the project's requirements are found, e.g.
+//
+//     nito_scene_compiler resources/scenes/level.json resources/scenes/level.scene
+//
+// Any number of scene and compiled scene path pairs can be passed. Only engine components get fixed layouts here;
+// projects with their own compiled component handlers should set them and call compile_scene() from their own tool.
+
+
+#include <string>
+#include <stdexcept>
+#include <cstdio>
+
+#include "Nito/Engine.hpp"
+#include "Nito/APIs/Scene.hpp"
+
+
+using std::string;
+using std::runtime_error;
+using std::printf;
+
+// Nito/Engine.hpp
+using Nito::load_engine_scene_data;
+
+// Nito/APIs/Scene.hpp
+using Nito::compile_scene;
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+// Main
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+int main(int argc, char ** argv)
+{
+    if (argc < 3 || argc % 2 == 0)
+    {
+        throw runtime_error(
+            "ERROR: pairs of scene and compiled scene paths must be passed, e.g. "
+            "\"nito_scene_compiler <scene path> <compiled scene path> ...\"!");
+    }
+
+    load_engine_scene_data();
+
+    for (int i = 1; i < argc; i += 2)
+    {
+        const string scene_path = argv[i];
+        const string compiled_scene_path = argv[i + 1];
+        compile_scene(scene_path, compiled_scene_path);
+        printf("compiled %s -> %s\n", scene_path.c_str(), compiled_scene_path.c_str());
+    }
+
+    return 0;
+}